@@ -0,0 +1,73 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// every heap allocation in the process goes through here
+static atomic<long long> allocationCount(0);
+
+long long getAllocationCount() {
+    return allocationCount.load(memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+// aligned versions: std::pmr's default resource allocates through these
+void* operator new(size_t size, align_val_t alignment) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    size_t align = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+    void* p = nullptr;
+    if (posix_memalign(&p, align, size == 0 ? 1 : size) != 0) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size, align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p, align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t, align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t, align_val_t) noexcept {
+    free(p);
+}
@@ -0,0 +1,11 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Heap allocation counting for the simulation and benchmark tools
+// Linking AllocationCounter.cpp into a program replaces the global operator new/delete with
+// versions that count every allocation (malloc underneath). Don't link it into the game itself.
+
+// heap allocations made by the whole process so far
+long long getAllocationCount();
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef BASECODES_H
+#define BASECODES_H
+
+#include <array>
+#include <cstdint>
+
+using namespace std;
+
+// code of anything that isn't A, C, G or T
+static const uint8_t BASE_CODE_OTHER = 4;
+
+// 2-bit code of every byte: A/C/G/T in either case are 0-3 (in that order), anything else BASE_CODE_OTHER
+constexpr array<uint8_t, 256> makeBaseCodes() {
+    array<uint8_t, 256> codes{};
+    for (int c = 0; c < 256; c++) {
+        codes[c] = BASE_CODE_OTHER;
+    }
+    codes['A'] = codes['a'] = 0;
+    codes['C'] = codes['c'] = 1;
+    codes['G'] = codes['g'] = 2;
+    codes['T'] = codes['t'] = 3;
+    return codes;
+}
+static constexpr array<uint8_t, 256> BASE_CODES = makeBaseCodes();
+
+#endif
@@ -1,9 +1,11 @@
 // Use header file
 #include "Board.h"
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <string>
+#include "Trace.h"
 
 // Define macros for colors
 #define ORANGE "\033[48;2;230;115;0m"
@@ -18,71 +20,97 @@
 
 using namespace std;
 
-// CONSTRUCTOR
+// Background of every tile code, in code order
+static const char* const TILE_BACKGROUNDS[TILE_CODE_COUNT] = {GREY, GREEN, BLUE, PINK, BROWN, RED, PURPLE, ORANGE};
 
-Board::Board() {
-    _player_count = _MAX_PLAYERS;
+char tileCodeToColor(int code) {
+    if (code >= 0 && code < TILE_CODE_COUNT) {
+        return TILE_COLOR_CHARS[code];
+    }
+    return ' ';
+}
 
-    for (int i = 0; i < _player_count; i++) {
-        _player_position[i] = 0;
+int tileColorToCode(char color) {
+    for (int i = 0; i < TILE_CODE_COUNT; i++) {
+        if (TILE_COLOR_CHARS[i] == color) {
+            return i;
+        }
     }
+    return TILE_CODE_COUNT;
+}
 
-    initializeBoard();
+// CONSTRUCTORS
+
+Board::Board() : Board(_DEFAULT_LANES, _DEFAULT_LENGTH) {
+}
+
+Board::Board(pmr::memory_resource* resource) : Board(_DEFAULT_LANES, _DEFAULT_LENGTH, resource) {
+}
+
+Board::Board(int lane_count, int lane_length) : Board(lane_count, lane_length, pmr::get_default_resource()) {
+}
+
+Board::Board(int lane_count, int lane_length, pmr::memory_resource* resource) : _tiles(resource), _player_position(resource) {
+    setTileMix(TileMix());
+    reset(lane_count, lane_length, (uint64_t)rand() << 32 | (uint64_t)rand());
 }
 
 // PRIVATE MEMBER FUNCTIONS
 
-// initializeTiles: randomly generates tiles for one player's lane
-//   FOR each tile position (0 to 51):
-//     IF position is 51 (last tile):
-//       set to orange (finish line)
-//     ELSE IF position is 0 (first tile):
-//       set to grey (start)
-//     ELSE IF we need more green tiles AND random chance succeeds:
-//       set to green (regular tile)
-//       increment green count
-//     ELSE:
-//       randomly choose: blue, pink, brown, red, or purple
-//     store tile in board array
-
-void Board::initializeTiles(int player_index) {
-    Tile tile;
-    int green_count = 0;  
-    int total_tiles = _BOARD_SIZE;
-
-    for (int i = 0; i < total_tiles; i++) {
-        if (i == total_tiles - 1) {
-            tile.color = 'O';
-        } 
-        else if (i == 0) {
-            tile.color = 'Y';
-        } 
-        else if (green_count < 30 && (rand() % (total_tiles - i) < 30 - green_count)) {
-            tile.color = 'G';
-            green_count++;
-        }
-        else {
-            int color_choice = rand() % 5;  
-            switch (color_choice) {
-                case 0:
-                    tile.color = 'B'; // Blue - Training Fellowship (DNA Task 1)
-                    break;
-                case 1:
-                    tile.color = 'P'; // Pink - Direct Lab Assignment (DNA Task 2)
-                    break;
-                case 2:
-                    tile.color = 'T'; // Brown - Special Event (DNA Task 4)
-                    break;
-                case 3:
-                    tile.color = 'R'; // Red - Challenge (DNA Task 3)
-                    break;
-                case 4:
-                    tile.color = 'U'; // Purple - Bonus tile
-                    break;
+// initializeTiles: randomly generates tiles for a batch of lanes
+//   FOR each lane in the batch:
+//     FOR each tile position (0 to length - 1):
+//       IF position is the last tile:
+//         set to orange (finish line)
+//       ELSE IF position is 0 (first tile):
+//         set to grey (start)
+//       ELSE IF we need more green tiles AND random chance succeeds:
+//         set to green (regular tile)
+//         increment green count
+//       ELSE:
+//         randomly choose: blue, pink, brown, red, or purple
+//       pack the code into the lane's bytes (two tiles per byte)
+
+void Board::initializeTiles(int first_lane, int lane_count) {
+    int total_tiles = _lane_length;
+    int green_target = total_tiles * _tile_mix.greenPer52 / 52;
+
+    for (int lane = first_lane; lane < first_lane + lane_count; lane++) {
+        unsigned char* lane_data = &_tiles[(size_t)lane * _lane_stride];
+        int green_count = 0;
+        unsigned char packed = 0;
+
+        for (int i = 0; i < total_tiles; i++) {
+            unsigned char code;
+            if (i == total_tiles - 1) {
+                code = TILE_FINISH;
+            }
+            else if (i == 0) {
+                code = TILE_START;
+            }
+            else {
+                // one 64-bit draw per tile: high half decides green, low half picks the other color
+                uint64_t r = _random.next();
+                int green_roll = (int)(((r >> 32) * (uint64_t)(total_tiles - i)) >> 32);
+                if (green_count < green_target && green_roll < green_target - green_count) {
+                    code = TILE_GREEN;
+                    green_count++;
+                }
+                else {
+                    code = _color_table[((r & 0xFFFFFFFFULL) * _color_table_size) >> 32];
+                }
             }
-        }
 
-        _tiles[player_index][i] = tile;
+            if (i & 1) {
+                lane_data[i >> 1] = packed | (unsigned char)(code << 4);
+            } else {
+                packed = code;
+            }
+        }
+        // Odd lane length: flush the last half-filled byte
+        if (total_tiles & 1) {
+            lane_data[total_tiles >> 1] = packed;
+        }
     }
 }
 
@@ -93,49 +121,138 @@ bool Board::isPlayerOnTile(int player_index, int pos) {
     return false;
 }
 
-void Board::displayTile(int player_index, int pos) {
-    string color = "";  
+void Board::displayTile(int player_index, int pos, ostream& out) {
+    // a code outside the table (only a damaged lane could hold one) gets no background, like the old switch's default
+    int code = tileCodeAt(player_index, pos);
+    const char* color = code < TILE_CODE_COUNT ? TILE_BACKGROUNDS[code] : "";
     bool player = isPlayerOnTile(player_index, pos);  
 
-    switch(_tiles[player_index][pos].color) {
-        case 'O': color = ORANGE; break;  // Finish line
-        case 'Y': color = GREY; break;    // Start
-        case 'G': color = GREEN; break;   // Regular tile
-        case 'B': color = BLUE; break;    // Training Fellowship
-        case 'P': color = PINK; break;    // Direct Lab Assignment
-        case 'T': color = BROWN; break;   // Special Event
-        case 'R': color = RED; break;     // Challenge
-        case 'U': color = PURPLE; break;  // Bonus
-    }
-
     if (player == true) {
-        cout << color << "|" << (player_index + 1) << "|" << RESET;
+        out << color << "|" << (player_index + 1) << "|" << RESET;
     }
     else {
-        cout << color << "| |" << RESET;
+        out << color << "| |" << RESET;
     }
 }
 
 // PUBLIC MEMBER FUNCTIONS
 
-void Board::initializeBoard() {
-    for (int i = 0; i < 2; i++) {
-        initializeTiles(i);
+void Board::reset(int lane_count, int lane_length, uint64_t seed) {
+    if (lane_count < 1) {
+        lane_count = 1;
+    }
+    if (lane_length < 2) {
+        lane_length = 2;
+    }
+
+    _player_count = lane_count;
+    _lane_length = lane_length;
+    _lane_stride = (lane_length + 1) / 2;
+    _random.setState(seed);
+
+    _tiles.assign((size_t)_player_count * _lane_stride, 0);
+    _player_position.assign(_player_count, 0);
+
+    initializeBoard();
+}
+
+void Board::setTileMix(const TileMix& mix) {
+    static const unsigned char OTHER_TILES[TILE_MIX_COLORS] = {TILE_BLUE, TILE_PINK, TILE_BROWN, TILE_RED, TILE_PURPLE};
+    _tile_mix = mix;
+    if (_tile_mix.greenPer52 < 0) {
+        _tile_mix.greenPer52 = 0;
+    } else if (_tile_mix.greenPer52 > 50) {
+        _tile_mix.greenPer52 = 50;
+    }
+
+    _color_table_size = 0;
+    for (int color = 0; color < TILE_MIX_COLORS; color++) {
+        int weight = _tile_mix.weights[color];
+        weight = weight < 1 ? 1 : (weight > TILE_MIX_MAX_WEIGHT ? TILE_MIX_MAX_WEIGHT : weight);
+        _tile_mix.weights[color] = weight;
+        for (int i = 0; i < weight; i++) {
+            _color_table[_color_table_size++] = OTHER_TILES[color];
+        }
+    }
+}
+
+const TileMix& Board::getTileMix() const {
+    return _tile_mix;
+}
+
+// landing chance of each position: reached from one of the six before it with probability 1/6 each
+double Board::expectedLaneValue(int lane, const double* tile_value) const {
+    if (lane < 0 || lane >= _player_count) {
+        return 0;
+    }
+    int finish = _lane_length - 1;
+    double landing[7] = {1, 0, 0, 0, 0, 0, 0};
+    double total = 0;
+    for (int pos = 1; pos < finish; pos++) {
+        double chance = 0;
+        for (int roll = 1; roll <= 6 && pos - roll >= 0; roll++) {
+            chance += landing[(pos - roll) % 7];
+        }
+        chance /= 6;
+        landing[pos % 7] = chance;
+        total += chance * tile_value[tileCodeAt(lane, pos)];
+    }
+    return total;
+}
+
+// lane 0 is kept; every other lane is redrawn until it fits in the range of the lanes accepted so far
+bool Board::balanceLanes(const double* tile_value, double max_gap, int max_tries) {
+    pmr::vector<unsigned char> best_lane(_lane_stride, 0, _tiles.get_allocator());
+    double low = expectedLaneValue(0, tile_value);
+    double high = low;
+    bool balanced = true;
+
+    for (int lane = 1; lane < _player_count; lane++) {
+        unsigned char* lane_data = &_tiles[(size_t)lane * _lane_stride];
+        double best_spread = -1;
+        double best_value = 0;
+        for (int attempt = 0; attempt < max_tries; attempt++) {
+            if (attempt > 0) {
+                initializeTiles(lane, 1);
+            }
+            double value = expectedLaneValue(lane, tile_value);
+            double spread = (value > high ? value : high) - (value < low ? value : low);
+            if (best_spread < 0 || spread < best_spread) {
+                best_spread = spread;
+                best_value = value;
+                copy(lane_data, lane_data + _lane_stride, best_lane.begin());
+            }
+            if (spread <= max_gap) {
+                break;
+            }
+        }
+        if (best_spread > max_gap) {
+            balanced = false;
+        }
+        copy(best_lane.begin(), best_lane.end(), lane_data);
+        low = best_value < low ? best_value : low;
+        high = best_value > high ? best_value : high;
     }
+    return balanced;
+}
+
+void Board::initializeBoard() {
+    initializeTiles(0, _player_count);
 }
 
-void Board::displayTrack(int player_index) {
-    for (int i = 0; i < _BOARD_SIZE; i++) {
-        displayTile(player_index, i);
+void Board::displayTrack(int player_index, ostream& out) {
+    for (int i = 0; i < _lane_length; i++) {
+        displayTile(player_index, i, out);
     }
-    cout << endl;
+    out << endl;
 }
 
-void Board::displayBoard() {
-    for (int i = 0; i < 2; i++) {
-        displayTrack(i); 
-        if (i == 0) {
-            cout << endl; 
+void Board::displayBoard(ostream& out) {
+    TRACE_SPAN("displayBoard");
+    for (int i = 0; i < _player_count; i++) {
+        displayTrack(i, out); 
+        if (i < _player_count - 1) {
+            out << endl; 
         }
     }
 }
@@ -144,20 +261,34 @@ bool Board::movePlayer(int player_index) {
     // Move player position by one
     _player_position[player_index]++;
 
-    // Player reached last tile (position 51 is the finish)
-    if (_player_position[player_index] == _BOARD_SIZE - 1) {
+    // Player reached last tile (the finish)
+    if (_player_position[player_index] == _lane_length - 1) {
         return true;
     }
 
     return false;
 }
 
+int Board::advancePlayers(const int* steps) {
+    int finish = _lane_length - 1;
+    int finished = 0;
+    int* positions = _player_position.data();
+
+    // Branch-free clamp so the compiler can vectorize the loop
+    for (int i = 0; i < _player_count; i++) {
+        int moved = positions[i] + steps[i];
+        positions[i] = moved < finish ? moved : finish;
+        finished += (positions[i] == finish);
+    }
+    return finished;
+}
+
 void Board::setPlayerPosition(int player_index, int position) {
     if (player_index >= 0 && player_index < _player_count) {
         if (position < 0) {
             _player_position[player_index] = 0;  
-        } else if (position >= _BOARD_SIZE) {
-            _player_position[player_index] = _BOARD_SIZE - 1;  
+        } else if (position >= _lane_length) {
+            _player_position[player_index] = _lane_length - 1;  
         } else {
             _player_position[player_index] = position; 
         }
@@ -172,11 +303,45 @@ int Board::getPlayerPosition(int player_index) const {
 }
 
 char Board::getTileColor(int player_index, int position) const {
+    return tileCodeToColor(getTileCode(player_index, position));
+}
+
+int Board::getTileCode(int player_index, int position) const {
     if (player_index >= 0 && player_index < _player_count && 
-        position >= 0 && position < _BOARD_SIZE) {
-        return _tiles[player_index][position].color;
+        position >= 0 && position < _lane_length) {
+        return tileCodeAt(player_index, position);
     }
-    return ' '; 
+    return TILE_CODE_COUNT; 
+}
+
+int Board::getLaneCount() const {
+    return _player_count;
+}
+
+int Board::getLaneLength() const {
+    return _lane_length;
+}
+
+int Board::getFinishPosition() const {
+    return _lane_length - 1;
+}
+
+const unsigned char* Board::getLaneData() const {
+    return _tiles.data();
+}
+
+int Board::getLaneDataSize() const {
+    return (int)_tiles.size();
+}
+
+void Board::restoreLanes(int lane_count, int lane_length, const unsigned char* lane_data, const int* positions) {
+    _player_count = lane_count;
+    _lane_length = lane_length;
+    _lane_stride = (lane_length + 1) / 2;
+
+    // assign() reuses the existing buffers when the size matches, so resuming stays allocation free
+    _tiles.assign(lane_data, lane_data + (size_t)_player_count * _lane_stride);
+    _player_position.assign(positions, positions + _player_count);
 }
 
 void Board::triggerTileEvent(int player_index, Player& player) {
@@ -185,4 +350,4 @@ void Board::triggerTileEvent(int player_index, Player& player) {
     
     // This method will be called from main.cpp where the actual event logic is implemented
     // The tile color is passed to determine which event to trigger
-}
\ No newline at end of file
+}
@@ -3,56 +3,130 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-// Tile struct definition (moved from Tile.h)
-// Represents a single tile on the game board with a color property
-// Color codes: 'G'=Green, 'B'=Blue, 'P'=Pink, 'R'=Red, 'T'=Brown, 'U'=Purple, 'O'=Orange, 'Y'=Grey
-struct Tile {
-    char color;
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+#include "Random.h"
+
+using namespace std;
+
+// Tile codes: every tile is stored as a 4-bit code (two tiles packed per byte)
+// Color chars: 'Y'=Grey, 'G'=Green, 'B'=Blue, 'P'=Pink, 'T'=Brown, 'R'=Red, 'U'=Purple, 'O'=Orange
+enum TileCode {
+    TILE_START = 0,     // 'Y' Grey - start
+    TILE_GREEN = 1,     // 'G' Regular tile
+    TILE_BLUE = 2,      // 'B' Training Fellowship (DNA Task 1)
+    TILE_PINK = 3,      // 'P' Direct Lab Assignment (DNA Task 2)
+    TILE_BROWN = 4,     // 'T' Special Event (DNA Task 4)
+    TILE_RED = 5,       // 'R' Challenge (DNA Task 3)
+    TILE_PURPLE = 6,    // 'U' Bonus tile
+    TILE_FINISH = 7,    // 'O' Orange - finish line
+    TILE_CODE_COUNT = 8
+};
+
+// Color char of every tile code, and the points a correct task answer gives on it (purple: the fixed part of its
+// bonus); constexpr so fixed-size boards (FixedBoard.h) can fold them into their lane scans
+static constexpr char TILE_COLOR_CHARS[TILE_CODE_COUNT] = {'Y', 'G', 'B', 'P', 'T', 'R', 'U', 'O'};
+static constexpr int TILE_TASK_POINTS[TILE_CODE_COUNT] = {0, 0, 200, 200, 150, 200, 300, 0};
+
+// Convert between 4-bit tile codes and the color chars used by the game logic
+char tileCodeToColor(int code);
+int tileColorToCode(char color);
+
+// TileMix: how lanes are generated - green tiles per 52 (scaled for other lane lengths), then the
+// relative weights of the other colors for every non-green tile (the classic mix is 30 green, 1:1:1:1:1)
+static const int TILE_MIX_COLORS = 5;          // blue, pink, brown, red, purple
+static const int TILE_MIX_MAX_WEIGHT = 16;
+
+struct TileMix {
+    int greenPer52;
+    int weights[TILE_MIX_COLORS];
+
+    TileMix() : greenPer52(30), weights{1, 1, 1, 1, 1} {
+    }
 };
 
 // Forward declaration - tells compiler Player class exists (defined in Player.h)
 // Used to avoid circular dependencies
 class Player;
 
-// Board class: Manages the game board with two lanes (one per player)
-// Each lane has 52 tiles with different colors/types that trigger different events
+// Board class: Manages the game board with one lane per player
+// Lanes are stored structure-of-arrays style: one contiguous block of packed tile codes
+// (lane after lane) and one array of positions, so thousands of lanes stay cache friendly
 class Board {
     private:
-        // Static in this context: Belongs to the class, not each object
-        // Board has 52 tiles (positions 0-51, where 51 is the finish line)
-        static const int _BOARD_SIZE = 52;
-        // Maximum number of players (this is a 2-player game)
-        static const int _MAX_PLAYERS = 2;
-
-        // Composition! Board contains an array of Tile objects
-        // _tiles[player_index][tile_position] - 2 lanes, each with 52 tiles
-        Tile _tiles[2][_BOARD_SIZE];
+        // Defaults for the classic game: 2 lanes of 52 tiles (positions 0-51, where 51 is the finish line)
+        static const int _DEFAULT_LANES = 2;
+        static const int _DEFAULT_LENGTH = 52;
 
-        // Number of players (always 2 in this game)
+        // Number of lanes (one per player)
         int _player_count;
+        // Tiles in every lane
+        int _lane_length;
+        // Bytes used by one lane (two 4-bit tiles per byte)
+        int _lane_stride;
+
+        // Packed tile codes, lane-major: lane i starts at _tiles[i * _lane_stride]
+        // (both arrays come from the board's memory resource, e.g. a per-game arena)
+        pmr::vector<unsigned char> _tiles;
         // Current position of each player on their respective lane
-        int _player_position[_MAX_PLAYERS];
+        pmr::vector<int> _player_position;
+
+        // Generator used for lane generation (seeded from rand() so srand() still controls the game)
+        Random _random;
+        // Color mix for new lanes, and its weights expanded into a pick table (one entry per unit of weight)
+        TileMix _tile_mix;
+        unsigned char _color_table[TILE_MIX_COLORS * TILE_MIX_MAX_WEIGHT];
+        int _color_table_size;
 
         // Private helper functions:
-        // Initialize tiles for a specific player's lane with random colors
-        void initializeTiles(int player_index);
+        // Generate tiles for lanes [first_lane, first_lane + lane_count) in one batch
+        void initializeTiles(int first_lane, int lane_count);
         // Check if a player is currently on a specific tile position
         bool isPlayerOnTile(int player_index, int pos);
         // Display a single tile with appropriate color and player marker
-        void displayTile(int player_index, int pos);
+        void displayTile(int player_index, int pos, ostream& out);
+
+        // Unchecked packed tile access
+        int tileCodeAt(int player_index, int position) const {
+            unsigned char packed = _tiles[player_index * _lane_stride + (position >> 1)];
+            return (position & 1) ? (packed >> 4) : (packed & 0x0F);
+        }
 
     public:
-        // Default Constructor - creates board and initializes both lanes
+        // Default Constructor - creates the classic 2-lane, 52-tile board
         Board();
+        // Default Constructor with tiles and positions allocated from resource
+        explicit Board(pmr::memory_resource* resource);
+        // Parameterized Constructor - creates lane_count lanes of lane_length tiles each
+        Board(int lane_count, int lane_length);
+        // Same, with tiles and positions allocated from resource (which must outlive the board)
+        Board(int lane_count, int lane_length, pmr::memory_resource* resource);
+
+        // Regenerate the board as lane_count lanes of lane_length tiles, lane generator seeded with seed
+        // (storage is reused, so a board can serve game after game without reallocating)
+        void reset(int lane_count, int lane_length, uint64_t seed);
+
+        // Color mix used by the next reset (weights are clamped to 1-TILE_MIX_MAX_WEIGHT)
+        void setTileMix(const TileMix& mix);
+        const TileMix& getTileMix() const;
+        // Expected total of tile_value[code] over the tiles a d6 walk lands on, start to finish
+        // (landing chances only depend on position, so this is one pass over the lane)
+        double expectedLaneValue(int lane, const double* tile_value) const;
+        // Re-roll lanes until all lanes' expected values are within max_gap of each other, at most
+        // max_tries draws per lane (then the closest draw is kept); false if it had to give up
+        bool balanceLanes(const double* tile_value, double max_gap, int max_tries);
 
-        // Initialize both player lanes with random tile distributions
+        // Initialize every lane with random tile distributions
         void initializeBoard();
-        // Display a single player's track (all 52 tiles in their lane)
-        void displayTrack(int player_index);
-        // Display both players' tracks (the entire board)
-        void displayBoard();
+        // Display a single player's track (all tiles in their lane)
+        void displayTrack(int player_index, ostream& out = cout);
+        // Display every player's track (the entire board)
+        void displayBoard(ostream& out = cout);
         // Move a player forward by 1 tile, returns true if they reached finish
         bool movePlayer(int player_index);
+        // Move every player at once by steps[i] tiles (clamped at the finish), returns how many are on the finish
+        int advancePlayers(const int* steps);
         // Set a player's position (with bounds checking)
         void setPlayerPosition(int player_index, int position);
         // Recall we can use const for getter functions
@@ -60,8 +134,20 @@ class Board {
         int getPlayerPosition(int player_index) const;
         // Get the color of a tile at a specific position for a specific player
         char getTileColor(int player_index, int position) const;
+        // Get the 4-bit code of a tile (TILE_CODE_COUNT if out of bounds)
+        int getTileCode(int player_index, int position) const;
+        // Board dimensions
+        int getLaneCount() const;
+        int getLaneLength() const;
+        // Position of the finish line (last tile of every lane)
+        int getFinishPosition() const;
+        // Raw lane storage (packed tile codes, lane after lane) for saving snapshots
+        const unsigned char* getLaneData() const;
+        int getLaneDataSize() const;
+        // Replace every lane and position with saved data (no regeneration)
+        void restoreLanes(int lane_count, int lane_length, const unsigned char* lane_data, const int* positions);
         // Trigger the event associated with the tile a player is on (placeholder - logic in main.cpp)
         void triggerTileEvent(int player_index, Player& player);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,125 @@
+#include "BotPlanner.h"
+#include "Game.h"
+
+using namespace std;
+
+// points for a correct answer to a tile's task (purple counts the mean of its random bonus)
+static double taskReward(int tileCode) {
+    if (tileCode == TILE_PURPLE) {
+        return tileTaskPoints(tileCode) + PURPLE_BONUS_SPREAD / 2.0;
+    }
+    return tileTaskPoints(tileCode);
+}
+
+// CONSTRUCTORS
+
+// for every tile code with a task, average the events that tile allows; a negative event is
+// worth nothing to the advisor it names (triggerRandomEvent's protection rule)
+BotPlanner::BotPlanner(const GameData& gameData) {
+    for (int code = 0; code < TILE_CODE_COUNT; code++) {
+        for (int advisor = 0; advisor <= _ADVISOR_COUNT; advisor++) {
+            _tile_value[advisor][code] = 0;
+        }
+        if (taskReward(code) == 0) {
+            continue;
+        }
+
+        char color = tileCodeToColor(code);
+        int eventCount = gameData.getTileEventCount(color);
+        for (int advisor = 0; advisor <= _ADVISOR_COUNT; advisor++) {
+            double eventTotal = 0;
+            for (int i = 0; i < eventCount; i++) {
+                RandomEvent e = gameData.getTileEvent(color, i);
+                bool protectedByAdvisor = e.advisor > 0 && e.discoveryPoints < 0 && advisor == e.advisor;
+                if (!protectedByAdvisor) {
+                    eventTotal += e.discoveryPoints;
+                }
+            }
+            _tile_value[advisor][code] = taskReward(code) + (eventCount > 0 ? eventTotal / eventCount : 0);
+        }
+    }
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+// backward pass from the finish: a roll lands on min(position + d, finish), and only tiles before
+// the finish trigger anything (playTurn skips the finish tile)
+void BotPlanner::laneValues(const Board& board, int lane, int advisor, double* values) const {
+    int finish = board.getFinishPosition();
+    double tileValue[_MAX_LANE_LENGTH];
+    for (int pos = 0; pos < finish; pos++) {
+        tileValue[pos] = _tile_value[advisor][board.getTileCode(lane, pos)];
+    }
+
+    values[finish] = 0;
+    for (int pos = finish - 1; pos >= 0; pos--) {
+        double total = 0;
+        for (int roll = 1; roll <= 6; roll++) {
+            int next = pos + roll < finish ? pos + roll : finish;
+            total += values[next] + (next < finish ? tileValue[next] : 0);
+        }
+        values[pos] = total / 6;
+    }
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+double BotPlanner::expectedRemaining(const Board& board, int lane, int position, int advisor) const {
+    if (lane < 0 || lane >= board.getLaneCount() || board.getLaneLength() > _MAX_LANE_LENGTH) {
+        return 0;
+    }
+    if (position < 0 || position >= board.getFinishPosition()) {
+        return 0;
+    }
+    if (advisor < 0 || advisor > _ADVISOR_COUNT) {
+        advisor = 0;
+    }
+    double values[_MAX_LANE_LENGTH];
+    laneValues(board, lane, advisor, values);
+    return values[position];
+}
+
+const double* BotPlanner::getTileValues(int advisor) const {
+    if (advisor < 0 || advisor > _ADVISOR_COUNT) {
+        advisor = 0;
+    }
+    return _tile_value[advisor];
+}
+
+int BotPlanner::chooseAdvisor(const Board& board, int lane) const {
+    int best = 1;
+    double bestValue = expectedRemaining(board, lane, 0, 1);
+    for (int advisor = 2; advisor <= _ADVISOR_COUNT; advisor++) {
+        double value = expectedRemaining(board, lane, 0, advisor);
+        if (value > bestValue) {
+            best = advisor;
+            bestValue = value;
+        }
+    }
+    return best;
+}
+
+// max node over the two paths: apply each path's cost and trait bonuses to a copy of the player,
+// score it like the end of the game, add what the lane is expected to give with that path's advisor
+BotDecision BotPlanner::decide(const Board& board, int lane, const Player& player) const {
+    Player fellowship = player;
+    applyPathType(fellowship, 0);
+    Player direct = player;
+    applyPathType(direct, 1);
+
+    int advisor = chooseAdvisor(board, lane);
+    double fellowshipScore = calculateFinalDiscoverPoints(fellowship) + expectedRemaining(board, lane, 0, advisor);
+    double directScore = calculateFinalDiscoverPoints(direct) + expectedRemaining(board, lane, 0, 0);
+
+    BotDecision decision;
+    if (fellowshipScore >= directScore) {
+        decision.pathType = 0;
+        decision.advisor = advisor;
+        decision.expectedScore = fellowshipScore;
+    } else {
+        decision.pathType = 1;
+        decision.advisor = 0;
+        decision.expectedScore = directScore;
+    }
+    return decision;
+}
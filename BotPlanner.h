@@ -0,0 +1,47 @@
+#ifndef BOTPLANNER_H
+#define BOTPLANNER_H
+
+#include "Board.h"
+#include "ContentBundle.h"
+#include "Player.h"
+
+using namespace std;
+
+// what a computer player picks at setup, and the final score it expects from it
+struct BotDecision {
+    int pathType;           // 0 = Training Fellowship, 1 = Direct Lab Assignment
+    int advisor;            // 1-5, 0 with Direct Lab Assignment
+    double expectedScore;   // expected final discovery points (with trait bonuses)
+};
+
+// BotPlanner: chooses path and advisor for computer players by expectimax over their own lane
+// Chance nodes are the d6 roll, the random event on the tile landed on and the purple bonus; the bot
+// answers every DNA task correctly. What a tile is worth (per tile code and advisor) is worked out once
+// from the event tables in the constructor, so a decision is one backward pass over the lane per advisor.
+// Tile rewards don't depend on the points a player already has, so the lane position is the whole state.
+class BotPlanner {
+    private:
+        static const int _ADVISOR_COUNT = 5;
+        static const int _MAX_LANE_LENGTH = 256;
+
+        // expected discovery points for landing on a tile, per advisor (0 = none) and tile code: task reward plus random event
+        double _tile_value[_ADVISOR_COUNT + 1][TILE_CODE_COUNT];
+
+        // expected points from position to the finish on lane, for each position (values has lane length entries)
+        void laneValues(const Board& board, int lane, int advisor, double* values) const;
+
+    public:
+        // build the tile value table from the content (call again with new content after a reload)
+        BotPlanner(const GameData& gameData);
+
+        // expected discovery points still to come for a player at position on lane
+        double expectedRemaining(const Board& board, int lane, int position, int advisor) const;
+        // expected points for landing on each tile code (TILE_CODE_COUNT values), e.g. for Board::balanceLanes
+        const double* getTileValues(int advisor) const;
+        // advisor (1-5) that protects the most expected points on lane
+        int chooseAdvisor(const Board& board, int lane) const;
+        // best path and advisor for player (with the character's starting stats) on lane
+        BotDecision decide(const Board& board, int lane, const Player& player) const;
+};
+
+#endif
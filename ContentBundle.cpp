@@ -0,0 +1,353 @@
+#include "ContentBundle.h"
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <unordered_map>
+#include "Board.h"
+#include "RiddleBank.h"
+
+using namespace std;
+
+// fixed-size header at the start of every bundle
+struct ContentHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t characterCount;
+    uint32_t riddleCount;
+    uint32_t eventCount;
+    uint32_t stringBytes;
+    // events for tile code c are eventIndex[tileEventStart[c]] .. eventIndex[tileEventStart[c + 1] - 1]
+    uint32_t tileEventStart[TILE_CODE_COUNT + 1];
+    uint64_t totalSize;
+};
+
+// one character, name is in the string table
+struct CharacterRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int32_t experience;
+    int32_t accuracy;
+    int32_t efficiency;
+    int32_t insight;
+    int32_t discoverPoints;
+};
+
+// the answer is also stored normalized, so checking a typed answer never re-normalizes it
+struct RiddleRecord {
+    uint32_t questionOffset;
+    uint32_t questionLength;
+    uint32_t answerOffset;
+    uint32_t answerLength;
+    uint32_t normalizedOffset;
+    uint32_t normalizedLength;
+};
+
+struct EventRecord {
+    uint32_t descriptionOffset;
+    uint32_t descriptionLength;
+    int32_t pathType;
+    int32_t advisor;
+    int32_t discoveryPoints;
+};
+
+// byte offset of every section, all derived from the header counts
+struct ContentLayout {
+    size_t characters;
+    size_t riddles;
+    size_t events;
+    size_t eventIndex;
+    size_t strings;
+    size_t total;
+};
+
+static size_t padTo8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static ContentLayout layoutFor(const ContentHeader& header) {
+    ContentLayout layout;
+    layout.characters = padTo8(sizeof(ContentHeader));
+    layout.riddles = layout.characters + padTo8(header.characterCount * sizeof(CharacterRecord));
+    layout.events = layout.riddles + padTo8(header.riddleCount * sizeof(RiddleRecord));
+    layout.eventIndex = layout.events + padTo8(header.eventCount * sizeof(EventRecord));
+    layout.strings = layout.eventIndex + padTo8(header.tileEventStart[TILE_CODE_COUNT] * sizeof(uint32_t));
+    layout.total = layout.strings + padTo8(header.stringBytes);
+    return layout;
+}
+
+// blue tiles only draw Training Fellowship events, pink tiles only Direct Lab Assignment events, others draw any
+static bool eventFitsTile(const RandomEvent& event, char tileColor) {
+    if (tileColor == 'B') {
+        return event.pathType == 0;
+    } else if (tileColor == 'P') {
+        return event.pathType == 1;
+    }
+    return true;
+}
+
+// StringTable: collects every string once while compiling
+struct StringTable {
+    string bytes;
+    unordered_map<string, uint32_t> offsets;
+
+    uint32_t add(string_view text) {
+        string key(text);
+        unordered_map<string, uint32_t>::iterator it = offsets.find(key);
+        if (it != offsets.end()) {
+            return it->second;
+        }
+        uint32_t offset = bytes.size();
+        bytes.append(text.data(), text.size());
+        offsets.insert(make_pair(key, offset));
+        return offset;
+    }
+};
+
+// fill records and strings, group event numbers by tile code, then lay everything out behind the header
+void compileContent(const ContentSource& source, vector<char>& buffer) {
+    StringTable strings;
+
+    vector<CharacterRecord> characters(source.characters.size());
+    for (size_t i = 0; i < source.characters.size(); i++) {
+        const Player& p = source.characters[i];
+        const string& name = p.getCharacterName();
+        characters[i].nameOffset = strings.add(name);
+        characters[i].nameLength = name.length();
+        characters[i].experience = p.getExperience();
+        characters[i].accuracy = p.getAccuracy();
+        characters[i].efficiency = p.getEfficiency();
+        characters[i].insight = p.getInsight();
+        characters[i].discoverPoints = p.getDiscoverPoints();
+    }
+
+    vector<RiddleRecord> riddles(source.riddles.size());
+    string normalized;
+    for (size_t i = 0; i < source.riddles.size(); i++) {
+        riddles[i].questionOffset = strings.add(source.riddles[i].question);
+        riddles[i].questionLength = source.riddles[i].question.length();
+        riddles[i].answerOffset = strings.add(source.riddles[i].answer);
+        riddles[i].answerLength = source.riddles[i].answer.length();
+        normalizeText(source.riddles[i].answer, normalized);
+        riddles[i].normalizedOffset = strings.add(normalized);
+        riddles[i].normalizedLength = normalized.length();
+    }
+
+    vector<EventRecord> events(source.randomEvents.size());
+    for (size_t i = 0; i < source.randomEvents.size(); i++) {
+        const RandomEvent& e = source.randomEvents[i];
+        events[i].descriptionOffset = strings.add(e.description);
+        events[i].descriptionLength = e.description.length();
+        events[i].pathType = e.pathType;
+        events[i].advisor = e.advisor;
+        events[i].discoveryPoints = e.discoveryPoints;
+    }
+
+    ContentHeader header;
+    memset(&header, 0, sizeof(header));
+    vector<uint32_t> eventIndex;
+    for (int code = 0; code < TILE_CODE_COUNT; code++) {
+        header.tileEventStart[code] = eventIndex.size();
+        char color = tileCodeToColor(code);
+        for (size_t i = 0; i < source.randomEvents.size(); i++) {
+            if (eventFitsTile(source.randomEvents[i], color)) {
+                eventIndex.push_back(i);
+            }
+        }
+    }
+    header.tileEventStart[TILE_CODE_COUNT] = eventIndex.size();
+
+    memcpy(header.magic, CONTENT_MAGIC, 4);
+    header.version = CONTENT_VERSION;
+    header.characterCount = characters.size();
+    header.riddleCount = riddles.size();
+    header.eventCount = events.size();
+    header.stringBytes = strings.bytes.size();
+    ContentLayout layout = layoutFor(header);
+    header.totalSize = layout.total;
+
+    buffer.assign(layout.total, 0);
+    memcpy(buffer.data(), &header, sizeof(header));
+    memcpy(buffer.data() + layout.characters, characters.data(), characters.size() * sizeof(CharacterRecord));
+    memcpy(buffer.data() + layout.riddles, riddles.data(), riddles.size() * sizeof(RiddleRecord));
+    memcpy(buffer.data() + layout.events, events.data(), events.size() * sizeof(EventRecord));
+    memcpy(buffer.data() + layout.eventIndex, eventIndex.data(), eventIndex.size() * sizeof(uint32_t));
+    memcpy(buffer.data() + layout.strings, strings.bytes.data(), strings.bytes.size());
+}
+
+// write everything to filename.tmp, fsync, rename into place
+bool saveContentBundle(const vector<char>& buffer, const string& filename) {
+    string tempName = filename + ".tmp";
+    int fd = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+        if (n <= 0) {
+            close(fd);
+            unlink(tempName.c_str());
+            return false;
+        }
+        written += n;
+    }
+
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(tempName.c_str());
+        return false;
+    }
+    close(fd);
+
+    if (rename(tempName.c_str(), filename.c_str()) != 0) {
+        unlink(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// GAME DATA
+
+GameData::GameData() {
+    _base = nullptr;
+    _size = 0;
+}
+
+// check magic, version, index bounds and that the sections fit; records are only read on access
+bool GameData::attach(const char* data, size_t size) {
+    _base = nullptr;
+    _size = 0;
+    if (data == nullptr || size < sizeof(ContentHeader)) {
+        return false;
+    }
+
+    const ContentHeader* header = (const ContentHeader*)data;
+    if (memcmp(header->magic, CONTENT_MAGIC, 4) != 0 || header->version != CONTENT_VERSION) {
+        return false;
+    }
+    for (int code = 0; code < TILE_CODE_COUNT; code++) {
+        if (header->tileEventStart[code] > header->tileEventStart[code + 1]) {
+            return false;
+        }
+    }
+    ContentLayout layout = layoutFor(*header);
+    if (header->totalSize != layout.total || layout.total > size) {
+        return false;
+    }
+
+    _base = data;
+    _size = layout.total;
+    return true;
+}
+
+bool GameData::openBundle(const string& filename) {
+    _owned.clear();
+    if (!_file.open(filename, false)) {
+        return false;
+    }
+    if (!attach(_file.data(), _file.size())) {
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+bool GameData::adoptBundle(vector<char>& buffer) {
+    _file.close();
+    _owned.swap(buffer);
+    buffer.clear();
+    return attach(_owned.data(), _owned.size());
+}
+
+// strings pointing outside the table (a corrupt bundle) come back empty instead of reading past it
+string_view GameData::stringAt(unsigned int offset, unsigned int length) const {
+    const ContentHeader* header = (const ContentHeader*)_base;
+    if ((size_t)offset + length > header->stringBytes) {
+        return string_view();
+    }
+    return string_view(_base + layoutFor(*header).strings + offset, length);
+}
+
+int GameData::getCharacterCount() const {
+    if (_base == nullptr) {
+        return 0;
+    }
+    return ((const ContentHeader*)_base)->characterCount;
+}
+
+CharacterInfo GameData::getCharacterInfo(int index) const {
+    const ContentHeader* header = (const ContentHeader*)_base;
+    const CharacterRecord& r = ((const CharacterRecord*)(_base + layoutFor(*header).characters))[index];
+    CharacterInfo info;
+    info.name = stringAt(r.nameOffset, r.nameLength);
+    info.experience = r.experience;
+    info.accuracy = r.accuracy;
+    info.efficiency = r.efficiency;
+    info.insight = r.insight;
+    info.discoverPoints = r.discoverPoints;
+    return info;
+}
+
+Player GameData::getCharacter(int index) const {
+    CharacterInfo info = getCharacterInfo(index);
+    return Player(string(info.name), info.experience, info.accuracy, info.efficiency, info.insight, info.discoverPoints);
+}
+
+int GameData::getRiddleCount() const {
+    if (_base == nullptr) {
+        return 0;
+    }
+    return ((const ContentHeader*)_base)->riddleCount;
+}
+
+Riddle GameData::getRiddle(int index) const {
+    const ContentHeader* header = (const ContentHeader*)_base;
+    const RiddleRecord& r = ((const RiddleRecord*)(_base + layoutFor(*header).riddles))[index];
+    Riddle riddle;
+    riddle.question = stringAt(r.questionOffset, r.questionLength);
+    riddle.answer = stringAt(r.answerOffset, r.answerLength);
+    riddle.normalizedAnswer = stringAt(r.normalizedOffset, r.normalizedLength);
+    return riddle;
+}
+
+int GameData::getEventCount() const {
+    if (_base == nullptr) {
+        return 0;
+    }
+    return ((const ContentHeader*)_base)->eventCount;
+}
+
+RandomEvent GameData::getEvent(int index) const {
+    const ContentHeader* header = (const ContentHeader*)_base;
+    const EventRecord& r = ((const EventRecord*)(_base + layoutFor(*header).events))[index];
+    RandomEvent event;
+    event.description = stringAt(r.descriptionOffset, r.descriptionLength);
+    event.pathType = r.pathType;
+    event.advisor = r.advisor;
+    event.discoveryPoints = r.discoveryPoints;
+    return event;
+}
+
+int GameData::getTileEventCount(char tileColor) const {
+    int code = tileColorToCode(tileColor);
+    if (_base == nullptr || code >= TILE_CODE_COUNT) {
+        return 0;
+    }
+    const ContentHeader* header = (const ContentHeader*)_base;
+    return header->tileEventStart[code + 1] - header->tileEventStart[code];
+}
+
+RandomEvent GameData::getTileEvent(char tileColor, int index) const {
+    const ContentHeader* header = (const ContentHeader*)_base;
+    int code = tileColorToCode(tileColor);
+    const uint32_t* eventIndex = (const uint32_t*)(_base + layoutFor(*header).eventIndex);
+    uint32_t eventNumber = eventIndex[header->tileEventStart[code] + index];
+    if (eventNumber >= header->eventCount) {
+        RandomEvent empty = {string_view(), 0, 0, 0};
+        return empty;
+    }
+    return getEvent(eventNumber);
+}
@@ -0,0 +1,93 @@
+#ifndef CONTENTBUNDLE_H
+#define CONTENTBUNDLE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Player.h"
+#include "ContentParser.h"
+
+using namespace std;
+
+// store question and answer for riddles (views into the content's string storage)
+// normalizedAnswer is filled in when content is compiled (see normalizeText), empty in a ContentSource
+struct Riddle {
+    string_view question;
+    string_view answer;
+    string_view normalizedAnswer;
+};
+
+// store random event info with description, path type, advisor, and discovery points change
+struct RandomEvent {
+    string_view description; // view into the content's string storage
+    int pathType;
+    int advisor;
+    int discoveryPoints;
+};
+
+// character stats straight from the bundle (the name is a view, so listing characters copies nothing)
+struct CharacterInfo {
+    string_view name;
+    int experience;
+    int accuracy;
+    int efficiency;
+    int insight;
+    int discoverPoints;
+};
+
+// ContentSource: game content as parsed from the text files, the input of the content compiler
+struct ContentSource {
+    vector<Player> characters;
+    vector<Riddle> riddles;
+    vector<RandomEvent> randomEvents;
+    StringArena text;
+};
+
+// Binary content bundle: everything GameData needs, laid out so it can be used straight from mmap
+// Layout: ContentHeader, CharacterRecord per character, RiddleRecord per riddle, EventRecord per event,
+// uint32 event index (event numbers grouped by tile code), then the string table (all padded to 8 bytes)
+static const char CONTENT_MAGIC[4] = {'J', 'T', 'G', 'C'};
+static const unsigned int CONTENT_VERSION = 2;
+
+// turn parsed content into bundle bytes (buffer is overwritten)
+void compileContent(const ContentSource& source, vector<char>& buffer);
+// write bundle bytes to a temp file, fsync, then rename over filename
+bool saveContentBundle(const vector<char>& buffer, const string& filename);
+
+// GameData: read-only view over a content bundle, either mapped from a file or held in memory
+// Opening a mapped bundle only checks the header and section sizes, so startup doesn't grow with the
+// content, and every process mapping the same file shares its pages
+class GameData {
+    private:
+        MappedFile _file;
+        vector<char> _owned;
+        const char* _base;
+        size_t _size;
+
+        // attach to bundle bytes, returns false (and stays empty) if they aren't a valid bundle
+        bool attach(const char* data, size_t size);
+        string_view stringAt(unsigned int offset, unsigned int length) const;
+
+    public:
+        GameData();
+        GameData(const GameData&) = delete;
+        GameData& operator=(const GameData&) = delete;
+
+        // mmap a bundle file, returns false if it is missing or not a valid bundle of this version
+        bool openBundle(const string& filename);
+        // take over in-memory bundle bytes (buffer is left empty)
+        bool adoptBundle(vector<char>& buffer);
+
+        int getCharacterCount() const;
+        CharacterInfo getCharacterInfo(int index) const;
+        Player getCharacter(int index) const;
+        int getRiddleCount() const;
+        Riddle getRiddle(int index) const;
+        int getEventCount() const;
+        RandomEvent getEvent(int index) const;
+        // events that can happen on a tile of this color (prebuilt index, no filtering at play time)
+        int getTileEventCount(char tileColor) const;
+        RandomEvent getTileEvent(char tileColor, int index) const;
+};
+
+#endif
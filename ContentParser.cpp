@@ -0,0 +1,180 @@
+#include "ContentParser.h"
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// MAPPED FILE
+
+MappedFile::MappedFile() {
+    _data = nullptr;
+    _size = 0;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// open, fstat for the size, mmap read-only, close the descriptor (the mapping stays)
+bool MappedFile::open(const string& filename, bool sequential) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    if (info.st_size > 0) {
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        madvise(mapped, info.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        _data = (const char*)mapped;
+        _size = info.st_size;
+    }
+
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data != nullptr) {
+        munmap((void*)_data, _size);
+    }
+    _data = nullptr;
+    _size = 0;
+}
+
+const char* MappedFile::data() const {
+    return _data;
+}
+
+size_t MappedFile::size() const {
+    return _size;
+}
+
+// STRING ARENA
+
+StringArena::StringArena() {
+    _chunk_used = 0;
+    _chunk_capacity = 0;
+}
+
+// look the text up first, otherwise copy it into the current chunk (new chunk if it doesn't fit)
+string_view StringArena::intern(string_view text) {
+    unordered_set<string_view>::iterator it = _index.find(text);
+    if (it != _index.end()) {
+        return *it;
+    }
+
+    if (_chunk_used + text.size() > _chunk_capacity) {
+        size_t capacity = text.size() > _CHUNK_SIZE ? text.size() : _CHUNK_SIZE;
+        _chunks.push_back(unique_ptr<char[]>(new char[capacity]));
+        _chunk_used = 0;
+        _chunk_capacity = capacity;
+    }
+
+    char* copy = _chunks.back().get() + _chunk_used;
+    if (!text.empty()) {
+        memcpy(copy, text.data(), text.size());
+    }
+    _chunk_used += text.size();
+
+    string_view stored(copy, text.size());
+    _index.insert(stored);
+    return stored;
+}
+
+size_t StringArena::size() const {
+    return _index.size();
+}
+
+// PIPE RECORD READER
+
+PipeRecordReader::PipeRecordReader(const char* data, size_t size) {
+    _cursor = data;
+    _end = data + size;
+    _line_number = 0;
+}
+
+// find the next '\n' with memchr, hand out the line without it (and without a trailing '\r')
+bool PipeRecordReader::nextLine(string_view& line) {
+    if (_cursor == nullptr || _cursor >= _end) {
+        return false;
+    }
+
+    const char* newline = (const char*)memchr(_cursor, '\n', _end - _cursor);
+    const char* lineEnd = (newline != nullptr) ? newline : _end;
+    size_t length = lineEnd - _cursor;
+    if (length > 0 && _cursor[length - 1] == '\r') {
+        length--;
+    }
+
+    line = string_view(_cursor, length);
+    _cursor = (newline != nullptr) ? newline + 1 : _end;
+    _line_number++;
+    return true;
+}
+
+void PipeRecordReader::splitFields(string_view line, vector<string_view>& fields, int maxFields) {
+    fields.clear();
+    size_t start = 0;
+    while (true) {
+        if (maxFields > 0 && (int)fields.size() == maxFields - 1) {
+            fields.push_back(line.substr(start));
+            return;
+        }
+        size_t pipePos = line.find('|', start);
+        if (pipePos == string_view::npos) {
+            fields.push_back(line.substr(start));
+            return;
+        }
+        fields.push_back(line.substr(start, pipePos - start));
+        start = pipePos + 1;
+    }
+}
+
+int PipeRecordReader::getLineNumber() const {
+    return _line_number;
+}
+
+// HELPERS
+
+bool parseInt(string_view field, int& value) {
+    size_t first = 0;
+    size_t last = field.size();
+    while (first < last && (field[first] == ' ' || field[first] == '\t')) {
+        first++;
+    }
+    while (last > first && (field[last - 1] == ' ' || field[last - 1] == '\t')) {
+        last--;
+    }
+    if (first == last) {
+        return false;
+    }
+
+    const char* begin = field.data() + first;
+    const char* end = field.data() + last;
+    // from_chars doesn't accept a leading '+'
+    if (*begin == '+') {
+        begin++;
+    }
+    from_chars_result result = from_chars(begin, end, value);
+    return result.ec == errc() && result.ptr == end;
+}
+
+void reportParseError(ostream& errors, const string& filename, int lineNumber, const string& message) {
+    errors << "Error: " << filename << ":" << lineNumber << ": " << message << endl;
+}
@@ -0,0 +1,85 @@
+#ifndef CONTENTPARSER_H
+#define CONTENTPARSER_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+// MappedFile: a whole file mapped read-only into memory (no copy into a string)
+class MappedFile {
+    private:
+        const char* _data;
+        size_t _size;
+
+    public:
+        MappedFile();
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // map the file, returns false if it can't be opened (an empty file maps to size 0)
+        // sequential = read once front to back (more readahead), false for random access
+        bool open(const string& filename, bool sequential = true);
+        void close();
+        const char* data() const;
+        size_t size() const;
+};
+
+// StringArena: owns interned strings in large chunks
+// Equal strings are stored once, and the returned string_views stay valid as long as the arena
+// (chunks never move, even when the arena itself is moved)
+class StringArena {
+    private:
+        static const size_t _CHUNK_SIZE = 64 * 1024;
+
+        vector<unique_ptr<char[]> > _chunks;
+        size_t _chunk_used;
+        size_t _chunk_capacity;
+        unordered_set<string_view> _index;
+
+    public:
+        StringArena();
+        StringArena(StringArena&&) = default;
+        StringArena& operator=(StringArena&&) = default;
+        StringArena(const StringArena&) = delete;
+        StringArena& operator=(const StringArena&) = delete;
+
+        // copy text into the arena (or find the existing copy) and return a view of it
+        string_view intern(string_view text);
+        // distinct strings stored
+        size_t size() const;
+};
+
+// PipeRecordReader: walks pipe-delimited lines in a buffer and splits them into string_view fields
+// Lines are split in place (no copies); '\r' before '\n' is dropped so CRLF files work too
+class PipeRecordReader {
+    private:
+        const char* _cursor;
+        const char* _end;
+        int _line_number;
+
+    public:
+        PipeRecordReader(const char* data, size_t size);
+
+        // next line, returns false at end of buffer
+        bool nextLine(string_view& line);
+        // split a line on '|' into fields (fields is reused); maxFields > 0 keeps the rest of
+        // the line, pipes included, in the last field
+        static void splitFields(string_view line, vector<string_view>& fields, int maxFields = 0);
+        // line number of the line returned last (1 = first line of the file)
+        int getLineNumber() const;
+};
+
+// convert a field to an int with from_chars (surrounding spaces allowed), false if it isn't a whole number
+bool parseInt(string_view field, int& value);
+
+// print "file:line: message" for a bad record
+void reportParseError(ostream& errors, const string& filename, int lineNumber, const string& message);
+
+#endif
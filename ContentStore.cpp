@@ -0,0 +1,118 @@
+#include "ContentStore.h"
+#include <algorithm>
+
+using namespace std;
+
+// CONTENT STORE
+
+ContentStore::ContentStore(GameData* initial) {
+    _current.store(initial);
+    _slots.store(nullptr);
+    _version.store(1);
+}
+
+// readers must be gone by now, so everything can go
+ContentStore::~ContentStore() {
+    delete _current.load();
+    for (int i = 0; i < (int)_retired.size(); i++) {
+        delete _retired[i];
+    }
+    ReaderSlot* slot = _slots.load();
+    while (slot != nullptr) {
+        ReaderSlot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+// reuse a free slot if there is one, otherwise push a new one onto the list (both lock-free)
+ContentStore::ReaderSlot* ContentStore::acquireSlot() {
+    for (ReaderSlot* slot = _slots.load(); slot != nullptr; slot = slot->next) {
+        bool expected = false;
+        if (!slot->active.load(memory_order_relaxed) && slot->active.compare_exchange_strong(expected, true)) {
+            return slot;
+        }
+    }
+
+    ReaderSlot* slot = new ReaderSlot();
+    slot->hazard.store(nullptr);
+    slot->active.store(true);
+    ReaderSlot* head = _slots.load();
+    do {
+        slot->next = head;
+    } while (!_slots.compare_exchange_weak(head, slot));
+    return slot;
+}
+
+// swap first so new pins see the new version, then retire the old one and free what we can
+void ContentStore::publish(GameData* next) {
+    const GameData* old = _current.exchange(next);
+    _version.fetch_add(1);
+
+    lock_guard<mutex> guard(_retire_lock);
+    _retired.push_back(old);
+    reclaimLocked();
+}
+
+int ContentStore::reclaim() {
+    lock_guard<mutex> guard(_retire_lock);
+    reclaimLocked();
+    return _retired.size();
+}
+
+// collect every pinned version, delete the retired ones that aren't among them
+void ContentStore::reclaimLocked() {
+    if (_retired.empty()) {
+        return;
+    }
+
+    vector<const GameData*> pinned;
+    for (ReaderSlot* slot = _slots.load(); slot != nullptr; slot = slot->next) {
+        const GameData* hazard = slot->hazard.load();
+        if (hazard != nullptr) {
+            pinned.push_back(hazard);
+        }
+    }
+
+    vector<const GameData*> waiting;
+    for (int i = 0; i < (int)_retired.size(); i++) {
+        if (find(pinned.begin(), pinned.end(), _retired[i]) != pinned.end()) {
+            waiting.push_back(_retired[i]);
+        } else {
+            delete _retired[i];
+        }
+    }
+    _retired.swap(waiting);
+}
+
+unsigned long ContentStore::getVersion() const {
+    return _version.load();
+}
+
+// CONTENT READER
+
+ContentReader::ContentReader(ContentStore& store) : _store(store) {
+    _slot = store.acquireSlot();
+}
+
+ContentReader::~ContentReader() {
+    _slot->hazard.store(nullptr);
+    _slot->active.store(false, memory_order_release);
+}
+
+// publish the hazard, then check the version is still current (otherwise it may already be retired), retry if not
+const GameData& ContentReader::pin() {
+    const GameData* data = _store._current.load();
+    while (true) {
+        _slot->hazard.store(data);
+        const GameData* current = _store._current.load();
+        if (current == data) {
+            return *data;
+        }
+        data = current;
+    }
+}
+
+void ContentReader::unpin() {
+    _slot->hazard.store(nullptr, memory_order_release);
+}
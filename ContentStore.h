@@ -0,0 +1,68 @@
+#ifndef CONTENTSTORE_H
+#define CONTENTSTORE_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "ContentBundle.h"
+
+using namespace std;
+
+// ContentStore: the current GameData version, replaceable while games are running (RCU style)
+// Readers pin the current version with a hazard pointer (two atomic stores and a load, no locks);
+// publish swaps in a new version and an old one is deleted once no reader has it pinned
+class ContentStore {
+    private:
+        // one hazard pointer per reader, slots are reused and never freed while the store lives
+        struct ReaderSlot {
+            atomic<const GameData*> hazard;
+            atomic<bool> active;
+            ReaderSlot* next;
+        };
+
+        atomic<const GameData*> _current;
+        atomic<ReaderSlot*> _slots;
+        atomic<unsigned long> _version;
+        // replaced versions not deleted yet (writer side only)
+        mutex _retire_lock;
+        vector<const GameData*> _retired;
+
+        ReaderSlot* acquireSlot();
+        void reclaimLocked();
+
+        friend class ContentReader;
+
+    public:
+        // takes ownership of the first version
+        ContentStore(GameData* initial);
+        ~ContentStore();
+        ContentStore(const ContentStore&) = delete;
+        ContentStore& operator=(const ContentStore&) = delete;
+
+        // make next the current version (takes ownership), the old one is retired
+        void publish(GameData* next);
+        // delete retired versions no reader has pinned, returns how many are still waiting
+        int reclaim();
+        // 1 for the first version, +1 per publish
+        unsigned long getVersion() const;
+};
+
+// ContentReader: one game's handle on a ContentStore
+// pin() returns the current version and keeps it alive until unpin() (or the reader is destroyed),
+// so a turn sees one consistent version even if content is reloaded in the middle of it
+class ContentReader {
+    private:
+        ContentStore& _store;
+        ContentStore::ReaderSlot* _slot;
+
+    public:
+        ContentReader(ContentStore& store);
+        ~ContentReader();
+        ContentReader(const ContentReader&) = delete;
+        ContentReader& operator=(const ContentReader&) = delete;
+
+        const GameData& pin();
+        void unpin();
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "ContentWatcher.h"
+#include <chrono>
+#include <cstdint>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "Game.h"
+
+using namespace std;
+
+// wait this long after the last change before reloading (editors often write a file in several steps)
+static const int QUIET_MS = 100;
+// how often retired versions are checked again while nothing changes
+static const int RECLAIM_MS = 1000;
+
+ContentWatcher::ContentWatcher(ContentStore& store, ostream& log) : _store(store), _log(log) {
+    _inotify_fd = -1;
+    _wake_fd = -1;
+}
+
+ContentWatcher::~ContentWatcher() {
+    stop();
+}
+
+bool ContentWatcher::isContentFile(const string& name) {
+    return name == "characters.txt" || name == "riddles.txt" || name == "random_events.txt" || name == "content.bin";
+}
+
+// inotify + eventfd for stop, watch for finished writes and files renamed into place, start the thread
+bool ContentWatcher::start() {
+    if (_thread.joinable()) {
+        return true;
+    }
+
+    _inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify_fd < 0) {
+        return false;
+    }
+    if (inotify_add_watch(_inotify_fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(_inotify_fd);
+        _inotify_fd = -1;
+        return false;
+    }
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    _thread = thread(&ContentWatcher::run, this);
+    return true;
+}
+
+void ContentWatcher::stop() {
+    if (_thread.joinable()) {
+        uint64_t one = 1;
+        write(_wake_fd, &one, sizeof(one));
+        _thread.join();
+    }
+    if (_inotify_fd >= 0) {
+        close(_inotify_fd);
+        _inotify_fd = -1;
+    }
+    if (_wake_fd >= 0) {
+        close(_wake_fd);
+        _wake_fd = -1;
+    }
+}
+
+// events are variable length (header + name), walk the buffer until read runs dry
+bool ContentWatcher::drainEvents() {
+    bool changed = false;
+    alignas(struct inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t n = read(_inotify_fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            return changed;
+        }
+        for (char* p = buffer; p < buffer + n; ) {
+            struct inotify_event* event = (struct inotify_event*)p;
+            if (event->len > 0 && isContentFile(event->name)) {
+                changed = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+// load a fresh version off to the side, then swap it in (games keep their pinned version until their turn ends)
+void ContentWatcher::reload() {
+    GameData* next = new GameData();
+    loadGameData(*next, _log);
+    _store.publish(next);
+    _log << "Content reloaded (version " << _store.getVersion() << ", " << next->getCharacterCount() << " characters, "
+         << next->getRiddleCount() << " riddles, " << next->getEventCount() << " random events)" << endl;
+}
+
+// wait for changes, let them settle, reload; reclaim old versions on every wakeup
+void ContentWatcher::run() {
+    struct pollfd fds[2];
+    fds[0].fd = _inotify_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = _wake_fd;
+    fds[1].events = POLLIN;
+
+    bool pending = false;
+    chrono::steady_clock::time_point reloadAt;
+    while (true) {
+        int timeout = RECLAIM_MS;
+        if (pending) {
+            long long wait = chrono::duration_cast<chrono::milliseconds>(reloadAt - chrono::steady_clock::now()).count();
+            timeout = wait > 0 ? (int)wait : 0;
+        }
+
+        int ready = poll(fds, 2, timeout);
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            return;
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN) && drainEvents()) {
+            pending = true;
+            reloadAt = chrono::steady_clock::now() + chrono::milliseconds(QUIET_MS);
+        }
+        if (pending && chrono::steady_clock::now() >= reloadAt) {
+            pending = false;
+            reload();
+        }
+        _store.reclaim();
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef CONTENTWATCHER_H
+#define CONTENTWATCHER_H
+
+#include <ostream>
+#include <string>
+#include <thread>
+#include "ContentStore.h"
+
+using namespace std;
+
+// ContentWatcher: background thread that reloads game content when its files change
+// inotify on the working directory reports writes and renames of characters.txt, riddles.txt,
+// random_events.txt and content.bin; after a short quiet period the content is loaded again
+// (same rules as at startup) and published to the store. Retired versions are reclaimed every second.
+class ContentWatcher {
+    private:
+        ContentStore& _store;
+        ostream& _log;
+        int _inotify_fd;
+        int _wake_fd;
+        thread _thread;
+
+        // true if name is one of the content files
+        static bool isContentFile(const string& name);
+        // read pending inotify events, true if any of them touched a content file
+        bool drainEvents();
+        void reload();
+        void run();
+
+    public:
+        ContentWatcher(ContentStore& store, ostream& log);
+        ~ContentWatcher();
+        ContentWatcher(const ContentWatcher&) = delete;
+        ContentWatcher& operator=(const ContentWatcher&) = delete;
+
+        // start watching the working directory, returns false if inotify isn't available
+        bool start();
+        // stop the thread and close the watch
+        void stop();
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef FIXEDBOARD_H
+#define FIXEDBOARD_H
+
+#include <array>
+#include <cstring>
+#include <utility>
+#include "Board.h"
+
+using namespace std;
+
+// call f(integral_constant<int, I>()) for I = 0 .. N-1, written out at compile time (no loop left to unroll)
+template <typename F, int... I>
+inline void unrolledFor(F&& f, integer_sequence<int, I...>) {
+    (f(integral_constant<int, I>()), ...);
+}
+
+template <int N, typename F>
+inline void unrolledFor(F&& f) {
+    unrolledFor(f, make_integer_sequence<int, N>());
+}
+
+// TileDispatch: compile-time table from tile code to Handler::onTile<Code>(lane)
+// Each entry is its own instantiation, so a handler's per-color code is chosen at compile time and the only
+// runtime step is one indexed call; a code without a task compiles to whatever the handler does for it.
+template <typename Handler>
+struct TileDispatch {
+    typedef void (*Entry)(Handler& handler, int lane);
+
+    template <int Code>
+    static void call(Handler& handler, int lane) {
+        handler.template onTile<Code>(lane);
+    }
+
+    template <int... Codes>
+    static constexpr array<Entry, TILE_CODE_COUNT> build(integer_sequence<int, Codes...>) {
+        return {{&call<Codes>...}};
+    }
+
+    static constexpr array<Entry, TILE_CODE_COUNT> TABLE = build(make_integer_sequence<int, TILE_CODE_COUNT>());
+};
+
+// FixedBoard: a board whose lane count and length are template parameters, for simulation builds
+// The lanes use Board's packed layout (two 4-bit tile codes per byte, lane after lane) in a fixed array, so every
+// index is a constant expression and every scan over lanes is written out in full: no bounds checks, no
+// per-player loop, and the finish clamp is a select rather than a branch. Board stays the runtime-sized board
+// the game plays on; a FixedBoard takes its lanes from one with assign().
+template <int Lanes, int Length>
+class FixedBoard {
+    static_assert(Lanes >= 1 && Length >= 2, "a board needs at least one lane of two tiles");
+
+    public:
+        static constexpr int LANE_COUNT = Lanes;
+        static constexpr int LANE_LENGTH = Length;
+        static constexpr int FINISH = Length - 1;
+        static constexpr int LANE_STRIDE = (Length + 1) / 2;
+
+    private:
+        alignas(64) unsigned char _tiles[Lanes * LANE_STRIDE];
+        int _positions[Lanes];
+
+    public:
+        // every tile a start tile, every player at position 0
+        FixedBoard() {
+            memset(_tiles, 0, sizeof(_tiles));
+            memset(_positions, 0, sizeof(_positions));
+        }
+
+        // copy the lanes and positions of a runtime board, false (nothing copied) if its dimensions differ
+        bool assign(const Board& board) {
+            if (board.getLaneCount() != Lanes || board.getLaneLength() != Length) {
+                return false;
+            }
+            memcpy(_tiles, board.getLaneData(), sizeof(_tiles));
+            unrolledFor<Lanes>([&](auto lane) {
+                _positions[lane] = board.getPlayerPosition(lane);
+            });
+            return true;
+        }
+
+        // unchecked: lane < Lanes, position < Length
+        int getTileCode(int lane, int position) const {
+            unsigned char packed = _tiles[lane * LANE_STRIDE + (position >> 1)];
+            return (packed >> ((position & 1) << 2)) & 0x0F;
+        }
+
+        char getTileColor(int lane, int position) const {
+            return TILE_COLOR_CHARS[getTileCode(lane, position)];
+        }
+
+        int getPlayerPosition(int lane) const {
+            return _positions[lane];
+        }
+
+        // clamped to the lane like Board::setPlayerPosition
+        void setPlayerPosition(int lane, int position) {
+            _positions[lane] = position < 0 ? 0 : (position > FINISH ? FINISH : position);
+        }
+
+        void resetPositions() {
+            memset(_positions, 0, sizeof(_positions));
+        }
+
+        // move every player by steps[i] tiles (clamped at the finish), returns how many are on the finish
+        int advancePlayers(const int* steps) {
+            int finished = 0;
+            unrolledFor<Lanes>([&](auto lane) {
+                int moved = _positions[lane] + steps[lane];
+                _positions[lane] = moved < FINISH ? moved : FINISH;
+                finished += _positions[lane] == FINISH;
+            });
+            return finished;
+        }
+
+        // tile code under every player
+        void getLandedCodes(int* codes) const {
+            unrolledFor<Lanes>([&](auto lane) {
+                codes[lane] = getTileCode(lane, _positions[lane]);
+            });
+        }
+
+        // task points of the tile under every player added to points (no branch on the tile's color)
+        void addLandedTaskPoints(long long* points) const {
+            unrolledFor<Lanes>([&](auto lane) {
+                points[lane] += TILE_TASK_POINTS[getTileCode(lane, _positions[lane])];
+            });
+        }
+
+        // handler.onTile<Code>(lane) for the tile under every player, through TileDispatch's table
+        template <typename Handler>
+        void dispatchLanded(Handler& handler) const {
+            unrolledFor<Lanes>([&](auto lane) {
+                TileDispatch<Handler>::TABLE[getTileCode(lane, _positions[lane])](handler, lane);
+            });
+        }
+};
+
+#endif
@@ -0,0 +1,1214 @@
+#include "Game.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include "BotPlanner.h"
+#include "ContentParser.h"
+#include "RiddleBank.h"
+#include "Snapshot.h"
+#include "Trace.h"
+
+using namespace std;
+
+// map file, skip header, split each line on pipes, parse numbers with from_chars, create player objects, add to vector
+bool loadCharacters(const string& filename, ContentSource& source, ostream& errors) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    PipeRecordReader reader(file.data(), file.size());
+    string_view line;
+    vector<string_view> fields;
+    reader.nextLine(line);
+
+    while (reader.nextLine(line)) {
+        if (line.empty()) continue;
+
+        PipeRecordReader::splitFields(line, fields);
+        if (fields.size() != 6) {
+            reportParseError(errors, filename, reader.getLineNumber(), "expected 6 fields, found " + to_string(fields.size()));
+            continue;
+        }
+
+        int stats[5];
+        bool valid = true;
+        for (int i = 0; i < 5 && valid; i++) {
+            if (!parseInt(fields[i + 1], stats[i])) {
+                reportParseError(errors, filename, reader.getLineNumber(), "invalid number '" + string(fields[i + 1]) + "'");
+                valid = false;
+            }
+        }
+        if (!valid) continue;
+
+        source.characters.push_back(Player(string(fields[0]), stats[0], stats[1], stats[2], stats[3], stats[4]));
+    }
+
+    return true;
+}
+
+// map file, skip header, split each line at the first pipe into question and answer, keep both in the arena,
+// then drop repeated questions and warn about near repeats (same answer, almost the same question)
+bool loadRiddles(const string& filename, ContentSource& source, ostream& errors) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    PipeRecordReader reader(file.data(), file.size());
+    string_view line;
+    vector<string_view> fields;
+    vector<Riddle> loaded;
+    vector<int> lineNumbers;
+    reader.nextLine(line);
+
+    while (reader.nextLine(line)) {
+        if (line.empty()) continue;
+
+        PipeRecordReader::splitFields(line, fields, 2);
+        if (fields.size() != 2) {
+            reportParseError(errors, filename, reader.getLineNumber(), "missing '|' between question and answer");
+            continue;
+        }
+
+        Riddle r;
+        r.question = source.text.intern(fields[0]);
+        r.answer = source.text.intern(fields[1]);
+        loaded.push_back(r);
+        lineNumbers.push_back(reader.getLineNumber());
+    }
+
+    vector<RiddleDuplicate> duplicates;
+    findDuplicateRiddles(loaded, duplicates);
+    vector<bool> skipped(loaded.size(), false);
+    for (const RiddleDuplicate& d : duplicates) {
+        if (d.exact) {
+            reportParseError(errors, filename, lineNumbers[d.riddle], "same question as line " + to_string(lineNumbers[d.original]) + ", skipped");
+            skipped[d.riddle] = true;
+        } else {
+            errors << "Warning: " << filename << ":" << lineNumbers[d.riddle] << ": nearly the same riddle as line "
+                   << lineNumbers[d.original] << endl;
+        }
+    }
+    for (size_t i = 0; i < loaded.size(); i++) {
+        if (!skipped[i]) {
+            source.riddles.push_back(loaded[i]);
+        }
+    }
+
+    return true;
+}
+
+// map file, skip header and comment lines, split each line on pipes, parse numbers with from_chars, add to vector
+bool loadRandomEvents(const string& filename, ContentSource& source, ostream& errors) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    PipeRecordReader reader(file.data(), file.size());
+    string_view line;
+    vector<string_view> fields;
+    reader.nextLine(line);
+    reader.nextLine(line);
+
+    while (reader.nextLine(line)) {
+        if (line.empty() || line[0] == '/') continue;
+
+        PipeRecordReader::splitFields(line, fields);
+        if (fields.size() != 4) {
+            reportParseError(errors, filename, reader.getLineNumber(), "expected 4 fields, found " + to_string(fields.size()));
+            continue;
+        }
+
+        RandomEvent e;
+        if (!parseInt(fields[1], e.pathType) || !parseInt(fields[2], e.advisor) || !parseInt(fields[3], e.discoveryPoints)) {
+            reportParseError(errors, filename, reader.getLineNumber(), "invalid number in '" + string(line) + "'");
+            continue;
+        }
+        e.description = source.text.intern(fields[0]);
+        source.randomEvents.push_back(e);
+    }
+
+    return true;
+}
+
+// load characters riddles and events, warn about missing files, use default characters if none
+void loadContentText(ContentSource& source, ostream& out) {
+    if (!loadCharacters("characters.txt", source, out) || source.characters.empty()) {
+        out << "Warning: Could not load characters.txt. Using default characters." << endl;
+        source.characters.push_back(Player("Dr.Leo", 5, 500, 500, 1000, 20000));
+        source.characters.push_back(Player("Dr.Helix", 8, 900, 600, 600, 20000));
+    }
+    if (!loadRiddles("riddles.txt", source, out)) {
+        out << "Warning: Could not load riddles.txt." << endl;
+    }
+    if (!loadRandomEvents("random_events.txt", source, out)) {
+        out << "Warning: Could not load random_events.txt." << endl;
+    }
+}
+
+// map file, skip header, parse the one line of six numbers
+bool loadTileMix(const string& filename, TileMix& mix, ostream& errors) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    PipeRecordReader reader(file.data(), file.size());
+    string_view line;
+    vector<string_view> fields;
+    reader.nextLine(line);
+
+    while (reader.nextLine(line)) {
+        if (line.empty()) continue;
+
+        PipeRecordReader::splitFields(line, fields);
+        if (fields.size() != 1 + TILE_MIX_COLORS) {
+            reportParseError(errors, filename, reader.getLineNumber(), "expected 6 fields, found " + to_string(fields.size()));
+            return false;
+        }
+
+        int values[1 + TILE_MIX_COLORS];
+        for (int i = 0; i < 1 + TILE_MIX_COLORS; i++) {
+            if (!parseInt(fields[i], values[i])) {
+                reportParseError(errors, filename, reader.getLineNumber(), "invalid number '" + string(fields[i]) + "'");
+                return false;
+            }
+        }
+        mix.greenPer52 = values[0];
+        for (int i = 0; i < TILE_MIX_COLORS; i++) {
+            mix.weights[i] = values[i + 1];
+        }
+        return true;
+    }
+
+    reportParseError(errors, filename, reader.getLineNumber(), "no tile mix found");
+    return false;
+}
+
+// header line then the mix, same layout loadTileMix reads
+bool saveTileMix(const string& filename, const TileMix& mix) {
+    ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+    file << "greenPer52|blue|pink|brown|red|purple" << endl;
+    file << mix.greenPer52;
+    for (int i = 0; i < TILE_MIX_COLORS; i++) {
+        file << "|" << mix.weights[i];
+    }
+    file << endl;
+    return (bool)file;
+}
+
+// parse the text files, compile them, write the bundle
+bool buildContentBundle(ostream& out) {
+    ContentSource source;
+    loadContentText(source, out);
+
+    vector<char> bundle;
+    compileContent(source, bundle);
+    if (!saveContentBundle(bundle, "content.bin")) {
+        out << "Error: Could not write content.bin." << endl;
+        return false;
+    }
+    out << "Wrote content.bin (" << source.characters.size() << " characters, " << source.riddles.size()
+        << " riddles, " << source.randomEvents.size() << " random events, " << bundle.size() << " bytes)" << endl;
+    return true;
+}
+
+// true if filename exists and was modified after the bundle (a missing text file doesn't count)
+static bool isNewerThan(const string& filename, const struct stat& bundleInfo) {
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) {
+        return false;
+    }
+    if (info.st_mtim.tv_sec != bundleInfo.st_mtim.tv_sec) {
+        return info.st_mtim.tv_sec > bundleInfo.st_mtim.tv_sec;
+    }
+    return info.st_mtim.tv_nsec > bundleInfo.st_mtim.tv_nsec;
+}
+
+// use content.bin when it is up to date, otherwise parse the text files and compile them in memory
+void loadGameData(GameData& gameData, ostream& out) {
+    out << "Loading game data..." << endl;
+
+    struct stat bundleInfo;
+    if (stat("content.bin", &bundleInfo) == 0) {
+        if (isNewerThan("characters.txt", bundleInfo) || isNewerThan("riddles.txt", bundleInfo) ||
+            isNewerThan("random_events.txt", bundleInfo)) {
+            out << "Warning: content.bin is older than the text files. Run ./game --compile-content to update it." << endl;
+        } else if (gameData.openBundle("content.bin")) {
+            return;
+        } else {
+            out << "Warning: content.bin is not a valid content bundle. Using the text files." << endl;
+        }
+    }
+
+    ContentSource source;
+    loadContentText(source, out);
+    vector<char> bundle;
+    compileContent(source, bundle);
+    gameData.adoptBundle(bundle);
+}
+
+// register every game metric once, grouped by name so each name gets one HELP/TYPE header
+static GameMetrics registerGameMetrics() {
+    static const char* const colorNames[TILE_CODE_COUNT] = {"start", "green", "blue", "pink", "brown", "red", "purple", "finish"};
+    static const int taskTiles[] = {TILE_BLUE, TILE_PINK, TILE_BROWN, TILE_RED};
+    MetricsRegistry& registry = getMetricsRegistry();
+    GameMetrics metrics;
+
+    for (int code = 0; code < TILE_CODE_COUNT; code++) {
+        metrics.landings[code] = &registry.addCounter("genome_tile_landings_total", "Tiles landed on, by color",
+                                                      string("color=\"") + colorNames[code] + "\"");
+        metrics.tasksPassed[code] = nullptr;
+        metrics.tasksFailed[code] = nullptr;
+    }
+    for (int code : taskTiles) {
+        string color = string("color=\"") + colorNames[code] + "\"";
+        metrics.tasksPassed[code] = &registry.addCounter("genome_tasks_total", "DNA tasks answered, by tile color and result",
+                                                         color + ",result=\"passed\"");
+        metrics.tasksFailed[code] = &registry.addCounter("genome_tasks_total", "DNA tasks answered, by tile color and result",
+                                                         color + ",result=\"failed\"");
+    }
+    metrics.randomEvents = &registry.addCounter("genome_random_events_total", "Random events triggered");
+    metrics.advisorProtections = &registry.addCounter("genome_advisor_protections_total", "Negative random events blocked by an advisor");
+    metrics.pointsGained = &registry.addHistogram("genome_discovery_points_gained", "Discovery Points gained on one tile (task and random event)");
+    metrics.pointsLost = &registry.addHistogram("genome_discovery_points_lost", "Discovery Points lost on one tile (task and random event)");
+    metrics.strandSimilarityNs = &registry.addHistogram("genome_kernel_latency_nanoseconds", "DNA kernel run time", "kernel=\"strandSimilarity\"");
+    metrics.bestStrandMatchNs = &registry.addHistogram("genome_kernel_latency_nanoseconds", "DNA kernel run time", "kernel=\"bestStrandMatch\"");
+    metrics.identifyMutationsNs = &registry.addHistogram("genome_kernel_latency_nanoseconds", "DNA kernel run time", "kernel=\"identifyMutations\"");
+    metrics.transcribeNs = &registry.addHistogram("genome_kernel_latency_nanoseconds", "DNA kernel run time", "kernel=\"transcribeDNAtoRNA\"");
+    return metrics;
+}
+
+const GameMetrics& getGameMetrics() {
+    static const GameMetrics metrics = registerGameMetrics();
+    return metrics;
+}
+
+// if strands different length or empty return 0, else count matches at each position, return matches divided by total
+double strandSimilarity(string_view strand1, string_view strand2) {
+    LatencyTimer timer(*getGameMetrics().strandSimilarityNs);
+    if (strand1.length() != strand2.length() || strand1.length() == 0) {
+        return 0.0;
+    }
+    
+    int matches = 0;
+    int total = strand1.length();
+    
+    for (int i = 0; i < total; i++) {
+        if (strand1[i] == strand2[i]) {
+            matches++;
+        }
+    }
+    
+    return (double)matches / (double)total;
+}
+
+// if either empty return -1, if input shorter compare from start return 0, if input longer slide target along input, find best match position, return index
+int bestStrandMatch(string_view input_strand, string_view target_strand) {
+    LatencyTimer timer(*getGameMetrics().bestStrandMatchNs);
+    if (input_strand.length() == 0 || target_strand.length() == 0) {
+        return -1;
+    }
+    
+    double bestScore = 0.0;
+    int bestIndex = 0;
+    
+    if (input_strand.length() <= target_strand.length()) {
+        int matches = 0;
+        int compareLen = input_strand.length();
+        if (target_strand.length() < compareLen) {
+            compareLen = target_strand.length();
+        }
+        for (int j = 0; j < compareLen; j++) {
+            if (input_strand[j] == target_strand[j]) {
+                matches++;
+            }
+        }
+        return 0;
+    }
+    
+    for (int i = 0; i <= (int)(input_strand.length() - target_strand.length()); i++) {
+        int matches = 0;
+        for (int j = 0; j < (int)target_strand.length(); j++) {
+            if (input_strand[i + j] == target_strand[j]) {
+                matches++;
+            }
+        }
+        double score = (double)matches / (double)target_strand.length();
+        if (score > bestScore) {
+            bestScore = score;
+            bestIndex = i;
+        }
+    }
+    
+    return bestIndex;
+}
+
+// find best alignment, determine shorter and longer strand, compare character by character, detect substitutions insertions deletions, print each mutation, handle remaining chars
+void identifyMutations(string_view input_strand, string_view target_strand, ostream& out) {
+    LatencyTimer timer(*getGameMetrics().identifyMutationsNs);
+    int bestIndex = bestStrandMatch(input_strand, target_strand);
+    
+    string_view shorter = input_strand;
+    string_view longer = target_strand;
+    bool inputIsShorter = true;
+    
+    if (input_strand.length() > target_strand.length()) {
+        shorter = target_strand;
+        longer = input_strand;
+        inputIsShorter = false;
+    }
+    
+    int inputPos = 0;
+    int targetPos = bestIndex;
+    
+    while (inputPos < (int)shorter.length() && targetPos < (int)longer.length()) {
+        if (shorter[inputPos] == longer[targetPos]) {
+            inputPos++;
+            targetPos++;
+        } else {
+            if (inputPos + 1 < (int)shorter.length() && targetPos + 1 < (int)longer.length() &&
+                shorter[inputPos + 1] == longer[targetPos + 1]) {
+                out << "Substitution at position " << inputPos << ": " 
+                     << shorter[inputPos] << " -> " << longer[targetPos] << endl;
+                inputPos++;
+                targetPos++;
+            }
+            else if (inputPos < (int)shorter.length() && targetPos + 1 < (int)longer.length() &&
+                     shorter[inputPos] == longer[targetPos + 1]) {
+                out << "Insertion at position " << targetPos << ": " 
+                     << longer[targetPos] << " inserted" << endl;
+                targetPos++;
+            }
+            else if (inputPos + 1 < (int)shorter.length() && targetPos < (int)longer.length() &&
+                     shorter[inputPos + 1] == longer[targetPos]) {
+                out << "Deletion at position " << inputPos << ": " 
+                     << shorter[inputPos] << " deleted" << endl;
+                inputPos++;
+            } else {
+                out << "Substitution at position " << inputPos << ": " 
+                     << shorter[inputPos] << " -> " << longer[targetPos] << endl;
+                inputPos++;
+                targetPos++;
+            }
+        }
+    }
+    
+    while (targetPos < (int)longer.length()) {
+        out << "Insertion at position " << targetPos << ": " 
+             << longer[targetPos] << " inserted" << endl;
+        targetPos++;
+    }
+    while (inputPos < (int)shorter.length()) {
+        out << "Deletion at position " << inputPos << ": " 
+             << shorter[inputPos] << " deleted" << endl;
+        inputPos++;
+    }
+}
+
+// print the dna, then loop through strand printing U for every T and the char itself otherwise (no rna copy)
+void transcribeDNAtoRNA(string_view strand, ostream& out) {
+    LatencyTimer timer(*getGameMetrics().transcribeNs);
+    out << "DNA: " << strand << endl;
+    out << "RNA: ";
+    for (int i = 0; i < (int)strand.length(); i++) {
+        if (strand[i] == 'T') {
+            out.put('U');
+        } else {
+            out.put(strand[i]);
+        }
+    }
+    out << endl;
+}
+
+static char lowercaseChar(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        c = c - 'A' + 'a';
+    }
+    return c;
+}
+
+string toLowercase(string_view str) {
+    string result(str);
+    for (int i = 0; i < (int)result.length(); i++) {
+        result[i] = lowercaseChar(result[i]);
+    }
+    return result;
+}
+
+bool equalsIgnoreCase(string_view a, string_view b) {
+    if (a.length() != b.length()) {
+        return false;
+    }
+    for (int i = 0; i < (int)a.length(); i++) {
+        if (lowercaseChar(a[i]) != lowercaseChar(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// read one line, throw InputClosed if the stream has ended
+void readLine(istream& in, string& line) {
+    TRACE_SPAN("readLine");
+    if (!getline(in, line)) {
+        throw InputClosed();
+    }
+}
+
+// read one line and convert it to a number, anything that isn't a number becomes 0 (an invalid choice)
+int readNumber(istream& in) {
+    string line;
+    readLine(in, line);
+    return atoi(line.c_str());
+}
+
+// if no riddles return true, pick random riddle, ask question, get answer, compare with the normalized answer
+// (a typo or two is forgiven in longer answers), award or deduct points; no tile handler asks riddles yet
+bool askRiddle(Player& player, const GameData& gameData, Random& random, TurnBuffers& buffers, istream& in, ostream& out) {
+    if (gameData.getRiddleCount() == 0) {
+        return true;
+    }
+    
+    int riddleIndex = random.nextInt(gameData.getRiddleCount());
+    const Riddle r = gameData.getRiddle(riddleIndex);
+    
+    out << "\n=== RIDDLE ===" << endl;
+    out << r.question << endl;
+    out << "Your answer: ";
+    
+    readLine(in, buffers.answer);
+    
+    AnswerMatch match = matchAnswer(r.normalizedAnswer, buffers.answer, buffers.normalizedAnswer);
+    if (match != ANSWER_WRONG) {
+        if (match == ANSWER_CLOSE) {
+            out << "Close enough! The answer was: " << r.answer << endl;
+        }
+        out << "Correct! You gain 100 Discovery Points!" << endl;
+        player.updateDiscoverPoints(100);
+        player.enforceMinimumStats();
+        return true;
+    } else {
+        out << "Incorrect! The answer was: " << r.answer << endl;
+        out << "You lose 50 Discovery Points." << endl;
+        player.updateDiscoverPoints(-50);
+        player.enforceMinimumStats();
+        return false;
+    }
+}
+
+// look up the events this tile color allows (prebuilt in the content bundle), pick one at random, check if advisor protects, apply discovery points change
+void triggerRandomEvent(Player& player, char tileColor, const GameData& gameData, Random& random, ostream& out) {
+    TRACE_SPAN("triggerRandomEvent");
+    int eventCount = gameData.getTileEventCount(tileColor);
+    if (eventCount == 0) {
+        return;
+    }
+    
+    int eventIndex = random.nextInt(eventCount);
+    RandomEvent e = gameData.getTileEvent(tileColor, eventIndex);
+    getGameMetrics().randomEvents->add();
+    
+    out << "\n=== RANDOM EVENT ===" << endl;
+    out << e.description << endl;
+    
+    bool protectedByAdvisor = false;
+    if (e.advisor > 0 && e.discoveryPoints < 0 && player.getAdvisor() == e.advisor) {
+        protectedByAdvisor = true;
+    }
+    
+    if (protectedByAdvisor && e.discoveryPoints < 0) {
+        getGameMetrics().advisorProtections->add();
+        out << "Your advisor protects you! No Discovery Points lost." << endl;
+    } else {
+        player.updateDiscoverPoints(e.discoveryPoints);
+        if (e.discoveryPoints > 0) {
+            out << "You gain " << e.discoveryPoints << " Discovery Points!" << endl;
+        } else {
+            out << "You lose " << -e.discoveryPoints << " Discovery Points." << endl;
+        }
+        player.enforceMinimumStats();
+    }
+}
+
+// get two dna strands from user, check equal length, calculate similarity, award points based on score
+bool handleBlueTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out) {
+    out << "\n=== DNA Task 1: Similarity (Equal-Length) ===" << endl;
+    out << "Compare two DNA strands of equal length." << endl;
+    
+    string& strand1 = buffers.strand1;
+    string& strand2 = buffers.strand2;
+    out << "Enter first DNA strand (A, C, G, T only): ";
+    readLine(in, strand1);
+    out << "Enter second DNA strand (same length): ";
+    readLine(in, strand2);
+    TRACE_SPAN("handleBlueTileTask");
+    TRACE_ARG(strand1.length() + strand2.length());
+    
+    if (strand1.length() != strand2.length()) {
+        out << "Error: Strands must be equal length!" << endl;
+        return false;
+    }
+    
+    double similarity = strandSimilarity(strand1, strand2);
+    out << "Similarity score: " << similarity << endl;
+    
+    if (similarity >= 0.7) {
+        out << "Excellent match! You gain 200 Discovery Points!" << endl;
+        player.updateDiscoverPoints(200);
+        player.enforceMinimumStats();
+        return true;
+    } else if (similarity >= 0.5) {
+        out << "Good match! You gain 100 Discovery Points!" << endl;
+        player.updateDiscoverPoints(100);
+        player.enforceMinimumStats();
+        return true;
+    } else {
+        out << "Poor match. You lose 50 Discovery Points." << endl;
+        player.updateDiscoverPoints(-50);
+        player.enforceMinimumStats();
+        return false;
+    }
+}
+
+// best match position and the similarity of the shorter strand there, from the result cache when one is set; false if either strand is empty
+static bool bestMatchSimilarity(string_view input_strand, string_view target_strand, CachedResult& cached,
+                                int& bestIndex, double& similarity) {
+    ResultCache* cache = getResultCache();
+    Hash128 key;
+    if (cache != nullptr) {
+        key = hashTask(CACHED_BEST_MATCH, input_strand, target_strand);
+        if (cache->lookup(key, cached)) {
+            bestIndex = cached.index;
+            similarity = cached.value;
+            return bestIndex >= 0;
+        }
+    }
+    
+    bestIndex = bestStrandMatch(input_strand, target_strand);
+    similarity = 0.0;
+    if (bestIndex >= 0) {
+        string_view shorter = input_strand;
+        string_view longer = target_strand;
+        if (input_strand.length() > target_strand.length()) {
+            shorter = target_strand;
+            longer = input_strand;
+        }
+        
+        int matches = 0;
+        for (int i = 0; i < (int)shorter.length() && (bestIndex + i) < (int)longer.length(); i++) {
+            if (shorter[i] == longer[bestIndex + i]) {
+                matches++;
+            }
+        }
+        similarity = (double)matches / (double)shorter.length();
+    }
+    
+    if (cache != nullptr) {
+        cached.index = bestIndex;
+        cached.value = similarity;
+        cached.text.clear();
+        cache->store(key, cached);
+    }
+    return bestIndex >= 0;
+}
+
+// get two dna strands from user, find best match position, calculate similarity at that position, award points based on score
+bool handlePinkTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out) {
+    out << "\n=== DNA Task 2: Similarity (Unequal-Length) ===" << endl;
+    out << "Find the best alignment between two DNA strands." << endl;
+    
+    string& input_strand = buffers.strand1;
+    string& target_strand = buffers.strand2;
+    out << "Enter input DNA strand: ";
+    readLine(in, input_strand);
+    out << "Enter target DNA strand: ";
+    readLine(in, target_strand);
+    TRACE_SPAN("handlePinkTileTask");
+    TRACE_ARG(input_strand.length() + target_strand.length());
+    
+    int bestIndex;
+    double similarity;
+    if (!bestMatchSimilarity(input_strand, target_strand, buffers.cached, bestIndex, similarity)) {
+        out << "Error: Invalid strands!" << endl;
+        return false;
+    }
+    
+    out << "Best match found at index: " << bestIndex << endl;
+    out << "Similarity at best position: " << similarity << endl;
+    
+    if (similarity >= 0.7) {
+        out << "Excellent alignment! You gain 200 Discovery Points!" << endl;
+        player.updateDiscoverPoints(200);
+        player.enforceMinimumStats();
+        return true;
+    } else if (similarity >= 0.5) {
+        out << "Good alignment! You gain 100 Discovery Points!" << endl;
+        player.updateDiscoverPoints(100);
+        player.enforceMinimumStats();
+        return true;
+    } else {
+        out << "Poor alignment. You lose 50 Discovery Points." << endl;
+        player.updateDiscoverPoints(-50);
+        player.enforceMinimumStats();
+        return false;
+    }
+}
+
+// get two dna strands from user, call identify mutations, award points
+bool handleRedTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out) {
+    out << "\n=== DNA Task 3: Mutation Identification ===" << endl;
+    out << "Identify mutations between two DNA sequences." << endl;
+    
+    string& input_strand = buffers.strand1;
+    string& target_strand = buffers.strand2;
+    out << "Enter input DNA strand: ";
+    readLine(in, input_strand);
+    out << "Enter target DNA strand: ";
+    readLine(in, target_strand);
+    TRACE_SPAN("handleRedTileTask");
+    TRACE_ARG(input_strand.length() + target_strand.length());
+    
+    out << "\nMutations identified:" << endl;
+    ResultCache* cache = getResultCache();
+    if (cache == nullptr) {
+        identifyMutations(input_strand, target_strand, out);
+    } else {
+        // the listing is cached as text; a miss renders it once into a string
+        Hash128 key = hashTask(CACHED_MUTATIONS, input_strand, target_strand);
+        CachedResult& cached = buffers.cached;
+        if (!cache->lookup(key, cached)) {
+            ostringstream listing;
+            identifyMutations(input_strand, target_strand, listing);
+            cached.index = 0;
+            cached.value = 0.0;
+            cached.text = listing.str();
+            cache->store(key, cached);
+        }
+        out << cached.text;
+    }
+    
+    out << "\nChallenge completed! You gain 200 Discovery Points!" << endl;
+    player.updateDiscoverPoints(200);
+    player.enforceMinimumStats();
+    return true;
+}
+
+// get dna strand from user, transcribe to rna, award points
+void handleBrownTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out) {
+    out << "\n=== DNA Task 4: Transcribe DNA to RNA ===" << endl;
+    out << "Convert a DNA sequence to RNA." << endl;
+    
+    string& strand = buffers.strand1;
+    out << "Enter DNA strand: ";
+    readLine(in, strand);
+    TRACE_SPAN("handleBrownTileTask");
+    TRACE_ARG(strand.length());
+    
+    transcribeDNAtoRNA(strand, out);
+    
+    out << "\nTranscription completed! You gain 150 Discovery Points!" << endl;
+    player.updateDiscoverPoints(150);
+    player.enforceMinimumStats();
+}
+
+// get tile code at player position, switch on the code, call appropriate handler or do nothing, trigger random event
+// (events are keyed by the tile's color character), record the landing in the metrics
+void handleTileEvent(Board& board, Player& player, int playerIndex, const GameData& gameData, Random& random, TurnBuffers& buffers, istream& in, ostream& out) {
+    TRACE_SPAN("handleTileEvent");
+    int pos = player.getPosition();
+    int tileCode = board.getTileCode(playerIndex, pos);
+    const GameMetrics& metrics = getGameMetrics();
+    int pointsBefore = player.getDiscoverPoints();
+    bool passed = true;
+    if (tileCode < TILE_CODE_COUNT) {
+        metrics.landings[tileCode]->add();
+    }
+    
+    out << "\n=== TILE EVENT ===" << endl;
+    
+    switch (tileCode) {
+        case TILE_GREEN:
+            out << "You landed on a regular tile. Nothing happens." << endl;
+            break;
+            
+        case TILE_BLUE:
+            out << "You landed on a Blue tile (Training Fellowship)!" << endl;
+            passed = handleBlueTileTask(player, buffers, in, out);
+            triggerRandomEvent(player, 'B', gameData, random, out);
+            break;
+            
+        case TILE_PINK:
+            out << "You landed on a Pink tile (Direct Lab Assignment)!" << endl;
+            passed = handlePinkTileTask(player, buffers, in, out);
+            triggerRandomEvent(player, 'P', gameData, random, out);
+            break;
+            
+        case TILE_RED:
+            out << "You landed on a Red tile (Challenge)!" << endl;
+            passed = handleRedTileTask(player, buffers, in, out);
+            if (passed) {
+                out << "Challenge completed successfully!" << endl;
+            }
+            triggerRandomEvent(player, 'R', gameData, random, out);
+            break;
+            
+        case TILE_BROWN:
+            out << "You landed on a Brown tile (Special Event)!" << endl;
+            handleBrownTileTask(player, buffers, in, out);
+            triggerRandomEvent(player, 'T', gameData, random, out);
+            break;
+            
+        case TILE_PURPLE: {
+            out << "You landed on a Purple tile (Bonus)!" << endl;
+            int bonus = tileTaskPoints(TILE_PURPLE) + random.nextInt(PURPLE_BONUS_SPREAD + 1);
+            out << "You gain " << bonus << " Discovery Points!" << endl;
+            player.updateDiscoverPoints(bonus);
+            player.enforceMinimumStats();
+            triggerRandomEvent(player, 'U', gameData, random, out);
+            break;
+        }
+            
+        case TILE_FINISH:
+            out << "Congratulations! You reached the finish line!" << endl;
+            break;
+            
+        default:
+            break;
+    }
+
+    if (tileCode < TILE_CODE_COUNT && metrics.tasksPassed[tileCode] != nullptr) {
+        (passed ? metrics.tasksPassed[tileCode] : metrics.tasksFailed[tileCode])->add();
+    }
+    int delta = player.getDiscoverPoints() - pointsBefore;
+    if (delta > 0) {
+        metrics.pointsGained->record(delta);
+    } else if (delta < 0) {
+        metrics.pointsLost->record(-delta);
+    }
+}
+
+// points handleTileEvent's task gives for a correct answer on each tile (purple: the fixed part of its bonus)
+int tileTaskPoints(int tileCode) {
+    return (tileCode >= 0 && tileCode < TILE_CODE_COUNT) ? TILE_TASK_POINTS[tileCode] : 0;
+}
+
+void displayCharacterMenu(const GameData& gameData, pmr::vector<bool>& chosen, ostream& out) {
+    out << "\n=== Available Characters ===" << endl;
+    for (int i = 0; i < gameData.getCharacterCount(); i++) {
+        if (!chosen[i]) {
+            const CharacterInfo c = gameData.getCharacterInfo(i);
+            out << (i + 1) << ". " << c.name
+                 << " - Exp: " << c.experience
+                 << ", Acc: " << c.accuracy
+                 << ", Eff: " << c.efficiency
+                 << ", Ins: " << c.insight
+                 << ", DP: " << c.discoverPoints << endl;
+        }
+    }
+}
+
+// show menu, get choice, validate choice, mark character as chosen, return selected player
+Player selectCharacter(int playerNum, const GameData& gameData, pmr::vector<bool>& chosen, istream& in, ostream& out) {
+    out << "\n=== Player " << playerNum << " Character Selection ===" << endl;
+    displayCharacterMenu(gameData, chosen, out);
+    
+    int choice;
+    out << "Enter the number of your chosen character: ";
+    choice = readNumber(in);
+    
+    while (choice < 1 || choice > gameData.getCharacterCount() || chosen[choice - 1]) {
+        out << "Invalid choice. Please select an available character: ";
+        choice = readNumber(in);
+    }
+    
+    chosen[choice - 1] = true;
+    Player selected = gameData.getCharacter(choice - 1);
+    out << "You selected: " << selected.getCharacterName() << endl;
+    return selected;
+}
+
+// show path options, get choice, apply stat changes based on choice, set path type
+void selectPathType(Player& player, istream& in, ostream& out) {
+    out << "\n=== Path Type Selection ===" << endl;
+    out << "Choose your path:" << endl;
+    out << "1. Training Fellowship" << endl;
+    out << "   - Cost: -5,000 Discovery Points" << endl;
+    out << "   - Bonus: +500 Accuracy, +500 Efficiency, +1,000 Insight" << endl;
+    out << "   - Includes advisor selection" << endl;
+    out << "2. Direct Lab Assignment" << endl;
+    out << "   - Bonus: +5,000 Discovery Points" << endl;
+    out << "   - Bonus: +200 Accuracy, +200 Efficiency, +200 Insight" << endl;
+    out << "   - No advisor" << endl;
+    out << "Enter your choice (1 or 2): ";
+    
+    int choice;
+    choice = readNumber(in);
+    
+    while (choice != 1 && choice != 2) {
+        out << "Invalid choice. Please enter 1 or 2: ";
+        choice = readNumber(in);
+    }
+    
+    if (choice == 1) {
+        applyPathType(player, 0);
+        out << "You chose Training Fellowship!" << endl;
+    } else {
+        applyPathType(player, 1);
+        out << "You chose Direct Lab Assignment!" << endl;
+    }
+}
+
+// set path type, apply its cost and trait bonuses
+void applyPathType(Player& player, int pathType) {
+    if (pathType == 0) {
+        player.setPathType(0);
+        player.updateDiscoverPoints(-5000);
+        player.updateAccuracy(500);
+        player.updateEfficiency(500);
+        player.updateInsight(1000);
+    } else {
+        player.setPathType(1);
+        player.updateDiscoverPoints(5000);
+        player.updateAccuracy(200);
+        player.updateEfficiency(200);
+        player.updateInsight(200);
+    }
+    player.enforceMinimumStats();
+}
+
+// if not training fellowship return, show advisor options, get choice, set advisor
+void selectAdvisor(Player& player, istream& in, ostream& out) {
+    if (player.getPathType() != 0) {
+        return;
+    }
+    
+    out << "\n=== Advisor Selection ===" << endl;
+    out << "Choose your advisor:" << endl;
+    out << "1. Dr. Aliquot - Master of the 'wet lab', assists in avoiding contamination" << endl;
+    out << "2. Dr. Assembler - Expert who helps improve efficiency and streamlines pipelines" << endl;
+    out << "3. Dr. Pop-Gen - Genetics specialist with insight for identifying rare genetic variants" << endl;
+    out << "4. Dr. Bio-Script - Genius behind data analysis, helps debug code" << endl;
+    out << "5. Dr. Loci - Your biggest supporter assisting you in learning the equipment" << endl;
+    out << "Enter your choice (1-5): ";
+    
+    int choice;
+    choice = readNumber(in);
+    
+    while (choice < 1 || choice > 5) {
+        out << "Invalid choice. Please enter 1-5: ";
+        choice = readNumber(in);
+    }
+    
+    player.setAdvisor(choice);
+    out << "You selected advisor " << choice << "!" << endl;
+}
+
+void displayMainMenu(Player& player, ostream& out) {
+    out << "\n=== Main Menu ===" << endl;
+    out << "1. Check Player Progress" << endl;
+    out << "2. Review Character" << endl;
+    out << "3. Check Position" << endl;
+    out << "4. Review Advisor" << endl;
+    out << "5. Move Forward" << endl;
+    out << "Enter your choice (1-5): ";
+}
+
+// get menu choice, handle each option with submenus where needed, return choice code
+int handleMenuChoice(Player& player, Board& board, int playerIndex, TurnBuffers& buffers, istream& in, ostream& out) {
+    string& choice = buffers.choice;
+    readLine(in, choice);
+    TRACE_SPAN("handleMenuChoice");
+    
+    if (choice == "1") {
+        out << "\n=== Player Progress ===" << endl;
+        out << "1. Review Discover Points" << endl;
+        out << "2. Review Trait Stats" << endl;
+        out << "Enter your choice (1 or 2): ";
+        string& subChoice = buffers.subChoice;
+        readLine(in, subChoice);
+        
+        if (subChoice == "1") {
+            out << "Discovery Points: " << player.getDiscoverPoints() << endl;
+        } else if (subChoice == "2") {
+            out << "Accuracy: " << player.getAccuracy() << endl;
+            out << "Efficiency: " << player.getEfficiency() << endl;
+            out << "Insight: " << player.getInsight() << endl;
+            out << "Experience: " << player.getExperience() << endl;
+        } else {
+            out << "Invalid choice." << endl;
+        }
+        return 1;
+    } else if (choice == "2") {
+        out << "\n=== Character Information ===" << endl;
+        out << "Character Name: " << player.getCharacterName() << endl;
+        out << "Experience: " << player.getExperience() << endl;
+        return 1;
+    } else if (choice == "3") {
+        out << "\n=== Current Position ===" << endl;
+        out << "Position: " << player.getPosition() << " / " << board.getFinishPosition() << endl;
+        out << "\n=== Board State ===" << endl;
+        board.displayBoard(out);
+        return 1;
+    } else if (choice == "4") {
+        if (player.getAdvisor() == 0) {
+            out << "\nYou do not have an advisor (Direct Lab Assignment path)." << endl;
+        } else {
+            out << "\n=== Advisor Information ===" << endl;
+            out << "Advisor Number: " << player.getAdvisor() << endl;
+            static const char* const advisorNames[] = {"", "Dr. Aliquot", "Dr. Assembler", "Dr. Pop-Gen", "Dr. Bio-Script", "Dr. Loci"};
+            static const char* const advisorAbilities[] = {"", 
+                "Master of the 'wet lab', assists in avoiding contamination",
+                "Expert who helps improve efficiency and streamlines pipelines",
+                "Genetics specialist with insight for identifying rare genetic variants",
+                "Genius behind data analysis, helps debug code",
+                "Your biggest supporter assisting you in learning the equipment"};
+            
+            out << "Advisor Name: " << advisorNames[player.getAdvisor()] << endl;
+            out << "1. Display advisor abilities" << endl;
+            out << "2. Use abilities for challenge" << endl;
+            out << "Enter your choice (1 or 2): ";
+            string& subChoice = buffers.subChoice;
+            readLine(in, subChoice);
+            
+            if (subChoice == "1") {
+                out << "Ability: " << advisorAbilities[player.getAdvisor()] << endl;
+            } else if (subChoice == "2") {
+                out << "Your advisor is ready to protect you from negative events!" << endl;
+            } else {
+                out << "Invalid choice." << endl;
+            }
+        }
+        return 1;
+    } else if (choice == "5") {
+        return 2;
+    } else {
+        out << "Invalid choice. Please enter 1-5." << endl;
+        return 0;
+    }
+}
+
+// start with base discovery points, add 1000 for every 100 points in accuracy efficiency and insight
+int calculateFinalDiscoverPoints(const Player& player) {
+    int finalDP = player.getDiscoverPoints();
+    
+    finalDP = finalDP + (player.getAccuracy() / 100) * 1000;
+    finalDP = finalDP + (player.getEfficiency() / 100) * 1000;
+    finalDP = finalDP + (player.getInsight() / 100) * 1000;
+    
+    return finalDP;
+}
+
+
+
+// board with one lane per player, each player selects a character (roster reopens when all are taken), path and advisor
+// (path and advisor from the bot planner instead, if there is one); lanes re-rolled until balanced if asked
+void setupGame(GameState& state, ContentStore& content, int playerCount, istream& in, ostream& out, const SetupOptions& setup) {
+    ContentReader reader(content);
+    const GameData& gameData = reader.pin();
+    const BotPlanner* bots = setup.bots;
+    state.board.setTileMix(setup.tileMix);
+    state.board.reset(playerCount, 52, state.random.next());
+    if (setup.maxLaneGap > 0) {
+        // lanes are compared by what they're worth to a player without an advisor
+        BotPlanner values(gameData);
+        state.board.balanceLanes(values.getTileValues(0), setup.maxLaneGap, LANE_BALANCE_TRIES);
+    }
+    state.players.clear();
+    state.players.reserve(playerCount);
+    pmr::vector<bool> chosen(gameData.getCharacterCount(), false, state.players.get_allocator());
+    
+    for (int i = 0; i < playerCount; i++) {
+        bool anyLeft = false;
+        for (int j = 0; j < (int)chosen.size(); j++) {
+            if (!chosen[j]) {
+                anyLeft = true;
+            }
+        }
+        if (!anyLeft) {
+            chosen.assign(chosen.size(), false);
+        }
+        
+        state.players.push_back(selectCharacter(i + 1, gameData, chosen, in, out));
+        if (bots != nullptr) {
+            BotDecision decision = bots->decide(state.board, i, state.players[i]);
+            applyPathType(state.players[i], decision.pathType);
+            state.players[i].setAdvisor(decision.advisor);
+            out << "Player " << (i + 1) << " (bot) chose "
+                << (decision.pathType == 0 ? "Training Fellowship" : "Direct Lab Assignment");
+            if (decision.advisor > 0) {
+                out << " with advisor " << decision.advisor;
+            }
+            out << " (expects " << (int)decision.expectedScore << " final Discovery Points)." << endl;
+        } else {
+            selectPathType(state.players[i], in, out);
+            if (state.players[i].getPathType() == 0) {
+                selectAdvisor(state.players[i], in, out);
+            }
+        }
+        state.board.setPlayerPosition(i, 0);
+    }
+    state.finished.assign(playerCount, false);
+    state.turn = 0;
+}
+
+// one turn: menu until the player moves, roll dice, move, display board, handle tile event; true if the player reached the finish
+bool playTurn(GameState& state, int playerIndex, const GameData& gameData, TurnBuffers& buffers, istream& in, ostream& out) {
+    TRACE_SPAN("playTurn");
+    Board& gameBoard = state.board;
+    Player& currentPlayer = state.players[playerIndex];
+    int finish = gameBoard.getFinishPosition();
+    
+    out << "\n========================================" << endl;
+    out << "--- Player " << (playerIndex + 1) << "'s Turn (" 
+        << currentPlayer.getCharacterName() << ") ---" << endl;
+    out << "========================================" << endl;
+    
+    int menuChoice = 0;
+    while (menuChoice != 2) {
+        displayMainMenu(currentPlayer, out);
+        menuChoice = handleMenuChoice(currentPlayer, gameBoard, playerIndex, buffers, in, out);
+    }
+    
+    out << "\nRolling the dice..." << endl;
+    int steps;
+    {
+        TRACE_SPAN("rollDice");
+        steps = state.random.nextInt(6) + 1;
+    }
+    out << "You rolled: " << steps << endl;
+    
+    int oldPosition = currentPlayer.getPosition();
+    currentPlayer.updatePosition(steps, finish);
+    int newPosition = currentPlayer.getPosition();
+    
+    out << "Moving from position " << oldPosition << " to position " << newPosition << endl;
+    
+    gameBoard.setPlayerPosition(playerIndex, newPosition);
+    
+    out << "\n=== Current Board State ===" << endl;
+    gameBoard.displayBoard(out);
+    
+    if (newPosition != oldPosition && newPosition < finish) {
+        handleTileEvent(gameBoard, currentPlayer, playerIndex, gameData, state.random, buffers, in, out);
+    }
+    return currentPlayer.getPosition() >= finish;
+}
+
+// game loop: rotate turns, pin content and play each turn, save snapshot, check win condition, calculate final scores, record stats
+void playGame(GameState& state, ContentStore& content, istream& in, ostream& out, const GameOptions& options) {
+    pmr::vector<Player>& players = state.players;
+    int playerCount = players.size();
+    
+    int finishedCount = 0;
+    for (int i = 0; i < playerCount; i++) {
+        if (state.finished[i]) {
+            finishedCount++;
+        }
+    }
+    
+    out << "\n=== Game Starting! ===" << endl;
+    
+    ContentReader reader(content);
+    TurnBuffers buffers;
+    bool game_over = false;
+    
+    while (!game_over) {
+        int currentPlayerIndex = state.turn % playerCount;
+        
+        if (state.finished[currentPlayerIndex]) {
+            state.turn++;
+            continue;
+        }
+        
+        bool reachedFinish = playTurn(state, currentPlayerIndex, reader.pin(), buffers, in, out);
+        reader.unpin();
+        
+        if (reachedFinish) {
+            state.finished[currentPlayerIndex] = true;
+            finishedCount++;
+            out << "\nPlayer " << (currentPlayerIndex + 1) << " reached the finish line!" << endl;
+        }
+        
+        state.turn++;
+        
+        if (finishedCount == playerCount) {
+            game_over = true;
+            if (!options.snapshotFile.empty()) {
+                remove(options.snapshotFile.c_str());
+            }
+            
+            PlayerBatch batch;
+            for (int i = 0; i < playerCount; i++) {
+                batch.add(players[i]);
+            }
+            vector<int> finalDP(playerCount);
+            calculateFinalDiscoverPoints(batch, finalDP.data());
+            int bestDP = *max_element(finalDP.begin(), finalDP.end());
+            
+            out << "\n========================================" << endl;
+            out << "GAME OVER!" << endl;
+            out << "========================================" << endl;
+            out << "\nFinal Results:" << endl;
+            for (int i = 0; i < playerCount; i++) {
+                if (i > 0) {
+                    out << endl;
+                }
+                out << "Player " << (i + 1) << " (" << players[i].getCharacterName() << "):" << endl;
+                out << "  Base Discovery Points: " << players[i].getDiscoverPoints() << endl;
+                out << "  Final Discovery Points (with trait bonuses): " << finalDP[i] << endl;
+            }
+            out << "\n";
+            
+            vector<int> winners;
+            for (int i = 0; i < playerCount; i++) {
+                if (finalDP[i] == bestDP) {
+                    winners.push_back(i);
+                }
+            }
+            if (winners.size() == 1) {
+                out << "Player " << (winners[0] + 1) << " (" << players[winners[0]].getCharacterName() 
+                    << ") wins with " << bestDP << " Discovery Points!" << endl;
+            } else if ((int)winners.size() == playerCount) {
+                out << "It's a tie! All players have " << bestDP << " Discovery Points!" << endl;
+            } else {
+                out << "It's a tie between players";
+                for (int i = 0; i < (int)winners.size(); i++) {
+                    out << " " << (winners[i] + 1);
+                }
+                out << " with " << bestDP << " Discovery Points!" << endl;
+            }
+            out << "========================================" << endl;
+            
+            
+            if (options.leaderboard != nullptr) {
+                Leaderboard& leaderboard = *options.leaderboard;
+                leaderboard.recordGame(players, finalDP);
+                out << "\n=== Leaderboard ===" << endl;
+                for (int i = 0; i < playerCount; i++) {
+                    const string& name = players[i].getCharacterName();
+                    out << "Player " << (i + 1) << " (" << name << "): rank " << leaderboard.getRank(finalDP[i])
+                        << " of " << leaderboard.getResultCount() << " overall (top "
+                        << (int)(100.0 - leaderboard.getPercentile(finalDP[i]) + 1.0) << "%), rank "
+                        << leaderboard.getCharacterRank(name, finalDP[i]) << " of "
+                        << leaderboard.getCharacterCount(name) << " as " << name << endl;
+                }
+            }
+            
+            if (options.stats != nullptr) {
+                options.stats->recordGame(players, finalDP);
+                out << "Game statistics saved to " << options.stats->getFilename() << endl;
+            }
+        } else if (!options.snapshotFile.empty() && !saveSnapshot(state, options.snapshotFile)) {
+            out << "Warning: Could not save the game." << endl;
+        }
+    }
+}
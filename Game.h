@@ -0,0 +1,138 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Player.h"
+#include "Board.h"
+#include "ContentBundle.h"
+#include "ContentStore.h"
+#include "GameState.h"
+#include "Leaderboard.h"
+#include "Metrics.h"
+#include "Random.h"
+#include "ResultCache.h"
+#include "StatsSink.h"
+
+using namespace std;
+
+// thrown by readLine when the input stream is closed (stdin EOF or a disconnected client)
+// so a game waiting for input can unwind and stop instead of spinning on a dead stream
+struct InputClosed {
+};
+
+// file loading: false if the file can't be opened, bad lines are reported to errors as "file:line: ..." and skipped
+bool loadCharacters(const string& filename, ContentSource& source, ostream& errors);
+bool loadRiddles(const string& filename, ContentSource& source, ostream& errors);
+bool loadRandomEvents(const string& filename, ContentSource& source, ostream& errors);
+// parse all three content files from the working directory, print warnings, fall back to default characters
+void loadContentText(ContentSource& source, ostream& out);
+// compile the text files into content.bin, returns false if it can't be written
+bool buildContentBundle(ostream& out);
+// map content.bin if it is valid and newer than the text files, otherwise compile the text files in memory
+void loadGameData(GameData& gameData, ostream& out);
+// tile color mix for lane generation (board_mix.txt, as written by the tune tool): one line of
+// greenPer52|blue|pink|brown|red|purple after the header
+bool loadTileMix(const string& filename, TileMix& mix, ostream& errors);
+bool saveTileMix(const string& filename, const TileMix& mix);
+
+// game metrics, registered in getMetricsRegistry() on first use (names start with genome_)
+struct GameMetrics {
+    Counter* landings[TILE_CODE_COUNT];         // tile landings per color
+    Counter* tasksPassed[TILE_CODE_COUNT];      // DNA task results per tile color (true/false from handle*TileTask)
+    Counter* tasksFailed[TILE_CODE_COUNT];
+    Counter* randomEvents;                      // random events triggered
+    Counter* advisorProtections;                // negative events blocked by the player's advisor
+    Histogram* pointsGained;                    // discovery point change of one landing (task + event), split by sign
+    Histogram* pointsLost;
+    Histogram* strandSimilarityNs;              // kernel latency in nanoseconds
+    Histogram* bestStrandMatchNs;
+    Histogram* identifyMutationsNs;
+    Histogram* transcribeNs;
+};
+const GameMetrics& getGameMetrics();
+
+// DNA kernels (strands are read in place, nothing is copied)
+double strandSimilarity(string_view strand1, string_view strand2);
+int bestStrandMatch(string_view input_strand, string_view target_strand);
+void identifyMutations(string_view input_strand, string_view target_strand, ostream& out);
+void transcribeDNAtoRNA(string_view strand, ostream& out);
+string toLowercase(string_view str);
+bool equalsIgnoreCase(string_view a, string_view b);
+
+// input helpers: one line per answer
+void readLine(istream& in, string& line);
+int readNumber(istream& in);
+
+// answer buffers reused by every turn of one game, so reading answers stops allocating once they've grown
+struct TurnBuffers {
+    string choice;
+    string subChoice;
+    string answer;
+    string normalizedAnswer;    // riddle answer as compared (see matchAnswer)
+    string strand1;
+    string strand2;
+    CachedResult cached;        // result cache lookups copy into this (see ResultCache)
+};
+
+// turn logic (every prompt goes to out, every answer comes from in)
+bool askRiddle(Player& player, const GameData& gameData, Random& random, TurnBuffers& buffers, istream& in, ostream& out);
+void triggerRandomEvent(Player& player, char tileColor, const GameData& gameData, Random& random, ostream& out);
+bool handleBlueTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out);
+bool handlePinkTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out);
+bool handleRedTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out);
+void handleBrownTileTask(Player& player, TurnBuffers& buffers, istream& in, ostream& out);
+void handleTileEvent(Board& board, Player& player, int playerIndex, const GameData& gameData, Random& random, TurnBuffers& buffers, istream& in, ostream& out);
+// points for a correct answer to a tile's task; purple gives up to PURPLE_BONUS_SPREAD more, uniformly at random
+int tileTaskPoints(int tileCode);
+static const int PURPLE_BONUS_SPREAD = 200;
+void displayCharacterMenu(const GameData& gameData, pmr::vector<bool>& chosen, ostream& out);
+Player selectCharacter(int playerNum, const GameData& gameData, pmr::vector<bool>& chosen, istream& in, ostream& out);
+void selectPathType(Player& player, istream& in, ostream& out);
+// path choice without the prompt (0 = Training Fellowship, 1 = Direct Lab Assignment)
+void applyPathType(Player& player, int pathType);
+void selectAdvisor(Player& player, istream& in, ostream& out);
+void displayMainMenu(Player& player, ostream& out);
+int handleMenuChoice(Player& player, Board& board, int playerIndex, TurnBuffers& buffers, istream& in, ostream& out);
+// one player's turn from menu to tile event, true if the player reached the finish
+// (no heap allocation once buffers have grown to the longest answer)
+bool playTurn(GameState& state, int playerIndex, const GameData& gameData, TurnBuffers& buffers, istream& in, ostream& out);
+
+// end of game
+int calculateFinalDiscoverPoints(const Player& player);
+
+class BotPlanner;
+
+// draws per lane before lane balancing settles for the closest one (about 1 us each, so setup stays well under 1 ms)
+static const int LANE_BALANCE_TRIES = 200;
+
+// how setupGame builds a new game: lane generation and computer players
+struct SetupOptions {
+    TileMix tileMix;            // color mix lanes are generated with
+    int maxLaneGap;             // re-roll lanes until their expected points are this close (0 = keep as generated)
+    const BotPlanner* bots;     // every player's path and advisor chosen by the planner (nullptr = asked for)
+
+    SetupOptions() : maxLaneGap(0), bots(nullptr) {
+    }
+};
+
+// what playGame does besides playing: saving, stats, rankings (and how sessions set up their games)
+struct GameOptions {
+    string snapshotFile;        // saved after every turn and removed at game over ("" = no autosave)
+    StatsSink* stats;           // final stats of every player queued at game over (nullptr = none)
+    Leaderboard* leaderboard;   // final results recorded and ranks shown at game over (nullptr = none)
+    SetupOptions setup;         // passed to setupGame by server sessions
+
+    GameOptions() : stats(nullptr), leaderboard(nullptr) {
+    }
+};
+
+// whole game: set up a new game (board, characters, paths) and play it to the end
+// each turn pins the current content version, so content can be reloaded while games run
+void setupGame(GameState& state, ContentStore& content, int playerCount, istream& in, ostream& out,
+               const SetupOptions& setup = SetupOptions());
+void playGame(GameState& state, ContentStore& content, istream& in, ostream& out, const GameOptions& options);
+
+#endif
@@ -0,0 +1,21 @@
+#include "GameArena.h"
+
+using namespace std;
+
+// the block is the arena's initial buffer; extra chunks (if any) come from the default heap
+GameArena::GameArena(size_t blockSize)
+    : _block(blockSize), _resource(_block.data(), _block.size(), pmr::get_default_resource()) {
+}
+
+pmr::memory_resource* GameArena::getResource() {
+    return &_resource;
+}
+
+// release() returns overflow chunks to the heap and rewinds to the start of the block
+void GameArena::reset() {
+    _resource.release();
+}
+
+size_t GameArena::getBlockSize() const {
+    return _block.size();
+}
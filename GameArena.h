@@ -0,0 +1,33 @@
+#ifndef GAMEARENA_H
+#define GAMEARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+
+// GameArena: bump allocator for everything one game allocates (board, player list, flags)
+// Allocations come from a block owned by the arena, falling back to the heap only if a game
+// outgrows it; nothing is freed one by one, reset() drops it all at once when the game is over.
+// One arena per thread: it is not thread safe, and the GameState using it must be gone before reset().
+class GameArena {
+    private:
+        static const size_t _DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+        vector<char> _block;
+        pmr::monotonic_buffer_resource _resource;
+
+    public:
+        GameArena(size_t blockSize = _DEFAULT_BLOCK_SIZE);
+        GameArena(const GameArena&) = delete;
+        GameArena& operator=(const GameArena&) = delete;
+
+        // memory resource to build a GameState with
+        pmr::memory_resource* getResource();
+        // free everything allocated since the last reset, O(1) unless the block overflowed
+        void reset();
+        size_t getBlockSize() const;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include <memory_resource>
+#include <vector>
+#include "Board.h"
+#include "Player.h"
+#include "Random.h"
+
+using namespace std;
+
+// Everything that changes while a game is played (content like riddles lives in GameData)
+// Kept together so a game in progress can be saved and resumed as one unit
+// Board and containers allocate from resource, so a simulation can hand each game a GameArena
+struct GameState {
+    Board board;                    // lanes and positions
+    pmr::vector<Player> players;    // one player per lane
+    pmr::vector<bool> finished;     // which players reached the finish line
+    int turn;                       // turn counter, current player is turn % players.size()
+    Random random;                  // dice, riddles, random events and bonuses
+
+    GameState(pmr::memory_resource* resource = pmr::get_default_resource())
+        : board(resource), players(resource), finished(resource), turn(0) {
+    }
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include "KmerFilter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "BaseCodes.h"
+
+using namespace std;
+
+static const char KMER_FILTER_MAGIC[4] = {'J', 'T', 'G', 'K'};
+static const uint32_t KMER_FILTER_VERSION = 1;
+static const int PREFETCH_DISTANCE = 32;
+
+// odd constants, one per block word, that spread a 32-bit hash over bit positions (the ones Parquet's split block
+// Bloom filter uses)
+static const uint32_t SALTS[8] = {0x47B6137BU, 0x44974D91U, 0x8824AD5BU, 0xA2B7289DU,
+                                  0x705495C7U, 0x2DF1424BU, 0x9EFC4947U, 0x5C6BFB31U};
+
+// file header, followed by the blocks
+struct KmerFilterHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t k;
+    uint32_t reserved;
+    uint64_t blocks;
+    uint64_t added;
+};
+
+// murmur3's 64-bit finalizer: every input bit affects every output bit
+static inline uint64_t hashKmer(uint64_t kmer) {
+    kmer ^= kmer >> 33;
+    kmer *= 0xFF51AFD7ED558CCDULL;
+    kmer ^= kmer >> 33;
+    kmer *= 0xC4CEB9FE1A85EC53ULL;
+    kmer ^= kmer >> 33;
+    return kmer;
+}
+
+// bit of block word w set for a k-mer with this (low 32 bits of the) hash
+static inline uint64_t wordBit(uint32_t hash, int word) {
+    return 1ULL << ((hash * SALTS[word]) >> 26);
+}
+
+// CONSTRUCTORS
+
+KmerFilter::KmerFilter(int k, long long expectedKmers, double bitsPerKmer) {
+    _k = k < 1 ? 1 : (k > 31 ? 31 : k);
+    double bits = (double)(expectedKmers < 1 ? 1 : expectedKmers) * bitsPerKmer;
+    size_t blocks = (size_t)ceil(bits / 512.0);
+    _blocks.assign(blocks < 1 ? 1 : blocks, Block());
+    _added = 0;
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+// roll the forward and reverse-complement packings one base at a time, restarting after a non-ACGT base
+template <typename Process>
+void KmerFilter::forEachKmerBatch(string_view strand, Process process) const {
+    uint64_t kmers[_BATCH];
+    int count = 0;
+    const uint64_t mask = (1ULL << (2 * _k)) - 1;
+    const int shift = 2 * (_k - 1);
+    uint64_t forward = 0;
+    uint64_t reverse = 0;
+    int valid = 0;
+
+    for (char base : strand) {
+        uint64_t code = BASE_CODES[(uint8_t)base];
+        if (code > 3) {
+            valid = 0;
+            continue;
+        }
+        forward = ((forward << 2) | code) & mask;
+        reverse = (reverse >> 2) | ((3 - code) << shift);
+        if (++valid >= _k) {
+            kmers[count++] = forward < reverse ? forward : reverse;
+            if (count == _BATCH) {
+                process(kmers, count);
+                count = 0;
+            }
+        }
+    }
+    if (count > 0) {
+        process(kmers, count);
+    }
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+// hash the batch, then set one bit per word in each k-mer's block
+void KmerFilter::add(string_view strand) {
+    uint64_t hashes[_BATCH];
+    forEachKmerBatch(strand, [&](const uint64_t* kmers, int count) {
+        for (int i = 0; i < count; i++) {
+            hashes[i] = hashKmer(kmers[i]);
+        }
+        for (int i = 0; i < count; i++) {
+            Block& block = _blocks[blockIndex(hashes[i])];
+            for (int w = 0; w < 8; w++) {
+                block.words[w] |= wordBit((uint32_t)hashes[i], w);
+            }
+        }
+        _added += count;
+    });
+}
+
+// hash the batch and find its blocks, then test each block (prefetched a few k-mers ahead) for all eight bits
+KmerScreenResult KmerFilter::screen(string_view strand) const {
+    KmerScreenResult result = {0, 0};
+    uint64_t hashes[_BATCH];
+    uint64_t indexes[_BATCH];
+    forEachKmerBatch(strand, [&](const uint64_t* kmers, int count) {
+        for (int i = 0; i < count; i++) {
+            hashes[i] = hashKmer(kmers[i]);
+            indexes[i] = blockIndex(hashes[i]);
+        }
+        for (int i = 0; i < count && i < PREFETCH_DISTANCE; i++) {
+            __builtin_prefetch(&_blocks[indexes[i]]);
+        }
+        long long hits = 0;
+        for (int i = 0; i < count; i++) {
+            if (i + PREFETCH_DISTANCE < count) {
+                __builtin_prefetch(&_blocks[indexes[i + PREFETCH_DISTANCE]]);
+            }
+            const Block& block = _blocks[indexes[i]];
+            uint64_t missing = 0;
+            for (int w = 0; w < 8; w++) {
+                uint64_t bit = wordBit((uint32_t)hashes[i], w);
+                missing |= ~block.words[w] & bit;
+            }
+            hits += missing == 0;
+        }
+        result.kmers += count;
+        result.hits += hits;
+    });
+    return result;
+}
+
+int KmerFilter::getK() const {
+    return _k;
+}
+
+long long KmerFilter::getAddedCount() const {
+    return _added;
+}
+
+size_t KmerFilter::getMemoryBytes() const {
+    return _blocks.size() * sizeof(Block);
+}
+
+// Bloom filter estimate with 8 bits per k-mer (repeats counted as new k-mers, so this errs high)
+double KmerFilter::getFalsePositiveRate() const {
+    double bits = (double)_blocks.size() * 512.0;
+    return pow(1.0 - exp(-8.0 * _added / bits), 8.0);
+}
+
+// header and blocks to a temp file, then rename over filename
+bool KmerFilter::save(const string& filename) const {
+    KmerFilterHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, KMER_FILTER_MAGIC, 4);
+    header.version = KMER_FILTER_VERSION;
+    header.k = _k;
+    header.blocks = _blocks.size();
+    header.added = _added;
+
+    string tempName = filename + ".tmp";
+    ofstream file(tempName, ios::binary | ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)_blocks.data(), getMemoryBytes());
+    if (!file.flush()) {
+        file.close();
+        remove(tempName.c_str());
+        return false;
+    }
+    file.close();
+    if (rename(tempName.c_str(), filename.c_str()) != 0) {
+        remove(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool KmerFilter::load(const string& filename) {
+    ifstream file(filename, ios::binary);
+    KmerFilterHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, KMER_FILTER_MAGIC, 4) != 0 ||
+        header.version != KMER_FILTER_VERSION || header.k < 1 || header.k > 31 || header.blocks == 0) {
+        return false;
+    }
+    // the block count is only believed if the file holds that many blocks
+    file.seekg(0, ios::end);
+    uint64_t blockBytes = (uint64_t)file.tellg() - sizeof(header);
+    file.seekg(sizeof(header));
+    if (header.blocks > blockBytes / sizeof(Block)) {
+        return false;
+    }
+    vector<Block> blocks(header.blocks);
+    if (!file.read((char*)blocks.data(), header.blocks * sizeof(Block))) {
+        return false;
+    }
+    _k = header.k;
+    _blocks.swap(blocks);
+    _added = header.added;
+    return true;
+}
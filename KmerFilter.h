@@ -0,0 +1,69 @@
+#ifndef KMERFILTER_H
+#define KMERFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// what screening one strand found
+struct KmerScreenResult {
+    long long kmers;        // k-mers in the strand (windows with a base other than A/C/G/T are left out)
+    long long hits;         // k-mers the filter says it contains
+
+    double getHitFraction() const {
+        return kmers == 0 ? 0.0 : (double)hits / kmers;
+    }
+};
+
+// KmerFilter: blocked Bloom filter over the canonical k-mers (k <= 31) of contaminant strands
+// A k-mer is packed into 2 bits per base, and a strand and its reverse complement give the same k-mer (the smaller
+// packing is used). Each k-mer's 64-bit hash picks one 64-byte block (one cache line) and sets one bit in each of the
+// block's eight 64-bit words, so an insert or a lookup touches a single cache line. Strands are hashed and probed in
+// batches of independent k-mers: the hash loop has no dependencies between lanes, so the compiler vectorizes it
+// (build with -march=native for AVX2/AVX-512), and every block is prefetched before it is tested.
+// At 16 bits per k-mer about 1 k-mer in 1000 that was never added is reported as present.
+class KmerFilter {
+    private:
+        static const int _BATCH = 256;
+
+        struct alignas(64) Block {
+            uint64_t words[8];
+        };
+
+        int _k;
+        vector<Block> _blocks;
+        long long _added;
+
+        // canonical k-mers of strand, handed to process in batches of up to _BATCH
+        template <typename Process>
+        void forEachKmerBatch(string_view strand, Process process) const;
+        uint64_t blockIndex(uint64_t hash) const {
+            return ((hash >> 32) * (uint64_t)_blocks.size()) >> 32;
+        }
+
+    public:
+        // room for expectedKmers distinct k-mers at bitsPerKmer bits each (rounded up to whole blocks)
+        KmerFilter(int k = 31, long long expectedKmers = 1 << 20, double bitsPerKmer = 16);
+
+        // add every k-mer of a contaminant strand
+        void add(string_view strand);
+        // count the strand's k-mers and how many of them hit the filter
+        KmerScreenResult screen(string_view strand) const;
+
+        int getK() const;
+        long long getAddedCount() const;
+        size_t getMemoryBytes() const;
+        // expected share of absent k-mers reported as present, from the fill so far
+        double getFalsePositiveRate() const;
+
+        // binary file: header (magic, k, block count, k-mers added), then the blocks; temp file + rename
+        bool save(const string& filename) const;
+        // false if the file is missing or not a k-mer filter
+        bool load(const string& filename);
+};
+
+#endif
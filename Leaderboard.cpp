@@ -0,0 +1,227 @@
+#include "Leaderboard.h"
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+// same formula as calculateFinalDiscoverPoints(Player), one column at a time so the loop vectorizes
+void calculateFinalDiscoverPoints(const PlayerBatch& batch, int* finalDP) {
+    int n = batch.size();
+    const int* dp = batch.discoverPoints.data();
+    const int* acc = batch.accuracy.data();
+    const int* eff = batch.efficiency.data();
+    const int* ins = batch.insight.data();
+
+    for (int i = 0; i < n; i++) {
+        finalDP[i] = dp[i] + (acc[i] / 100) * 1000 + (eff[i] / 100) * 1000 + (ins[i] / 100) * 1000;
+    }
+}
+
+// SCORE RANKING
+
+ScoreRanking::ScoreRanking(int topK) {
+    _top_k = topK;
+    _count = 0;
+    _low = 0;
+    _size = 0;
+}
+
+// double the covered range toward the new score until it fits, then rebuild the tree from the plain counts
+void ScoreRanking::grow(int score) {
+    if (_size == 0) {
+        _size = 1024;
+        _low = score - _size / 2;
+        _counts.assign(_size, 0);
+        _tree.assign(_size + 1, 0);
+        return;
+    }
+
+    int low = _low;
+    long long size = _size;
+    while (score < low || score >= low + size) {
+        if (score < low) {
+            low -= size;
+        }
+        size *= 2;
+    }
+
+    vector<long long> counts(size, 0);
+    for (int i = 0; i < _size; i++) {
+        counts[_low - low + i] = _counts[i];
+    }
+
+    // O(n) Fenwick build: push each node's total up to its parent
+    vector<long long> tree(size + 1, 0);
+    for (long long i = 1; i <= size; i++) {
+        tree[i] += counts[i - 1];
+        long long parent = i + (i & -i);
+        if (parent <= size) {
+            tree[parent] += tree[i];
+        }
+    }
+
+    _low = low;
+    _size = size;
+    _counts.swap(counts);
+    _tree.swap(tree);
+}
+
+long long ScoreRanking::countAtOrBelow(int score) const {
+    if (_size == 0 || score < _low) {
+        return 0;
+    }
+    if (score >= _low + _size) {
+        return _count;
+    }
+    long long total = 0;
+    for (int i = score - _low + 1; i > 0; i -= i & -i) {
+        total += _tree[i];
+    }
+    return total;
+}
+
+void ScoreRanking::add(int score, long long id) {
+    if (_size == 0 || score < _low || score >= _low + _size) {
+        grow(score);
+    }
+    int index = score - _low;
+    _counts[index]++;
+    for (int i = index + 1; i <= _size; i += i & -i) {
+        _tree[i]++;
+    }
+    _count++;
+
+    if ((int)_top.size() < _top_k) {
+        _top.push_back(make_pair(score, id));
+        push_heap(_top.begin(), _top.end(), greater<pair<int, long long> >());
+    } else if (_top_k > 0 && score > _top.front().first) {
+        pop_heap(_top.begin(), _top.end(), greater<pair<int, long long> >());
+        _top.back() = make_pair(score, id);
+        push_heap(_top.begin(), _top.end(), greater<pair<int, long long> >());
+    }
+}
+
+long long ScoreRanking::getCount() const {
+    return _count;
+}
+
+long long ScoreRanking::getRank(int score) const {
+    return 1 + (_count - countAtOrBelow(score));
+}
+
+double ScoreRanking::getPercentile(int score) const {
+    if (_count == 0) {
+        return 0.0;
+    }
+    return 100.0 * (double)countAtOrBelow(score) / (double)_count;
+}
+
+// rank r (1 = best) is the (count - r + 1)-th smallest score: walk down the Fenwick tree to find it
+int ScoreRanking::getScoreAtRank(long long rank) const {
+    if (rank < 1 || rank > _count) {
+        return 0;
+    }
+    long long k = _count - rank + 1;
+    int pos = 0;
+    for (int step = _size; step > 0; step /= 2) {
+        if (pos + step <= _size && _tree[pos + step] < k) {
+            pos += step;
+            k -= _tree[pos];
+        }
+    }
+    return _low + pos;
+}
+
+vector<pair<int, long long> > ScoreRanking::getTop() const {
+    vector<pair<int, long long> > top = _top;
+    sort(top.begin(), top.end(), greater<pair<int, long long> >());
+    return top;
+}
+
+// LEADERBOARD
+
+Leaderboard::Leaderboard(int topK) : _global(topK) {
+    _top_k = topK;
+    _next_game_id = 1;
+}
+
+void Leaderboard::recordLocked(const string& characterName, int finalDP, long long gameId) {
+    _global.add(finalDP, gameId);
+    map<string, ScoreRanking>::iterator it = _characters.find(characterName);
+    if (it == _characters.end()) {
+        it = _characters.insert(make_pair(characterName, ScoreRanking(_top_k))).first;
+    }
+    it->second.add(finalDP, gameId);
+}
+
+long long Leaderboard::recordGame(const pmr::vector<Player>& players, const vector<int>& finalDP) {
+    lock_guard<mutex> guard(_lock);
+    long long gameId = _next_game_id++;
+    for (int i = 0; i < (int)players.size() && i < (int)finalDP.size(); i++) {
+        recordLocked(players[i].getCharacterName(), finalDP[i], gameId);
+    }
+    return gameId;
+}
+
+void Leaderboard::recordBatch(const vector<string>& names, const PlayerBatch& batch) {
+    vector<int> finalDP(batch.size());
+    calculateFinalDiscoverPoints(batch, finalDP.data());
+
+    lock_guard<mutex> guard(_lock);
+    for (int i = 0; i < batch.size() && i < (int)names.size(); i++) {
+        recordLocked(names[i], finalDP[i], _next_game_id++);
+    }
+}
+
+long long Leaderboard::getGameCount() const {
+    lock_guard<mutex> guard(_lock);
+    return _next_game_id - 1;
+}
+
+long long Leaderboard::getResultCount() const {
+    lock_guard<mutex> guard(_lock);
+    return _global.getCount();
+}
+
+long long Leaderboard::getRank(int finalDP) const {
+    lock_guard<mutex> guard(_lock);
+    return _global.getRank(finalDP);
+}
+
+double Leaderboard::getPercentile(int finalDP) const {
+    lock_guard<mutex> guard(_lock);
+    return _global.getPercentile(finalDP);
+}
+
+long long Leaderboard::getCharacterRank(const string& characterName, int finalDP) const {
+    lock_guard<mutex> guard(_lock);
+    map<string, ScoreRanking>::const_iterator it = _characters.find(characterName);
+    if (it == _characters.end()) {
+        return 1;
+    }
+    return it->second.getRank(finalDP);
+}
+
+long long Leaderboard::getCharacterCount(const string& characterName) const {
+    lock_guard<mutex> guard(_lock);
+    map<string, ScoreRanking>::const_iterator it = _characters.find(characterName);
+    if (it == _characters.end()) {
+        return 0;
+    }
+    return it->second.getCount();
+}
+
+void Leaderboard::print(ostream& out) const {
+    lock_guard<mutex> guard(_lock);
+    out << "=== Leaderboard (" << _global.getCount() << " results) ===" << endl;
+    vector<pair<int, long long> > top = _global.getTop();
+    for (int i = 0; i < (int)top.size(); i++) {
+        out << (i + 1) << ". " << top[i].first << " Discovery Points (game " << top[i].second << ")" << endl;
+    }
+    out << "Best per character:" << endl;
+    for (map<string, ScoreRanking>::const_iterator it = _characters.begin(); it != _characters.end(); it++) {
+        out << "  " << it->first << ": " << it->second.getScoreAtRank(1)
+            << " (" << it->second.getCount() << " results, median "
+            << it->second.getScoreAtRank((it->second.getCount() + 1) / 2) << ")" << endl;
+    }
+}
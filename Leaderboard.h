@@ -0,0 +1,111 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Player.h"
+
+using namespace std;
+
+// PlayerBatch: final stats of many players stored column by column (structure of arrays)
+// so final scoring runs as one tight loop the compiler can vectorize
+struct PlayerBatch {
+    vector<int> discoverPoints;
+    vector<int> accuracy;
+    vector<int> efficiency;
+    vector<int> insight;
+
+    void add(const Player& player) {
+        discoverPoints.push_back(player.getDiscoverPoints());
+        accuracy.push_back(player.getAccuracy());
+        efficiency.push_back(player.getEfficiency());
+        insight.push_back(player.getInsight());
+    }
+
+    int size() const {
+        return discoverPoints.size();
+    }
+
+    void clear() {
+        discoverPoints.clear();
+        accuracy.clear();
+        efficiency.clear();
+        insight.clear();
+    }
+};
+
+// final discovery points for every player in the batch (same rule as calculateFinalDiscoverPoints(Player))
+void calculateFinalDiscoverPoints(const PlayerBatch& batch, int* finalDP);
+
+// ScoreRanking: rankings over a stream of scores
+// A Fenwick tree over the score range answers rank, percentile and score-at-rank in O(log n),
+// and a min-heap keeps the K best results. The score range grows (doubles) when needed.
+class ScoreRanking {
+    private:
+        int _top_k;
+        long long _count;
+        // Fenwick tree covers scores [_low, _low + _size), _size is a power of two
+        int _low;
+        int _size;
+        vector<long long> _tree;
+        vector<long long> _counts;
+        // K best (score, id) pairs, smallest on top
+        vector<pair<int, long long> > _top;
+
+        void grow(int score);
+        // results with score <= given score
+        long long countAtOrBelow(int score) const;
+
+    public:
+        ScoreRanking(int topK = 10);
+
+        void add(int score, long long id);
+        long long getCount() const;
+        // 1 + number of strictly higher scores (ties share a rank)
+        long long getRank(int score) const;
+        // percent of results scoring at or below score
+        double getPercentile(int score) const;
+        // score held by the given rank (1 = best), 0 if out of range
+        int getScoreAtRank(long long rank) const;
+        // K best results, best first
+        vector<pair<int, long long> > getTop() const;
+};
+
+// Leaderboard: global and per-character rankings of final discovery points, updated as games finish
+// Safe to share between threads (server sessions record into one leaderboard)
+class Leaderboard {
+    private:
+        int _top_k;
+        long long _next_game_id;
+        ScoreRanking _global;
+        map<string, ScoreRanking> _characters;
+        mutable mutex _lock;
+
+        void recordLocked(const string& characterName, int finalDP, long long gameId);
+
+    public:
+        Leaderboard(int topK = 10);
+
+        // record one finished game (finalDP[i] belongs to players[i]), returns the game's id
+        long long recordGame(const pmr::vector<Player>& players, const vector<int>& finalDP);
+        // score a whole batch at once and record it; names[i] belongs to row i, all rows get one game id each
+        void recordBatch(const vector<string>& names, const PlayerBatch& batch);
+
+        long long getGameCount() const;
+        long long getResultCount() const;
+        // rank and percentile among everyone / among players of the same character
+        long long getRank(int finalDP) const;
+        double getPercentile(int finalDP) const;
+        long long getCharacterRank(const string& characterName, int finalDP) const;
+        long long getCharacterCount(const string& characterName) const;
+
+        // print the global top K and the best score per character
+        void print(ostream& out) const;
+};
+
+#endif
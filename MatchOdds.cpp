@@ -0,0 +1,225 @@
+#include "MatchOdds.h"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <utility>
+#include "Game.h"
+
+using namespace std;
+
+double ScoreDistribution::mean() const {
+    double total = 0;
+    for (int i = 0; i < (int)probabilities.size(); i++) {
+        total += probabilities[i] * (minScore + i);
+    }
+    return total;
+}
+
+double ScoreDistribution::probabilityOf(int score) const {
+    int index = score - minScore;
+    if (index < 0 || index >= (int)probabilities.size()) {
+        return 0;
+    }
+    return probabilities[index];
+}
+
+// what landing on a tile of this code can give, in points: task reward plus each event the tile allows
+// (equal values merged), the same rules as handleTileEvent and triggerRandomEvent
+static void tileOutcomes(int tileCode, int advisor, const GameData& gameData, vector<pair<int, double>>& outcomes) {
+    outcomes.clear();
+    int task = tileTaskPoints(tileCode);
+    if (task == 0) {
+        outcomes.push_back(make_pair(0, 1.0));
+        return;
+    }
+
+    char color = tileCodeToColor(tileCode);
+    int eventCount = gameData.getTileEventCount(color);
+    if (eventCount == 0) {
+        outcomes.push_back(make_pair(task, 1.0));
+        return;
+    }
+    for (int i = 0; i < eventCount; i++) {
+        RandomEvent e = gameData.getTileEvent(color, i);
+        bool protectedByAdvisor = e.advisor > 0 && e.discoveryPoints < 0 && advisor == e.advisor;
+        outcomes.push_back(make_pair(task + (protectedByAdvisor ? 0 : e.discoveryPoints), 1.0 / eventCount));
+    }
+
+    sort(outcomes.begin(), outcomes.end());
+    int merged = 0;
+    for (int i = 1; i < (int)outcomes.size(); i++) {
+        if (outcomes[i].first == outcomes[merged].first) {
+            outcomes[merged].second += outcomes[i].second;
+        } else {
+            outcomes[++merged] = outcomes[i];
+        }
+    }
+    outcomes.resize(merged + 1);
+}
+
+// convolve scores with the uniform 0..spread bonus (a box filter, O(length) with a running sum)
+static void addUniformBonus(vector<double>& scores, vector<double>& scratch, int spread) {
+    scratch.assign(scores.size(), 0);
+    double window = 0;
+    for (int i = 0; i < (int)scores.size(); i++) {
+        window += scores[i];
+        if (i - spread - 1 >= 0) {
+            window -= scores[i - spread - 1];
+        }
+        scratch[i] = window / (spread + 1);
+    }
+    scores.swap(scratch);
+}
+
+// forward pass over the lane on a grid of unit-sized steps, layers by purple count, ring of the last 7 positions
+bool laneScoreDistribution(const Board& board, int lane, const Player& player, const GameData& gameData,
+                           ScoreDistribution& scores) {
+    if (lane < 0 || lane >= board.getLaneCount()) {
+        return false;
+    }
+    int finish = board.getFinishPosition();
+
+    // tile outcomes, and the grid step every reward is a multiple of
+    vector<pair<int, double>> outcomes[TILE_CODE_COUNT];
+    int unit = 0;
+    int lowest = 0;
+    int highest = 0;
+    for (int code = 0; code < TILE_CODE_COUNT; code++) {
+        tileOutcomes(code, player.getAdvisor(), gameData, outcomes[code]);
+        for (int i = 0; i < (int)outcomes[code].size(); i++) {
+            int value = outcomes[code][i].first;
+            unit = gcd(unit, abs(value));
+            lowest = min(lowest, value);
+            highest = max(highest, value);
+        }
+    }
+    if (unit == 0) {
+        unit = 1;
+    }
+    for (int code = 0; code < TILE_CODE_COUNT; code++) {
+        for (int i = 0; i < (int)outcomes[code].size(); i++) {
+            outcomes[code][i].first /= unit;
+        }
+    }
+
+    // at most finish - 1 landings, so this many steps either side of zero covers every total
+    int landings = finish - 1 > 0 ? finish - 1 : 0;
+    int zero = landings * (-lowest / unit);
+    int steps = zero + landings * (highest / unit) + 1;
+    int purpleCount = 0;
+    for (int pos = 1; pos < finish; pos++) {
+        if (board.getTileCode(lane, pos) == TILE_PURPLE) {
+            purpleCount++;
+        }
+    }
+    int layerSize = (purpleCount + 1) * steps;
+
+    vector<double> ring[7];
+    for (int i = 0; i < 7; i++) {
+        ring[i].assign(layerSize, 0);
+    }
+    vector<double> arrival(layerSize);
+    vector<double> finished(layerSize, 0);
+    ring[0][zero] = 1;
+
+    for (int pos = 0; pos < finish; pos++) {
+        vector<double>& here = ring[pos % 7];
+        if (pos > 0) {
+            // every roll from the six positions before lands here with probability 1/6
+            arrival.assign(layerSize, 0);
+            for (int roll = 1; roll <= 6 && pos - roll >= 0; roll++) {
+                const vector<double>& from = ring[(pos - roll) % 7];
+                for (int i = 0; i < layerSize; i++) {
+                    arrival[i] += from[i];
+                }
+            }
+
+            int code = board.getTileCode(lane, pos);
+            int nextLayer = code == TILE_PURPLE ? 1 : 0;
+            const vector<pair<int, double>>& tile = outcomes[code];
+            here.assign(layerSize, 0);
+            for (int layer = 0; layer + nextLayer <= purpleCount; layer++) {
+                const double* in = &arrival[layer * steps];
+                double* out = &here[(layer + nextLayer) * steps];
+                for (int s = 0; s < steps; s++) {
+                    if (in[s] == 0) {
+                        continue;
+                    }
+                    double p = in[s] / 6;
+                    for (int k = 0; k < (int)tile.size(); k++) {
+                        out[s + tile[k].first] += p * tile[k].second;
+                    }
+                }
+            }
+        }
+
+        // rolls that reach or pass the finish end the lane (the finish tile gives nothing)
+        int finishingRolls = 6 - (finish - pos) + 1;
+        if (finishingRolls > 0) {
+            double weight = finishingRolls / 6.0;
+            for (int i = 0; i < layerSize; i++) {
+                finished[i] += here[i] * weight;
+            }
+        }
+    }
+
+    // points grid: totals = sum over purple counts m of (layer m convolved m times with the bonus box),
+    // done Horner style from the highest layer down
+    int points = (steps - 1) * unit + purpleCount * PURPLE_BONUS_SPREAD + 1;
+    vector<double> total(points, 0);
+    vector<double> scratch;
+    for (int layer = purpleCount; layer >= 0; layer--) {
+        if (layer < purpleCount) {
+            addUniformBonus(total, scratch, PURPLE_BONUS_SPREAD);
+        }
+        for (int s = 0; s < steps; s++) {
+            total[s * unit] += finished[layer * steps + s];
+        }
+    }
+
+    int first = 0;
+    while (first < points - 1 && total[first] == 0) {
+        first++;
+    }
+    int last = points - 1;
+    while (last > first && total[last] == 0) {
+        last--;
+    }
+    scores.minScore = calculateFinalDiscoverPoints(player) - zero * unit + first;
+    scores.probabilities.assign(total.begin() + first, total.begin() + last + 1);
+    return true;
+}
+
+// lane 0 belongs to first, lane 1 to second; compare the two distributions with a running sum of second's
+MatchOdds computeMatchOdds(const Board& board, const Player& first, const Player& second, const GameData& gameData) {
+    MatchOdds odds;
+    odds.winProbability[0] = 0;
+    odds.winProbability[1] = 0;
+    odds.tieProbability = 0;
+    if (!laneScoreDistribution(board, 0, first, gameData, odds.scores[0]) ||
+        !laneScoreDistribution(board, 1, second, gameData, odds.scores[1])) {
+        return odds;
+    }
+
+    const ScoreDistribution& a = odds.scores[0];
+    const ScoreDistribution& b = odds.scores[1];
+    vector<double> below(b.probabilities.size() + 1, 0);
+    for (int i = 0; i < (int)b.probabilities.size(); i++) {
+        below[i + 1] = below[i] + b.probabilities[i];
+    }
+    double bTotal = below.back();
+
+    for (int i = 0; i < (int)a.probabilities.size(); i++) {
+        double p = a.probabilities[i];
+        if (p == 0) {
+            continue;
+        }
+        int index = a.minScore + i - b.minScore;
+        int clamped = index < 0 ? 0 : (index > (int)b.probabilities.size() ? (int)b.probabilities.size() : index);
+        double equal = (index >= 0 && index < (int)b.probabilities.size()) ? b.probabilities[index] : 0;
+        odds.winProbability[0] += p * below[clamped];
+        odds.tieProbability += p * equal;
+        odds.winProbability[1] += p * (bTotal - below[clamped] - equal);
+    }
+    return odds;
+}
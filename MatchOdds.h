@@ -0,0 +1,40 @@
+#ifndef MATCHODDS_H
+#define MATCHODDS_H
+
+#include <vector>
+#include "Board.h"
+#include "ContentBundle.h"
+#include "Player.h"
+
+using namespace std;
+
+// ScoreDistribution: probability of every final score (with trait bonuses) one player can end with
+struct ScoreDistribution {
+    int minScore;                   // score of probabilities[0], scores go up by one point per entry
+    vector<double> probabilities;
+
+    double mean() const;
+    // probability of ending with exactly score
+    double probabilityOf(int score) const;
+};
+
+// MatchOdds: exact outcome of a two-player game on a given board
+struct MatchOdds {
+    double winProbability[2];       // player 1 / player 2 ends with strictly more points
+    double tieProbability;
+    ScoreDistribution scores[2];
+};
+
+// Exact odds by dynamic programming over each lane as a Markov chain (no sampling)
+// State: (position, points gained so far, purple tiles landed on). Every position's distribution is the
+// d6-weighted sum of the six positions before it, convolved with what its tile can give (task reward plus
+// each random event the tile allows, advisor protection included). The purple bonus (300 plus 0-200) is
+// split off: the 0-200 parts are added at the end as repeated box filters, so the grid stays at the
+// coarse step that every other reward is a multiple of.
+// Assumes every DNA task is answered correctly (as bots and the simulation script do); players must already
+// have their path and advisor. Lanes are independent, so a game's outcome only depends on the two final scores.
+bool laneScoreDistribution(const Board& board, int lane, const Player& player, const GameData& gameData,
+                           ScoreDistribution& scores);
+MatchOdds computeMatchOdds(const Board& board, const Player& first, const Player& second, const GameData& gameData);
+
+#endif
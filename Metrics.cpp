@@ -0,0 +1,354 @@
+#include "Metrics.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// a scrape request is read for at most this long before answering (clients like nc may send nothing)
+static const int REQUEST_WAIT_MS = 100;
+
+unsigned assignMetricShard() {
+    static atomic<unsigned> next(0);
+    return next.fetch_add(1, memory_order_relaxed) % METRIC_SHARDS;
+}
+
+int64_t metricsNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// COUNTER
+
+Counter::Counter() {
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        _shards[i].value.store(0, memory_order_relaxed);
+    }
+}
+
+uint64_t Counter::getValue() const {
+    uint64_t total = 0;
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        total += _shards[i].value.load(memory_order_relaxed);
+    }
+    return total;
+}
+
+// HISTOGRAM
+
+Histogram::Histogram() : _shards(new Shard[METRIC_SHARDS]) {
+    for (int s = 0; s < METRIC_SHARDS; s++) {
+        for (int b = 0; b < _BUCKETS; b++) {
+            _shards[s].buckets[b].store(0, memory_order_relaxed);
+        }
+        _shards[s].sum.store(0, memory_order_relaxed);
+    }
+}
+
+// inverse of bucketOf: buckets 0-15 are the values themselves, then 16 steps per power of two
+uint64_t Histogram::bucketStart(int bucket) {
+    if (bucket < _SUB_BUCKETS) {
+        return bucket;
+    }
+    int exponent = bucket / _SUB_BUCKETS + 3;
+    uint64_t sub = bucket % _SUB_BUCKETS;
+    return (_SUB_BUCKETS + sub) << (exponent - 4);
+}
+
+void Histogram::collect(vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum) const {
+    buckets.assign(_BUCKETS, 0);
+    count = 0;
+    sum = 0;
+    for (int s = 0; s < METRIC_SHARDS; s++) {
+        for (int b = 0; b < _BUCKETS; b++) {
+            uint64_t n = _shards[s].buckets[b].load(memory_order_relaxed);
+            buckets[b] += n;
+            count += n;
+        }
+        sum += _shards[s].sum.load(memory_order_relaxed);
+    }
+}
+
+uint64_t Histogram::getCount() const {
+    vector<uint64_t> buckets;
+    uint64_t count, sum;
+    collect(buckets, count, sum);
+    return count;
+}
+
+// walk the buckets until the running count passes q of the total
+uint64_t Histogram::getQuantile(double q) const {
+    vector<uint64_t> buckets;
+    uint64_t count, sum;
+    collect(buckets, count, sum);
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(q * count);
+    if (rank >= count) {
+        rank = count - 1;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < _BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen > rank) {
+            return bucketStart(b);
+        }
+    }
+    return bucketStart(_BUCKETS - 1);
+}
+
+// METRICS REGISTRY
+
+Counter& MetricsRegistry::addCounter(const string& name, const string& help, const string& labels) {
+    lock_guard<mutex> guard(_lock);
+    unique_ptr<Entry> entry(new Entry());
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labels;
+    entry->counter.reset(new Counter());
+    _entries.push_back(move(entry));
+    return *_entries.back()->counter;
+}
+
+Histogram& MetricsRegistry::addHistogram(const string& name, const string& help, const string& labels) {
+    lock_guard<mutex> guard(_lock);
+    unique_ptr<Entry> entry(new Entry());
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labels;
+    entry->histogram.reset(new Histogram());
+    _entries.push_back(move(entry));
+    return *_entries.back()->histogram;
+}
+
+// HELP/TYPE once per name; histogram buckets are cumulative and end on powers of two (le = 2^k - 1,
+// since values are integers that is "below 2^k", which lines up with the internal bucket edges)
+void MetricsRegistry::writePrometheus(ostream& out) const {
+    lock_guard<mutex> guard(_lock);
+    const string* lastName = nullptr;
+    vector<uint64_t> buckets;
+
+    for (const unique_ptr<Entry>& entry : _entries) {
+        if (lastName == nullptr || *lastName != entry->name) {
+            out << "# HELP " << entry->name << " " << entry->help << "\n";
+            out << "# TYPE " << entry->name << " " << (entry->counter ? "counter" : "histogram") << "\n";
+            lastName = &entry->name;
+        }
+
+        if (entry->counter) {
+            out << entry->name;
+            if (!entry->labels.empty()) {
+                out << "{" << entry->labels << "}";
+            }
+            out << " " << entry->counter->getValue() << "\n";
+            continue;
+        }
+
+        uint64_t count, sum;
+        entry->histogram->collect(buckets, count, sum);
+        int last = Histogram::_BUCKETS - 1;
+        while (last > 0 && buckets[last] == 0) {
+            last--;
+        }
+        string prefix = entry->labels.empty() ? "" : entry->labels + ",";
+
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for (int exponent = 1; exponent <= 64; exponent++) {
+            uint64_t below = exponent == 64 ? ~0ULL : (1ULL << exponent);
+            while (bucket < Histogram::_BUCKETS && (exponent == 64 || Histogram::bucketStart(bucket) < below)) {
+                cumulative += buckets[bucket++];
+            }
+            out << entry->name << "_bucket{" << prefix << "le=\"" << (below - (exponent == 64 ? 0 : 1)) << "\"} " << cumulative << "\n";
+            if (bucket > last) {
+                break;
+            }
+        }
+        out << entry->name << "_bucket{" << prefix << "le=\"+Inf\"} " << count << "\n";
+        out << entry->name << "_sum";
+        if (!entry->labels.empty()) {
+            out << "{" << entry->labels << "}";
+        }
+        out << " " << sum << "\n";
+        out << entry->name << "_count";
+        if (!entry->labels.empty()) {
+            out << "{" << entry->labels << "}";
+        }
+        out << " " << count << "\n";
+    }
+}
+
+MetricsRegistry& getMetricsRegistry() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// METRICS EXPORTER
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry) : _registry(registry) {
+    _interval_ms = 0;
+    _listen_fd = -1;
+    _wake_fd = -1;
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+// bind and listen on a Unix socket (same setup as the game server's unix: addresses)
+bool MetricsExporter::listenOn(const string& socketPath) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.length() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    strcpy(addr.sun_path, socketPath.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    unlink(socketPath.c_str());
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return false;
+    }
+    _listen_fd = fd;
+    _socket_path = socketPath;
+    return true;
+}
+
+void MetricsExporter::setFile(const string& filename, int intervalMs) {
+    _filename = filename;
+    _interval_ms = intervalMs > 0 ? intervalMs : 1000;
+}
+
+bool MetricsExporter::start() {
+    if (_thread.joinable()) {
+        return true;
+    }
+    if (_listen_fd < 0 && _filename.empty()) {
+        return false;
+    }
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _thread = thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (_thread.joinable()) {
+        uint64_t one = 1;
+        write(_wake_fd, &one, sizeof(one));
+        _thread.join();
+        if (!_filename.empty()) {
+            writeFile();
+        }
+    }
+    if (_listen_fd >= 0) {
+        close(_listen_fd);
+        _listen_fd = -1;
+        unlink(_socket_path.c_str());
+    }
+    if (_wake_fd >= 0) {
+        close(_wake_fd);
+        _wake_fd = -1;
+    }
+}
+
+// read (and ignore) the request if one arrives, answer with the exposition as an HTTP/1.0 response
+void MetricsExporter::serveClient(int fd) {
+    struct pollfd request;
+    request.fd = fd;
+    request.events = POLLIN;
+    if (poll(&request, 1, REQUEST_WAIT_MS) > 0) {
+        char buffer[1024];
+        read(fd, buffer, sizeof(buffer));
+    }
+
+    ostringstream body;
+    _registry.writePrometheus(body);
+    string text = body.str();
+    string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                      to_string(text.size()) + "\r\n\r\n" + text;
+
+    size_t written = 0;
+    while (written < response.size()) {
+        ssize_t n = write(fd, response.data() + written, response.size() - written);
+        if (n <= 0) {
+            break;
+        }
+        written += n;
+    }
+    close(fd);
+}
+
+// write everything to filename.tmp, rename into place (readers never see a half-written file)
+bool MetricsExporter::writeFile() {
+    ostringstream body;
+    _registry.writePrometheus(body);
+    string text = body.str();
+
+    string tempName = _filename + ".tmp";
+    int fd = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = write(fd, text.data() + written, text.size() - written);
+        if (n <= 0) {
+            close(fd);
+            unlink(tempName.c_str());
+            return false;
+        }
+        written += n;
+    }
+    close(fd);
+
+    if (rename(tempName.c_str(), _filename.c_str()) != 0) {
+        unlink(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// answer scrapes as they come, rewrite the file whenever the interval has passed
+void MetricsExporter::run() {
+    struct pollfd fds[2];
+    fds[0].fd = _wake_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = _listen_fd;
+    fds[1].events = POLLIN;
+    int count = _listen_fd >= 0 ? 2 : 1;
+
+    chrono::steady_clock::time_point writeAt = chrono::steady_clock::now();
+    while (true) {
+        int timeout = -1;
+        if (!_filename.empty()) {
+            long long wait = chrono::duration_cast<chrono::milliseconds>(writeAt - chrono::steady_clock::now()).count();
+            timeout = wait > 0 ? (int)wait : 0;
+        }
+
+        int ready = poll(fds, count, timeout);
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            return;
+        }
+        if (ready > 0 && count == 2 && (fds[1].revents & POLLIN)) {
+            int client = accept4(_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serveClient(client);
+            }
+        }
+        if (!_filename.empty() && chrono::steady_clock::now() >= writeAt) {
+            writeFile();
+            writeAt = chrono::steady_clock::now() + chrono::milliseconds(_interval_ms);
+        }
+    }
+}
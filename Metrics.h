@@ -0,0 +1,166 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Metrics: counters and latency/value histograms, exposed in Prometheus text format
+// Every metric is split into shards on separate cache lines and each thread adds to its own shard,
+// so recording is one or two relaxed atomic adds with no contention; reading sums the shards.
+static const int METRIC_SHARDS = 16;
+
+// shard the calling thread records into (threads are spread round robin)
+unsigned assignMetricShard();
+inline unsigned currentMetricShard() {
+    static thread_local unsigned shard = assignMetricShard();
+    return shard;
+}
+
+// nanoseconds on the steady clock, for latency measurements
+int64_t metricsNow();
+
+// Counter: monotonically increasing count
+class Counter {
+    private:
+        struct alignas(64) Shard {
+            atomic<uint64_t> value;
+        };
+        Shard _shards[METRIC_SHARDS];
+
+    public:
+        Counter();
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        void add(uint64_t amount = 1) {
+            _shards[currentMetricShard()].value.fetch_add(amount, memory_order_relaxed);
+        }
+        uint64_t getValue() const;
+};
+
+// Histogram: HDR-style log-linear buckets - values below 16 exactly, above that 16 buckets per power
+// of two (within about 6%) - for non-negative values up to 2^64
+class Histogram {
+    private:
+        static const int _SUB_BUCKETS = 16;
+        static const int _BUCKETS = 61 * _SUB_BUCKETS;
+
+        struct alignas(64) Shard {
+            atomic<uint64_t> buckets[_BUCKETS];
+            atomic<uint64_t> sum;
+        };
+        unique_ptr<Shard[]> _shards;
+
+        static int bucketOf(uint64_t value) {
+            if (value < (uint64_t)_SUB_BUCKETS) {
+                return (int)value;
+            }
+            int exponent = 63 - __builtin_clzll(value);
+            return (exponent - 3) * _SUB_BUCKETS + (int)((value >> (exponent - 4)) & (_SUB_BUCKETS - 1));
+        }
+        // smallest value that falls in bucket
+        static uint64_t bucketStart(int bucket);
+
+    public:
+        Histogram();
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+        void record(uint64_t value) {
+            Shard& shard = _shards[currentMetricShard()];
+            shard.buckets[bucketOf(value)].fetch_add(1, memory_order_relaxed);
+            shard.sum.fetch_add(value, memory_order_relaxed);
+        }
+
+        // snapshot of all shards: per-bucket counts, total count and sum
+        void collect(vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum) const;
+        uint64_t getCount() const;
+        // value at quantile q (0-1), the start of the bucket it falls in; 0 if nothing was recorded
+        uint64_t getQuantile(double q) const;
+
+        friend class MetricsRegistry;
+};
+
+// LatencyTimer: records the nanoseconds from construction to the end of the scope into a histogram
+class LatencyTimer {
+    private:
+        Histogram& _histogram;
+        int64_t _start;
+
+    public:
+        LatencyTimer(Histogram& histogram) : _histogram(histogram), _start(metricsNow()) {
+        }
+        ~LatencyTimer() {
+            _histogram.record(metricsNow() - _start);
+        }
+};
+
+// MetricsRegistry: named metrics (with optional Prometheus labels, e.g. color="blue")
+// Register at startup; metrics sharing a name must be registered one after another so the exposition
+// groups them under one HELP/TYPE header. Metrics live as long as the registry.
+class MetricsRegistry {
+    private:
+        struct Entry {
+            string name;
+            string help;
+            string labels;
+            unique_ptr<Counter> counter;        // one of the two is set
+            unique_ptr<Histogram> histogram;
+        };
+
+        mutable mutex _lock;
+        vector<unique_ptr<Entry>> _entries;
+
+    public:
+        Counter& addCounter(const string& name, const string& help, const string& labels = "");
+        Histogram& addHistogram(const string& name, const string& help, const string& labels = "");
+
+        // Prometheus text exposition format (version 0.0.4); histograms get cumulative buckets at powers of two
+        void writePrometheus(ostream& out) const;
+};
+
+// the process-wide registry the game's metrics are registered in
+MetricsRegistry& getMetricsRegistry();
+
+// MetricsExporter: background thread that serves the registry in Prometheus text format
+// on a Unix socket (any request gets one HTTP/1.0 response, so curl --unix-socket and Prometheus
+// through a socket proxy both work) and/or rewrites a file every interval (temp file + rename).
+class MetricsExporter {
+    private:
+        MetricsRegistry& _registry;
+        string _socket_path;
+        string _filename;
+        int _interval_ms;
+        int _listen_fd;
+        int _wake_fd;
+        thread _thread;
+
+        void serveClient(int fd);
+        bool writeFile();
+        void run();
+
+    public:
+        MetricsExporter(MetricsRegistry& registry);
+        ~MetricsExporter();
+        MetricsExporter(const MetricsExporter&) = delete;
+        MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+        // serve scrapes on this Unix socket path (replaces a stale socket file), false if it can't bind
+        bool listenOn(const string& socketPath);
+        // also write the metrics to filename every interval_ms
+        void setFile(const string& filename, int intervalMs);
+        // start the thread (after listenOn / setFile)
+        bool start();
+        // stop the thread, write the file one last time, remove the socket
+        void stop();
+};
+
+#endif
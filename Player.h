@@ -2,6 +2,7 @@
 #define PLAYER_H
 
 #include <string>
+#include <utility>
 
 using namespace std;
 
@@ -19,7 +20,7 @@ private:
 
 public:
     Player(string name, int exp, int acc, int eff, int ins, int dp) {
-        characterName = name;
+        characterName = move(name);
         experience = exp;
         accuracy = acc;
         efficiency = eff;
@@ -42,44 +43,44 @@ public:
         advisor = 0;      
     }
 
-    string getCharacterName() {
+    const string& getCharacterName() const {
         return characterName;
     }
 
-    int getExperience() {
+    int getExperience() const {
         return experience;
     }
 
-    int getAccuracy() {
+    int getAccuracy() const {
         return accuracy;
     }
 
-    int getEfficiency() {
+    int getEfficiency() const {
         return efficiency;
     }
 
-    int getInsight() {
+    int getInsight() const {
         return insight;
     }
 
-    int getDiscoverPoints() {
+    int getDiscoverPoints() const {
         return discoverPoints;
     }
 
-    int getPosition() {
+    int getPosition() const {
         return position;
     }
 
-    int getPathType() {
+    int getPathType() const {
         return pathType;
     }
 
-    int getAdvisor() {
+    int getAdvisor() const {
         return advisor;
     }
     
     void setCharacterName(string name) {
-        characterName = name;
+        characterName = move(name);
     }
 
     void updateExperience(int change) {
@@ -102,13 +103,17 @@ public:
         discoverPoints = discoverPoints + change;
     }
 
-    void updatePosition(int steps) {
+    void updatePosition(int steps, int finishPosition = 51) {
         position = position + steps;
-        if (position > 51) { 
-            position = 51; 
+        if (position > finishPosition) { 
+            position = finishPosition; 
         }
     }
 
+    void setPosition(int pos) {
+        position = pos;
+    }
+
     void setPathType(int path) {
         pathType = path;
     }
@@ -0,0 +1,202 @@
+#include "ProcessSweep.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+static_assert(atomic<long long>::is_always_lock_free, "shared-memory stats need lock-free (address-free) atomics");
+
+static const int MAX_ATTEMPTS = 3;
+
+// one worker's part of the shared mapping (finished is set last, after every stat is written)
+struct SweepSlot {
+    SweepStats stats;
+    atomic<int> finished{0};
+};
+
+// the whole shared mapping: the merged total (a SweepStats) at the start, then one SweepSlot per range from
+// SLOTS_OFFSET (the total's size rounded up to a slot's alignment)
+static const size_t SLOTS_OFFSET = (sizeof(SweepStats) + alignof(SweepSlot) - 1) / alignof(SweepSlot) * alignof(SweepSlot);
+
+// add to the score's bucket, negative scores go in the first and very high ones in the last
+void SweepStats::recordScore(int score) {
+    int bucket = score < 0 ? 0 : score / SWEEP_SCORE_BUCKET_WIDTH;
+    if (bucket >= SWEEP_SCORE_BUCKETS) {
+        bucket = SWEEP_SCORE_BUCKETS - 1;
+    }
+    scores[bucket].fetch_add(1, memory_order_relaxed);
+}
+
+void SweepStats::add(const SweepStats& other) {
+    games.fetch_add(other.games.load(memory_order_relaxed), memory_order_relaxed);
+    turns.fetch_add(other.turns.load(memory_order_relaxed), memory_order_relaxed);
+    ties.fetch_add(other.ties.load(memory_order_relaxed), memory_order_relaxed);
+    for (int i = 0; i < SWEEP_MAX_PLAYERS; i++) {
+        wins[i].fetch_add(other.wins[i].load(memory_order_relaxed), memory_order_relaxed);
+    }
+    for (int i = 0; i < SWEEP_SCORE_BUCKETS; i++) {
+        scores[i].fetch_add(other.scores[i].load(memory_order_relaxed), memory_order_relaxed);
+    }
+    for (int i = 0; i < TILE_CODE_COUNT; i++) {
+        landings[i].fetch_add(other.landings[i].load(memory_order_relaxed), memory_order_relaxed);
+        tasksPassed[i].fetch_add(other.tasksPassed[i].load(memory_order_relaxed), memory_order_relaxed);
+        tasksFailed[i].fetch_add(other.tasksFailed[i].load(memory_order_relaxed), memory_order_relaxed);
+    }
+}
+
+void SweepStats::clear() {
+    games.store(0, memory_order_relaxed);
+    turns.store(0, memory_order_relaxed);
+    ties.store(0, memory_order_relaxed);
+    for (int i = 0; i < SWEEP_MAX_PLAYERS; i++) {
+        wins[i].store(0, memory_order_relaxed);
+    }
+    for (int i = 0; i < SWEEP_SCORE_BUCKETS; i++) {
+        scores[i].store(0, memory_order_relaxed);
+    }
+    for (int i = 0; i < TILE_CODE_COUNT; i++) {
+        landings[i].store(0, memory_order_relaxed);
+        tasksPassed[i].store(0, memory_order_relaxed);
+        tasksFailed[i].store(0, memory_order_relaxed);
+    }
+}
+
+// walk the buckets until the running count passes fraction of the total
+int SweepStats::scoreQuantile(double fraction) const {
+    long long count = 0;
+    for (int i = 0; i < SWEEP_SCORE_BUCKETS; i++) {
+        count += scores[i].load(memory_order_relaxed);
+    }
+    long long seen = 0;
+    for (int i = 0; i < SWEEP_SCORE_BUCKETS; i++) {
+        seen += scores[i].load(memory_order_relaxed);
+        if (count > 0 && seen >= fraction * count) {
+            return i * SWEEP_SCORE_BUCKET_WIDTH;
+        }
+    }
+    return 0;
+}
+
+// child: clear the slot, play the range into it, mark it finished; never returns
+static void runSweepWorker(SweepSlot& slot, long long begin, long long end,
+                           const function<void(long long, long long, SweepStats&)>& playRange) {
+    slot.stats.clear();
+    slot.finished.store(0, memory_order_relaxed);
+    playRange(begin, end, slot.stats);
+    slot.finished.store(1, memory_order_release);
+    // _exit: no atexit handlers or stream flushes that belong to the coordinator
+    _exit(0);
+}
+
+// fork a worker for range, -1 if fork failed
+static pid_t startSweepWorker(SweepSlot& slot, long long begin, long long end,
+                              const function<void(long long, long long, SweepStats&)>& playRange) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        runSweepWorker(slot, begin, end, playRange);
+    }
+    return pid;
+}
+
+// map the region, split games into ranges, fork one worker per range, wait for each, merge or rerun
+bool runProcessSweep(int processes, long long games, const function<void(long long, long long, SweepStats&)>& playRange,
+                     SweepStats& total, int& reruns, ostream& log) {
+    if (processes < 1) {
+        processes = 1;
+    }
+    if (processes > games) {
+        processes = games > 0 ? games : 1;
+    }
+    size_t regionSize = SLOTS_OFFSET + processes * sizeof(SweepSlot);
+    void* memory = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        log << "Error: Could not map " << regionSize << " bytes of shared memory for the sweep." << endl;
+        return false;
+    }
+    SweepStats* merged = new (memory) SweepStats();
+    SweepSlot* slots = (SweepSlot*)((char*)memory + SLOTS_OFFSET);
+    for (int i = 0; i < processes; i++) {
+        new (&slots[i]) SweepSlot();
+    }
+
+    // range i is games [begins[i], begins[i + 1])
+    vector<long long> begins(processes + 1);
+    for (int i = 0; i <= processes; i++) {
+        begins[i] = games * i / processes;
+    }
+    vector<pid_t> workers(processes, -1);
+    vector<int> attempts(processes, 0);
+    bool success = true;
+    int running = 0;
+
+    log.flush();
+    for (int i = 0; i < processes; i++) {
+        workers[i] = startSweepWorker(slots[i], begins[i], begins[i + 1], playRange);
+        attempts[i] = 1;
+        if (workers[i] < 0) {
+            log << "Error: Could not fork a worker for games " << begins[i] << "-" << begins[i + 1] - 1 << "." << endl;
+            success = false;
+        } else {
+            running++;
+        }
+    }
+
+    while (running > 0) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        int i = 0;
+        while (i < processes && workers[i] != pid) {
+            i++;
+        }
+        if (i == processes) {
+            continue;
+        }
+        running--;
+        workers[i] = -1;
+        SweepSlot& slot = slots[i];
+
+        bool exitedCleanly = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (exitedCleanly && slot.finished.load(memory_order_acquire) == 1) {
+            merged->add(slot.stats);
+            continue;
+        }
+
+        log << "Warning: The worker for games " << begins[i] << "-" << begins[i + 1] - 1;
+        if (WIFSIGNALED(status)) {
+            log << " was killed by signal " << WTERMSIG(status);
+        } else {
+            log << " exited with status " << WEXITSTATUS(status);
+        }
+        if (attempts[i] >= MAX_ATTEMPTS) {
+            log << ". Giving up on the range after " << attempts[i] << " attempts." << endl;
+            success = false;
+            continue;
+        }
+        log << ". Running the range again." << endl;
+        log.flush();
+        attempts[i]++;
+        reruns++;
+        workers[i] = startSweepWorker(slot, begins[i], begins[i + 1], playRange);
+        if (workers[i] < 0) {
+            log << "Error: Could not fork a worker for games " << begins[i] << "-" << begins[i + 1] - 1 << "." << endl;
+            success = false;
+        } else {
+            running++;
+        }
+    }
+
+    total.add(*merged);
+    munmap(memory, regionSize);
+    return success;
+}
@@ -0,0 +1,46 @@
+#ifndef PROCESSSWEEP_H
+#define PROCESSSWEEP_H
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include "Board.h"
+
+using namespace std;
+
+static const int SWEEP_MAX_PLAYERS = 16;
+static const int SWEEP_SCORE_BUCKETS = 128;
+static const int SWEEP_SCORE_BUCKET_WIDTH = 1000;     // bucket b holds final scores in [b * width, (b + 1) * width), the last one everything above
+
+// SweepStats: what a range of games added up to
+// Every field is a lock-free atomic, so a copy placed in shared memory can be written by one worker process
+// and read (or merged into) by the coordinator at the same time without locks.
+struct SweepStats {
+    atomic<long long> games{0};
+    atomic<long long> turns{0};
+    atomic<long long> wins[SWEEP_MAX_PLAYERS] = {};         // games won outright, by seat
+    atomic<long long> ties{0};                              // games where two or more seats share the top score
+    atomic<long long> scores[SWEEP_SCORE_BUCKETS] = {};     // calculateFinalDiscoverPoints of every player
+    atomic<long long> landings[TILE_CODE_COUNT] = {};       // tile landings per color
+    atomic<long long> tasksPassed[TILE_CODE_COUNT] = {};    // DNA task results per tile color
+    atomic<long long> tasksFailed[TILE_CODE_COUNT] = {};
+
+    // add a final score to its bucket
+    void recordScore(int score);
+    // add every field of other (relaxed, other may still be changing)
+    void add(const SweepStats& other);
+    void clear();
+    // lowest score of the bucket holding the given fraction of all scores
+    int scoreQuantile(double fraction) const;
+};
+
+// fork one worker process per range of games (processes ranges of about games / processes each); worker i runs
+// playRange(begin, end, stats) into its own SweepStats in a shared anonymous mapping and exits. The coordinator
+// merges each finished worker's stats into a shared total in place, and forks a fresh worker for a range whose
+// worker crashed or exited with an error (its partial stats are dropped), up to 3 times per range.
+// Adds the total to total and the number of reruns to reruns; false if a range failed every attempt or
+// a process couldn't be forked (errors reported to log). Call it with no other threads running.
+bool runProcessSweep(int processes, long long games, const function<void(long long, long long, SweepStats&)>& playRange,
+                     SweepStats& total, int& reruns, ostream& log);
+
+#endif
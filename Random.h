@@ -0,0 +1,41 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Random class: small, fast random number generator (xorshift64*)
+// Used instead of rand() where many values are needed at once (board generation)
+// The whole state is a single 64-bit number, so it is cheap to copy and store
+class Random {
+    private:
+        uint64_t _state;
+
+    public:
+        // Seed the generator (a zero seed is replaced, xorshift can't leave zero)
+        Random(uint64_t seed = 0x9E3779B97F4A7C15ULL) {
+            setState(seed);
+        }
+
+        // Next raw 64-bit value
+        uint64_t next() {
+            _state ^= _state >> 12;
+            _state ^= _state << 25;
+            _state ^= _state >> 27;
+            return _state * 0x2545F4914F6CDD1DULL;
+        }
+
+        // Random int in [0, bound), multiply-shift instead of % so there is no division
+        int nextInt(int bound) {
+            return (int)(((next() >> 32) * (uint64_t)bound) >> 32);
+        }
+
+        uint64_t getState() const {
+            return _state;
+        }
+
+        void setState(uint64_t state) {
+            _state = (state == 0) ? 0x9E3779B97F4A7C15ULL : state;
+        }
+};
+
+#endif
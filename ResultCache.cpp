@@ -0,0 +1,252 @@
+#include "ResultCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+// cache file: magic, version, entry count, then per entry key, index, value, text length, text
+static const char CACHE_MAGIC[4] = {'J', 'T', 'G', 'R'};
+static const uint32_t CACHE_VERSION = 1;
+
+// odd 64-bit constants with well-spread bits (the wyhash secrets)
+static const uint64_t HASH_K0 = 0xA0761D6478BD642FULL;
+static const uint64_t HASH_K1 = 0xE7037ED1A0B428DBULL;
+static const uint64_t HASH_K2 = 0x8EBC6AF09C88C6E3ULL;
+static const uint64_t HASH_K3 = 0x589965CC75374CC3ULL;
+
+// full 128-bit product folded to 64 bits: every input bit reaches every output bit
+static inline uint64_t mixMultiply(uint64_t a, uint64_t b) {
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static ResultCache* activeCache = nullptr;
+
+Hash128 hashStart(uint64_t seed) {
+    Hash128 hash;
+    hash.low = mixMultiply(seed ^ HASH_K0, HASH_K1);
+    hash.high = mixMultiply(seed ^ HASH_K2, HASH_K3);
+    return hash;
+}
+
+// 16 bytes per step into both lanes, then the zero-padded tail together with the length
+void hashAppend(Hash128& hash, string_view data) {
+    const char* p = data.data();
+    size_t remaining = data.size();
+    uint64_t w0, w1;
+    while (remaining >= 16) {
+        memcpy(&w0, p, 8);
+        memcpy(&w1, p + 8, 8);
+        uint64_t low = mixMultiply(w0 ^ HASH_K0 ^ hash.low, w1 ^ HASH_K1);
+        hash.high = mixMultiply(w1 ^ HASH_K2 ^ hash.high, w0 ^ HASH_K3);
+        hash.low = low;
+        p += 16;
+        remaining -= 16;
+    }
+    unsigned char tail[16] = {0};
+    memcpy(tail, p, remaining);
+    memcpy(&w0, tail, 8);
+    memcpy(&w1, tail + 8, 8);
+    uint64_t length = data.size();
+    uint64_t low = mixMultiply(w0 ^ HASH_K0 ^ hash.low, w1 ^ HASH_K1 ^ length);
+    hash.high = mixMultiply(w1 ^ HASH_K2 ^ hash.high, w0 ^ HASH_K3 ^ length);
+    hash.low = low;
+}
+
+// lanes are cross-mixed at the end so a difference in one lane shows up in both
+Hash128 hashTask(int task, string_view strand1, string_view strand2) {
+    Hash128 hash = hashStart(task);
+    hashAppend(hash, strand1);
+    hashAppend(hash, strand2);
+    uint64_t low = mixMultiply(hash.low ^ HASH_K1, hash.high ^ HASH_K2);
+    hash.high = mixMultiply(hash.high ^ HASH_K3, hash.low ^ HASH_K0);
+    hash.low = low;
+    return hash;
+}
+
+void setResultCache(ResultCache* cache) {
+    activeCache = cache;
+}
+
+ResultCache* getResultCache() {
+    return activeCache;
+}
+
+// CONSTRUCTORS
+
+ResultCache::ResultCache(size_t memoryBudget) : _shards(new Shard[_SHARDS]) {
+    _shard_budget = memoryBudget / _SHARDS;
+    for (int i = 0; i < _SHARDS; i++) {
+        _shards[i].bytes = 0;
+    }
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+// list node (entry + two pointers) plus an index node (key, iterator, next pointer, cached hash) and its bucket
+size_t ResultCache::entryBytes(const CachedResult& result) {
+    return sizeof(Entry) + 2 * sizeof(void*) + sizeof(Hash128) + 4 * sizeof(void*) + result.text.capacity();
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+// find, move to the front of the shard's LRU list, copy out
+bool ResultCache::lookup(const Hash128& key, CachedResult& result) {
+    Shard& shard = shardFor(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto found = shard.index.find(key);
+    if (found == shard.index.end()) {
+        _misses.add();
+        return false;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+    const CachedResult& cached = found->second->result;
+    result.index = cached.index;
+    result.value = cached.value;
+    result.text.assign(cached.text);
+    _hits.add();
+    return true;
+}
+
+// replace in place or insert at the front, then evict from the back while over budget (never the new entry)
+void ResultCache::store(const Hash128& key, const CachedResult& result) {
+    Shard& shard = shardFor(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        shard.bytes -= entryBytes(found->second->result);
+        found->second->result = result;
+        shard.bytes += entryBytes(found->second->result);
+        shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+    } else {
+        shard.entries.push_front(Entry{key, result});
+        shard.index.emplace(key, shard.entries.begin());
+        shard.bytes += entryBytes(result);
+    }
+
+    while (shard.bytes > _shard_budget && shard.entries.size() > 1) {
+        Entry& oldest = shard.entries.back();
+        shard.bytes -= entryBytes(oldest.result);
+        shard.index.erase(oldest.key);
+        shard.entries.pop_back();
+        _evictions.add();
+    }
+}
+
+uint64_t ResultCache::getHits() const {
+    return _hits.getValue();
+}
+
+uint64_t ResultCache::getMisses() const {
+    return _misses.getValue();
+}
+
+uint64_t ResultCache::getEvictions() const {
+    return _evictions.getValue();
+}
+
+size_t ResultCache::getEntryCount() {
+    size_t count = 0;
+    for (int i = 0; i < _SHARDS; i++) {
+        lock_guard<mutex> guard(_shards[i].lock);
+        count += _shards[i].entries.size();
+    }
+    return count;
+}
+
+size_t ResultCache::getBytes() {
+    size_t bytes = 0;
+    for (int i = 0; i < _SHARDS; i++) {
+        lock_guard<mutex> guard(_shards[i].lock);
+        bytes += _shards[i].bytes;
+    }
+    return bytes;
+}
+
+// serialize shard by shard (one lock at a time), least recently used first, then temp file + rename
+bool ResultCache::save(const string& filename) {
+    vector<char> buffer(sizeof(CACHE_MAGIC) + 2 * sizeof(uint32_t) + sizeof(uint64_t));
+    uint64_t count = 0;
+    for (int i = 0; i < _SHARDS; i++) {
+        lock_guard<mutex> guard(_shards[i].lock);
+        for (auto it = _shards[i].entries.rbegin(); it != _shards[i].entries.rend(); ++it) {
+            int32_t index = it->result.index;
+            uint32_t length = it->result.text.size();
+            size_t at = buffer.size();
+            buffer.resize(at + sizeof(Hash128) + sizeof(index) + sizeof(double) + sizeof(length) + length);
+            char* p = buffer.data() + at;
+            memcpy(p, &it->key, sizeof(Hash128));
+            p += sizeof(Hash128);
+            memcpy(p, &index, sizeof(index));
+            p += sizeof(index);
+            memcpy(p, &it->result.value, sizeof(double));
+            p += sizeof(double);
+            memcpy(p, &length, sizeof(length));
+            p += sizeof(length);
+            memcpy(p, it->result.text.data(), length);
+            count++;
+        }
+    }
+    uint32_t reserved = 0;
+    memcpy(buffer.data(), CACHE_MAGIC, 4);
+    memcpy(buffer.data() + 4, &CACHE_VERSION, 4);
+    memcpy(buffer.data() + 8, &reserved, 4);
+    memcpy(buffer.data() + 12, &count, 8);
+
+    string tempName = filename + ".tmp";
+    ofstream file(tempName, ios::binary | ios::trunc);
+    if (!file.write(buffer.data(), buffer.size()) || !file.flush()) {
+        file.close();
+        remove(tempName.c_str());
+        return false;
+    }
+    file.close();
+    if (rename(tempName.c_str(), filename.c_str()) != 0) {
+        remove(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// check the header, then store entries until the count is reached or the file ends early
+bool ResultCache::load(const string& filename) {
+    ifstream file(filename, ios::binary);
+    char header[20];
+    if (!file.read(header, sizeof(header))) {
+        return false;
+    }
+    uint32_t version;
+    uint64_t count;
+    memcpy(&version, header + 4, 4);
+    memcpy(&count, header + 12, 8);
+    if (memcmp(header, CACHE_MAGIC, 4) != 0 || version != CACHE_VERSION) {
+        return false;
+    }
+    // a text length is only believed if that many bytes are left in the file
+    file.seekg(0, ios::end);
+    uint64_t fileSize = file.tellg();
+    file.seekg(sizeof(header));
+
+    CachedResult result;
+    for (uint64_t i = 0; i < count; i++) {
+        Hash128 key;
+        int32_t index;
+        uint32_t length;
+        if (!file.read((char*)&key, sizeof(key)) || !file.read((char*)&index, sizeof(index)) ||
+            !file.read((char*)&result.value, sizeof(double)) || !file.read((char*)&length, sizeof(length))) {
+            break;
+        }
+        if (length > fileSize - (uint64_t)file.tellg()) {
+            break;
+        }
+        result.index = index;
+        result.text.resize(length);
+        if (length > 0 && !file.read(&result.text[0], length)) {
+            break;
+        }
+        store(key, result);
+    }
+    return true;
+}
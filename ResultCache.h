@@ -0,0 +1,109 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Metrics.h"
+
+using namespace std;
+
+// 128-bit hash of a sequence of strings (each string's length is mixed in, so ("ab", "c") != ("a", "bc"))
+// Two 64-bit lanes, 16 bytes per step, each step one 64x64->128 multiply per lane (well under 0.1 ns per byte)
+struct Hash128 {
+    uint64_t low;
+    uint64_t high;
+
+    bool operator==(const Hash128& other) const {
+        return low == other.low && high == other.high;
+    }
+};
+
+struct Hash128Hasher {
+    size_t operator()(const Hash128& hash) const {
+        return hash.low;
+    }
+};
+
+Hash128 hashStart(uint64_t seed);
+void hashAppend(Hash128& hash, string_view data);
+Hash128 hashTask(int task, string_view strand1, string_view strand2);
+
+// DNA tasks whose results are cached (the task number is part of the key)
+enum CachedTask {
+    CACHED_BEST_MATCH = 1,      // pink task: best index and similarity at that index
+    CACHED_MUTATIONS = 2        // red task: identifyMutations output
+};
+
+// what a task produced
+struct CachedResult {
+    int index;
+    double value;
+    string text;
+};
+
+// ResultCache: LRU cache of DNA task results keyed by the 128-bit hash of (task, strand1, strand2)
+// Keys are split over shards by hash, each with its own lock, LRU list and share of the memory budget,
+// so games on different threads rarely wait on each other. The strands themselves aren't stored: two
+// different inputs would need the same 128-bit hash to collide.
+// Optionally saved to and loaded from a file (temp file + rename), so a restarted server starts warm.
+class ResultCache {
+    private:
+        static const int _SHARDS = 16;
+
+        struct Entry {
+            Hash128 key;
+            CachedResult result;
+        };
+
+        struct Shard {
+            mutex lock;
+            list<Entry> entries;        // most recently used first
+            unordered_map<Hash128, list<Entry>::iterator, Hash128Hasher> index;
+            size_t bytes;
+        };
+
+        unique_ptr<Shard[]> _shards;
+        size_t _shard_budget;
+        Counter _hits;
+        Counter _misses;
+        Counter _evictions;
+
+        Shard& shardFor(const Hash128& key) {
+            return _shards[key.high % _SHARDS];
+        }
+        // memory an entry takes, node and index slot included
+        static size_t entryBytes(const CachedResult& result);
+
+    public:
+        ResultCache(size_t memoryBudget);
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        // copy the cached result into result (text reuses its buffer), false on a miss
+        bool lookup(const Hash128& key, CachedResult& result);
+        // add or replace, evicting least recently used entries of the shard until it fits its budget
+        void store(const Hash128& key, const CachedResult& result);
+
+        uint64_t getHits() const;
+        uint64_t getMisses() const;
+        uint64_t getEvictions() const;
+        size_t getEntryCount();
+        size_t getBytes();
+
+        // every entry, most recently used last so a load keeps the order; false if the file can't be written
+        bool save(const string& filename);
+        // add the entries of a saved cache, false if the file is missing or not a cache file
+        bool load(const string& filename);
+};
+
+// cache used by the DNA tasks (nullptr = no caching, the default; turns then don't allocate)
+void setResultCache(ResultCache* cache);
+ResultCache* getResultCache();
+
+#endif
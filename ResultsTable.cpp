@@ -0,0 +1,548 @@
+#include "ResultsTable.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+using namespace std;
+
+static const char* const COLUMN_NAMES[RESULT_COLUMN_COUNT] = {
+    "game_id", "finished_at", "player", "character", "path_type", "advisor", "won",
+    "experience", "accuracy", "efficiency", "insight", "position", "discovery_points", "final_discovery_points"
+};
+static const int COLUMN_WIDTHS[RESULT_COLUMN_COUNT] = {8, 8, 1, 1, 1, 1, 1, 4, 4, 4, 4, 4, 4, 4};
+static const char ROW_GROUP_MAGIC[4] = {'R', 'G', 'R', 'P'};
+static const int CHUNK_ROWS = 1024;
+
+// row group header as stored in the file
+struct RowGroupHeader {
+    char magic[4];
+    uint32_t rows;
+    uint32_t nameCount;
+    uint32_t nameBytes;             // including padding to 8 bytes
+    int64_t minimum[RESULT_COLUMN_COUNT];
+    int64_t maximum[RESULT_COLUMN_COUNT];
+};
+
+// what the zone map says about a condition in one row group
+enum ZoneResult {
+    ZONE_NONE,      // no row can match
+    ZONE_ALL,       // every row matches
+    ZONE_SOME
+};
+
+static size_t padded(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+int findResultsColumn(const string& name) {
+    for (int i = 0; i < RESULT_COLUMN_COUNT; i++) {
+        if (name == COLUMN_NAMES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* getResultsColumnName(int column) {
+    return COLUMN_NAMES[column];
+}
+
+int getResultsColumnWidth(int column) {
+    return COLUMN_WIDTHS[column];
+}
+
+// RESULTS COLUMNS
+
+ResultsColumns::ResultsColumns() {
+    for (int i = 0; i < 2; i++) {
+        _int64[i].reserve(RESULTS_ROW_GROUP_ROWS);
+    }
+    for (int i = 0; i < 5; i++) {
+        _uint8[i].reserve(RESULTS_ROW_GROUP_ROWS);
+    }
+    for (int i = 0; i < 7; i++) {
+        _int32[i].reserve(RESULTS_ROW_GROUP_ROWS);
+    }
+    _names.reserve(255);
+}
+
+// find or add the character's code, then one value per column
+bool ResultsColumns::add(const StatsRecord& record) {
+    int code = 0;
+    while (code < (int)_names.size() && _names[code] != record.characterName) {
+        code++;
+    }
+    if (code == (int)_names.size()) {
+        if (code == 255) {
+            return false;
+        }
+        _names.push_back(record.characterName);
+    }
+
+    _int64[0].push_back(record.gameId);
+    _int64[1].push_back(record.finishedAt);
+    _uint8[0].push_back(record.playerNumber);
+    _uint8[1].push_back(code);
+    _uint8[2].push_back(record.pathType);
+    _uint8[3].push_back(record.advisor);
+    _uint8[4].push_back(record.won);
+    _int32[0].push_back(record.experience);
+    _int32[1].push_back(record.accuracy);
+    _int32[2].push_back(record.efficiency);
+    _int32[3].push_back(record.insight);
+    _int32[4].push_back(record.position);
+    _int32[5].push_back(record.discoverPoints);
+    _int32[6].push_back(record.finalDiscoverPoints);
+    return true;
+}
+
+int ResultsColumns::size() const {
+    return _int64[0].size();
+}
+
+bool ResultsColumns::isFull() const {
+    return size() >= RESULTS_ROW_GROUP_ROWS;
+}
+
+void ResultsColumns::clear() {
+    for (int i = 0; i < 2; i++) {
+        _int64[i].clear();
+    }
+    for (int i = 0; i < 5; i++) {
+        _uint8[i].clear();
+    }
+    for (int i = 0; i < 7; i++) {
+        _int32[i].clear();
+    }
+    _names.clear();
+}
+
+template <typename T>
+static void appendColumn(const vector<T>& values, int64_t& minimum, int64_t& maximum, string& block) {
+    minimum = values.empty() ? 0 : *min_element(values.begin(), values.end());
+    maximum = values.empty() ? 0 : *max_element(values.begin(), values.end());
+    block.append((const char*)values.data(), values.size() * sizeof(T));
+    block.append(padded(block.size()) - block.size(), '\0');
+}
+
+size_t ResultsColumns::getMaxEncodedSize() {
+    size_t size = sizeof(RowGroupHeader) + padded(255 * 256);
+    for (int c = 0; c < RESULT_COLUMN_COUNT; c++) {
+        size += padded((size_t)RESULTS_ROW_GROUP_ROWS * COLUMN_WIDTHS[c]);
+    }
+    return size;
+}
+
+// header (zone map filled in once the columns are written), names, columns
+void ResultsColumns::encode(string& block) const {
+    size_t start = block.size();
+    RowGroupHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROW_GROUP_MAGIC, 4);
+    header.rows = size();
+    header.nameCount = _names.size();
+    block.append(sizeof(header), '\0');
+
+    size_t namesStart = block.size();
+    for (const string& name : _names) {
+        block.push_back((char)min(name.size(), (size_t)255));
+        block.append(name, 0, 255);
+    }
+    block.append(padded(block.size()) - block.size(), '\0');
+    header.nameBytes = block.size() - namesStart;
+
+    int column = 0;
+    for (int i = 0; i < 2; i++, column++) {
+        appendColumn(_int64[i], header.minimum[column], header.maximum[column], block);
+    }
+    for (int i = 0; i < 5; i++, column++) {
+        appendColumn(_uint8[i], header.minimum[column], header.maximum[column], block);
+    }
+    for (int i = 0; i < 7; i++, column++) {
+        appendColumn(_int32[i], header.minimum[column], header.maximum[column], block);
+    }
+    memcpy(&block[start], &header, sizeof(header));
+}
+
+// RESULTS TABLE
+
+ResultsTable::ResultsTable() {
+    _rows = 0;
+    _truncated = false;
+}
+
+// check the magic, then walk the row groups, merging their character names
+bool ResultsTable::open(const string& filename) {
+    _groups.clear();
+    _character_names.clear();
+    _rows = 0;
+    _truncated = false;
+    if (!_file.open(filename)) {
+        return false;
+    }
+    const char* data = _file.data();
+    size_t size = _file.size();
+    if (size < sizeof(RESULTS_FILE_MAGIC) || memcmp(data, RESULTS_FILE_MAGIC, sizeof(RESULTS_FILE_MAGIC)) != 0) {
+        return false;
+    }
+
+    size_t at = sizeof(RESULTS_FILE_MAGIC);
+    while (at < size) {
+        RowGroupHeader header;
+        if (size - at < sizeof(header)) {
+            _truncated = true;
+            break;
+        }
+        memcpy(&header, data + at, sizeof(header));
+        size_t columnBytes = 0;
+        for (int c = 0; c < RESULT_COLUMN_COUNT; c++) {
+            columnBytes += padded((size_t)header.rows * COLUMN_WIDTHS[c]);
+        }
+        if (memcmp(header.magic, ROW_GROUP_MAGIC, 4) != 0 || header.nameCount > 255 ||
+            size - at - sizeof(header) < (size_t)header.nameBytes + columnBytes) {
+            _truncated = true;
+            break;
+        }
+
+        RowGroup group;
+        group.rows = header.rows;
+        memcpy(group.minimum, header.minimum, sizeof(group.minimum));
+        memcpy(group.maximum, header.maximum, sizeof(group.maximum));
+        memset(group.characterCodes, 0, sizeof(group.characterCodes));
+
+        const char* names = data + at + sizeof(header);
+        const char* namesEnd = names + header.nameBytes;
+        for (uint32_t i = 0; i < header.nameCount && names < namesEnd; i++) {
+            int length = (uint8_t)*names++;
+            string name(names, min((size_t)length, (size_t)(namesEnd - names)));
+            names += length;
+            int index = findCharacter(name);
+            if (index < 0) {
+                if (_character_names.size() == 256) {
+                    return false;
+                }
+                index = _character_names.size();
+                _character_names.push_back(name);
+            }
+            group.characterCodes[i] = index;
+        }
+
+        const char* column = data + at + sizeof(header) + header.nameBytes;
+        for (int c = 0; c < RESULT_COLUMN_COUNT; c++) {
+            group.columns[c] = column;
+            column += padded((size_t)header.rows * COLUMN_WIDTHS[c]);
+        }
+        _groups.push_back(group);
+        _rows += header.rows;
+        at = column - data;
+    }
+    return true;
+}
+
+const vector<ResultsTable::RowGroup>& ResultsTable::getRowGroups() const {
+    return _groups;
+}
+
+const vector<string>& ResultsTable::getCharacterNames() const {
+    return _character_names;
+}
+
+int ResultsTable::findCharacter(const string& name) const {
+    for (int i = 0; i < (int)_character_names.size(); i++) {
+        if (_character_names[i] == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+long long ResultsTable::getRowCount() const {
+    return _rows;
+}
+
+bool ResultsTable::isTruncated() const {
+    return _truncated;
+}
+
+// QUERIES
+
+// split at the operator, look up the column, parse the value (a name for character)
+bool parseResultsFilter(const string& text, const ResultsTable& table, ResultsFilter& filter, string& error) {
+    size_t opStart = text.find_first_of("!<>=");
+    if (opStart == string::npos || opStart == 0) {
+        error = "expected COLUMN=VALUE (or !=, <, <=, >, >=) in '" + text + "'";
+        return false;
+    }
+    size_t opEnd = opStart + 1;
+    if (opEnd < text.size() && text[opEnd] == '=') {
+        opEnd++;
+    }
+    string op = text.substr(opStart, opEnd - opStart);
+    string name = text.substr(0, opStart);
+    string value = text.substr(opEnd);
+
+    filter.column = findResultsColumn(name);
+    if (filter.column < 0) {
+        error = "unknown column '" + name + "'";
+        return false;
+    }
+    if (op == "=" || op == "==") {
+        filter.compare = COMPARE_EQUAL;
+    } else if (op == "!=") {
+        filter.compare = COMPARE_NOT_EQUAL;
+    } else if (op == "<") {
+        filter.compare = COMPARE_LESS;
+    } else if (op == "<=") {
+        filter.compare = COMPARE_LESS_EQUAL;
+    } else if (op == ">") {
+        filter.compare = COMPARE_GREATER;
+    } else if (op == ">=") {
+        filter.compare = COMPARE_GREATER_EQUAL;
+    } else {
+        error = "unknown operator '" + op + "'";
+        return false;
+    }
+
+    if (filter.column == RESULT_CHARACTER) {
+        if (filter.compare != COMPARE_EQUAL && filter.compare != COMPARE_NOT_EQUAL) {
+            error = "characters can only be compared with = or !=";
+            return false;
+        }
+        filter.value = table.findCharacter(value);
+        return true;
+    }
+    long long number;
+    from_chars_result parsed = from_chars(value.data(), value.data() + value.size(), number);
+    if (parsed.ec != errc() || parsed.ptr != value.data() + value.size()) {
+        error = "invalid number '" + value + "'";
+        return false;
+    }
+    filter.value = number;
+    return true;
+}
+
+bool checkResultsQuery(const ResultsQuery& query, string& error) {
+    if (query.groupBy.size() > 2) {
+        error = "at most two group-by columns";
+        return false;
+    }
+    for (int column : query.groupBy) {
+        if (column < 0 || column >= RESULT_COLUMN_COUNT || COLUMN_WIDTHS[column] != 1) {
+            error = "can only group by player, character, path_type, advisor or won";
+            return false;
+        }
+    }
+    if (query.valueColumn < 0 || query.valueColumn >= RESULT_COLUMN_COUNT) {
+        error = "unknown value column";
+        return false;
+    }
+    return true;
+}
+
+// can rows with values in [low, high] meet "value compare target"? none, all, or some of them
+static ZoneResult checkZone(int64_t low, int64_t high, int compare, int64_t target) {
+    switch (compare) {
+        case COMPARE_EQUAL:
+            if (target < low || target > high) return ZONE_NONE;
+            return low == high ? ZONE_ALL : ZONE_SOME;
+        case COMPARE_NOT_EQUAL:
+            if (target < low || target > high) return ZONE_ALL;
+            return low == high ? ZONE_NONE : ZONE_SOME;
+        case COMPARE_LESS:
+            if (low >= target) return ZONE_NONE;
+            return high < target ? ZONE_ALL : ZONE_SOME;
+        case COMPARE_LESS_EQUAL:
+            if (low > target) return ZONE_NONE;
+            return high <= target ? ZONE_ALL : ZONE_SOME;
+        case COMPARE_GREATER:
+            if (high <= target) return ZONE_NONE;
+            return low > target ? ZONE_ALL : ZONE_SOME;
+        default:
+            if (high < target) return ZONE_NONE;
+            return low >= target ? ZONE_ALL : ZONE_SOME;
+    }
+}
+
+// selected[i] &= (values[i] compare target); the zone check guarantees target fits in T
+template <typename T>
+static void filterChunk(const T* values, int compare, int64_t target, uint8_t* selected, int n) {
+    T value = (T)target;
+    switch (compare) {
+        case COMPARE_EQUAL:
+            for (int i = 0; i < n; i++) selected[i] &= values[i] == value;
+            break;
+        case COMPARE_NOT_EQUAL:
+            for (int i = 0; i < n; i++) selected[i] &= values[i] != value;
+            break;
+        case COMPARE_LESS:
+            for (int i = 0; i < n; i++) selected[i] &= values[i] < value;
+            break;
+        case COMPARE_LESS_EQUAL:
+            for (int i = 0; i < n; i++) selected[i] &= values[i] <= value;
+            break;
+        case COMPARE_GREATER:
+            for (int i = 0; i < n; i++) selected[i] &= values[i] > value;
+            break;
+        default:
+            for (int i = 0; i < n; i++) selected[i] &= values[i] >= value;
+            break;
+    }
+}
+
+// widen a chunk of any column to 64 bits
+static void loadChunk(const void* column, int width, int start, int n, int64_t* out) {
+    if (width == 1) {
+        const uint8_t* values = (const uint8_t*)column + start;
+        for (int i = 0; i < n; i++) out[i] = values[i];
+    } else if (width == 4) {
+        const int32_t* values = (const int32_t*)column + start;
+        for (int i = 0; i < n; i++) out[i] = values[i];
+    } else {
+        memcpy(out, (const int64_t*)column + start, n * sizeof(int64_t));
+    }
+}
+
+// per-row-group plan: the conditions left after the zone maps, in the group's own character codes
+struct ChunkFilter {
+    const void* column;
+    int width;
+    int compare;
+    int64_t value;
+};
+
+// plan each row group from its zone map, then filter and aggregate chunk by chunk
+void runResultsQuery(const ResultsTable& table, const ResultsQuery& query, ResultsQueryResult& result) {
+    result.groups.clear();
+    result.rowsScanned = 0;
+    result.rowGroupsSkipped = 0;
+
+    // one accumulator without group-by, else one per key (first key * 256 + second key)
+    bool grouped = !query.groupBy.empty();
+    int keyCount = grouped ? (query.groupBy.size() == 2 ? 65536 : 256) : 1;
+    vector<long long> rows(keyCount, 0);
+    vector<long long> wins(keyCount, 0);
+    vector<long long> sums(keyCount, 0);
+    vector<long long> minimums(keyCount, LLONG_MAX);
+    vector<long long> maximums(keyCount, LLONG_MIN);
+
+    vector<ChunkFilter> filters;
+    alignas(64) uint8_t selected[CHUNK_ROWS];
+    alignas(64) int64_t values[CHUNK_ROWS];
+    int indexes[CHUNK_ROWS];
+    uint8_t keyMaps[2][256];
+    int valueWidth = COLUMN_WIDTHS[query.valueColumn];
+
+    for (const ResultsTable::RowGroup& group : table.getRowGroups()) {
+        bool skip = false;
+        filters.clear();
+        for (const ResultsFilter& filter : query.filters) {
+            int64_t target = filter.value;
+            if (filter.column == RESULT_CHARACTER) {
+                // a name the group doesn't have compares as a code no row uses
+                target = -1;
+                for (int code = 0; code <= group.maximum[RESULT_CHARACTER] && target < 0; code++) {
+                    if (group.characterCodes[code] == filter.value) {
+                        target = code;
+                    }
+                }
+            }
+            ZoneResult zone = checkZone(group.minimum[filter.column], group.maximum[filter.column], filter.compare, target);
+            if (zone == ZONE_NONE) {
+                skip = true;
+                break;
+            }
+            if (zone == ZONE_SOME) {
+                filters.push_back(ChunkFilter{group.columns[filter.column], COLUMN_WIDTHS[filter.column], filter.compare, target});
+            }
+        }
+        if (skip) {
+            result.rowGroupsSkipped++;
+            continue;
+        }
+        result.rowsScanned += group.rows;
+
+        const uint8_t* keyColumns[2] = {nullptr, nullptr};
+        for (int k = 0; k < (int)query.groupBy.size(); k++) {
+            int column = query.groupBy[k];
+            keyColumns[k] = (const uint8_t*)group.columns[column];
+            for (int code = 0; code < 256; code++) {
+                keyMaps[k][code] = column == RESULT_CHARACTER ? group.characterCodes[code] : code;
+            }
+        }
+        const uint8_t* won = (const uint8_t*)group.columns[RESULT_WON];
+        const void* valueColumn = group.columns[query.valueColumn];
+
+        for (int start = 0; start < group.rows; start += CHUNK_ROWS) {
+            int n = min(CHUNK_ROWS, group.rows - start);
+            memset(selected, 1, n);
+            for (const ChunkFilter& filter : filters) {
+                if (filter.width == 1) {
+                    filterChunk((const uint8_t*)filter.column + start, filter.compare, filter.value, selected, n);
+                } else if (filter.width == 4) {
+                    filterChunk((const int32_t*)filter.column + start, filter.compare, filter.value, selected, n);
+                } else {
+                    filterChunk((const int64_t*)filter.column + start, filter.compare, filter.value, selected, n);
+                }
+            }
+            loadChunk(valueColumn, valueWidth, start, n, values);
+            const uint8_t* chunkWon = won + start;
+
+            if (!grouped) {
+                long long count = 0, winCount = 0, sum = 0;
+                long long low = minimums[0], high = maximums[0];
+                for (int i = 0; i < n; i++) {
+                    long long value = values[i];
+                    count += selected[i];
+                    winCount += selected[i] & chunkWon[i];
+                    sum += selected[i] ? value : 0;
+                    low = min(low, selected[i] ? value : LLONG_MAX);
+                    high = max(high, selected[i] ? value : LLONG_MIN);
+                }
+                rows[0] += count;
+                wins[0] += winCount;
+                sums[0] += sum;
+                minimums[0] = low;
+                maximums[0] = high;
+                continue;
+            }
+
+            // selected row numbers without branches, then one scattered update per selected row
+            int count = 0;
+            for (int i = 0; i < n; i++) {
+                indexes[count] = i;
+                count += selected[i];
+            }
+            const uint8_t* first = keyColumns[0] + start;
+            const uint8_t* second = keyColumns[1] != nullptr ? keyColumns[1] + start : nullptr;
+            for (int j = 0; j < count; j++) {
+                int i = indexes[j];
+                int key = keyMaps[0][first[i]];
+                if (second != nullptr) {
+                    key = key * 256 + keyMaps[1][second[i]];
+                }
+                long long value = values[i];
+                rows[key]++;
+                wins[key] += chunkWon[i];
+                sums[key] += value;
+                minimums[key] = min(minimums[key], value);
+                maximums[key] = max(maximums[key], value);
+            }
+        }
+    }
+
+    for (int key = 0; key < keyCount; key++) {
+        if (rows[key] == 0) {
+            continue;
+        }
+        ResultsGroup group;
+        group.keys[0] = !grouped ? -1 : (query.groupBy.size() == 2 ? key / 256 : key);
+        group.keys[1] = query.groupBy.size() == 2 ? key % 256 : -1;
+        group.rows = rows[key];
+        group.wins = wins[key];
+        group.sum = sums[key];
+        group.minimum = minimums[key];
+        group.maximum = maximums[key];
+        result.groups.push_back(group);
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef RESULTSTABLE_H
+#define RESULTSTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ContentParser.h"
+#include "StatsSink.h"
+
+using namespace std;
+
+// columns of a results file, in file order
+enum ResultsColumn {
+    RESULT_GAME_ID,
+    RESULT_FINISHED_AT,
+    RESULT_PLAYER,
+    RESULT_CHARACTER,               // index into the file's character names
+    RESULT_PATH_TYPE,               // 0 = Training Fellowship, 1 = Direct Lab Assignment
+    RESULT_ADVISOR,                 // 0 = none, 1-5
+    RESULT_WON,                     // 1 if the player had the game's top final score alone
+    RESULT_EXPERIENCE,
+    RESULT_ACCURACY,
+    RESULT_EFFICIENCY,
+    RESULT_INSIGHT,
+    RESULT_POSITION,
+    RESULT_DISCOVERY_POINTS,
+    RESULT_FINAL_DISCOVERY_POINTS,
+    RESULT_COLUMN_COUNT
+};
+
+// column name as used in queries and the CSV header ("final_discovery_points"), -1 if unknown
+int findResultsColumn(const string& name);
+const char* getResultsColumnName(int column);
+// bytes per value: 1, 4 or 8
+int getResultsColumnWidth(int column);
+
+// file header, then row groups appended one after another
+static const char RESULTS_FILE_MAGIC[8] = {'J', 'T', 'G', 'C', 'O', 'L', '1', '\n'};
+static const int RESULTS_ROW_GROUP_ROWS = 65536;
+
+// ResultsColumns: rows being collected for one row group (one vector per column)
+// encode() appends the row group: a header with the row count and every column's min/max (the zone map),
+// the group's character names, then each column as a packed array, every section 8-byte aligned.
+class ResultsColumns {
+    private:
+        vector<int64_t> _int64[2];          // game id, finished at
+        vector<uint8_t> _uint8[5];          // player, character, path type, advisor, won
+        vector<int32_t> _int32[7];          // experience ... final discovery points
+        vector<string> _names;              // character names of this group, by code
+
+    public:
+        // room for a full row group is reserved up front, so collecting rows doesn't allocate
+        ResultsColumns();
+        // false (row not added) if the group already has 255 character names and this is a new one
+        bool add(const StatsRecord& record);
+        int size() const;
+        bool isFull() const;
+        void clear();
+        // append the row group to block
+        void encode(string& block) const;
+        // most bytes encode() appends (a full row group with 255 long names)
+        static size_t getMaxEncodedSize();
+};
+
+// ResultsTable: a results file mapped read-only, with each row group's zone map and column pointers
+// Character names are merged over all row groups (up to 256 different ones); each group maps its own codes
+// to the merged ones.
+class ResultsTable {
+    public:
+        struct RowGroup {
+            int rows;
+            int64_t minimum[RESULT_COLUMN_COUNT];
+            int64_t maximum[RESULT_COLUMN_COUNT];
+            const void* columns[RESULT_COLUMN_COUNT];
+            uint8_t characterCodes[256];    // group code -> index into getCharacterNames()
+        };
+
+    private:
+        MappedFile _file;
+        vector<RowGroup> _groups;
+        vector<string> _character_names;
+        long long _rows;
+        bool _truncated;
+
+    public:
+        ResultsTable();
+        // map the file and index its row groups, false if it's missing, not a results file or has too many characters
+        // (a partly written last row group is left out, see isTruncated)
+        bool open(const string& filename);
+
+        const vector<RowGroup>& getRowGroups() const;
+        const vector<string>& getCharacterNames() const;
+        // index of a character name, -1 if no row has it
+        int findCharacter(const string& name) const;
+        long long getRowCount() const;
+        bool isTruncated() const;
+};
+
+enum ResultsCompare {
+    COMPARE_EQUAL,
+    COMPARE_NOT_EQUAL,
+    COMPARE_LESS,
+    COMPARE_LESS_EQUAL,
+    COMPARE_GREATER,
+    COMPARE_GREATER_EQUAL
+};
+
+// one condition of a query (character conditions take the character's index as value)
+struct ResultsFilter {
+    int column;
+    int compare;
+    int64_t value;
+};
+
+// parse "advisor=3", "path_type!=0", "final_discovery_points>=50000" or "character=Dr.Panthera" (names are
+// looked up in table; a name no row has matches nothing), false with a message in error if it doesn't parse
+bool parseResultsFilter(const string& text, const ResultsTable& table, ResultsFilter& filter, string& error);
+
+// filters are ANDed; rows are grouped by up to two one-byte columns (player, character, path_type, advisor, won)
+// and every group gets its row count, wins, and the sum, min and max of the value column
+struct ResultsQuery {
+    vector<ResultsFilter> filters;
+    vector<int> groupBy;
+    int valueColumn;
+};
+
+struct ResultsGroup {
+    int keys[2];
+    long long rows;
+    long long wins;
+    long long sum;
+    long long minimum;
+    long long maximum;
+};
+
+struct ResultsQueryResult {
+    vector<ResultsGroup> groups;    // by key, groups without rows left out
+    long long rowsScanned;          // rows in row groups the zone maps couldn't skip
+    int rowGroupsSkipped;
+};
+
+// false with a message in error if the query asks for something unsupported (e.g. grouping by a 4-byte column)
+bool checkResultsQuery(const ResultsQuery& query, string& error);
+// run the query over every row group: skip groups the zone maps rule out, drop conditions the zone maps say
+// every row meets, then filter and aggregate 1024 rows at a time with one tight loop per condition
+void runResultsQuery(const ResultsTable& table, const ResultsQuery& query, ResultsQueryResult& result);
+
+#endif
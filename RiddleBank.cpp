@@ -0,0 +1,201 @@
+#include "RiddleBank.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace std;
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// one pass: skip spaces, remember a pending space between words, lowercase everything else
+void normalizeText(string_view text, string& out) {
+    out.clear();
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (isSpace(c)) {
+            pendingSpace = !out.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            out.push_back(' ');
+            pendingSpace = false;
+        }
+        out.push_back(c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c);
+    }
+}
+
+// Myers' bit-vector algorithm in Hyyro's formulation: column j of the DP table is kept as vertical
+// +1/-1 deltas (pv/mv), one bit per pattern character, and the last row's score is tracked directly
+static int myersDistance(string_view pattern, string_view text, int maxDistance) {
+    int m = pattern.length();
+    uint64_t peq[256] = {0};
+    for (int i = 0; i < m; i++) {
+        peq[(unsigned char)pattern[i]] |= 1ULL << i;
+    }
+
+    uint64_t pv = m == 64 ? ~0ULL : (1ULL << m) - 1;
+    uint64_t mv = 0;
+    uint64_t last = 1ULL << (m - 1);
+    int score = m;
+    int n = text.length();
+    for (int j = 0; j < n; j++) {
+        uint64_t eq = peq[(unsigned char)text[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        // the score can drop by at most one per remaining text character
+        if (score - (n - 1 - j) > maxDistance) {
+            return maxDistance + 1;
+        }
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score <= maxDistance ? score : maxDistance + 1;
+}
+
+// DP restricted to the diagonals |i - j| <= maxDistance (cells outside can't lead to a distance within the bound)
+static int bandedDistance(string_view a, string_view b, int maxDistance) {
+    int n = a.length();
+    int m = b.length();
+    int width = 2 * maxDistance + 1;
+    int outside = maxDistance + 1;
+    vector<int> previous(width, outside);
+    vector<int> current(width, outside);
+    // row i, column j is stored at j - i + maxDistance
+    for (int j = 0; j <= min(m, maxDistance); j++) {
+        previous[j + maxDistance] = j;
+    }
+    for (int i = 1; i <= n; i++) {
+        int rowBest = outside;
+        for (int d = 0; d < width; d++) {
+            int j = i + d - maxDistance;
+            if (j < 0 || j > m) {
+                current[d] = outside;
+                continue;
+            }
+            int best = outside;
+            if (j == 0) {
+                best = i;
+            } else {
+                best = previous[d] + (a[i - 1] != b[j - 1]);               // diagonal
+                if (d > 0) {
+                    best = min(best, current[d - 1] + 1);                   // left
+                }
+            }
+            if (d + 1 < width) {
+                best = min(best, previous[d + 1] + 1);                      // up
+            }
+            current[d] = min(best, outside);
+            rowBest = min(rowBest, current[d]);
+        }
+        if (rowBest > maxDistance) {
+            return maxDistance + 1;
+        }
+        swap(previous, current);
+    }
+    int result = previous[m - n + maxDistance];
+    return result <= maxDistance ? result : maxDistance + 1;
+}
+
+// lengths alone rule out most pairs; the shorter string is the bit-vector pattern
+int boundedEditDistance(string_view a, string_view b, int maxDistance) {
+    if (a.length() > b.length()) {
+        swap(a, b);
+    }
+    if ((int)(b.length() - a.length()) > maxDistance) {
+        return maxDistance + 1;
+    }
+    if (a.empty()) {
+        return b.length();
+    }
+    if (a.length() <= 64) {
+        return myersDistance(a, b, maxDistance);
+    }
+    return bandedDistance(a, b, maxDistance);
+}
+
+int typoAllowance(size_t answerLength) {
+    if (answerLength <= 3) {
+        return 0;
+    }
+    return answerLength <= 7 ? 1 : 2;
+}
+
+AnswerMatch matchAnswer(string_view normalizedAnswer, string_view typed, string& scratch) {
+    normalizeText(typed, scratch);
+    if (scratch == normalizedAnswer) {
+        return ANSWER_EXACT;
+    }
+    int allowance = typoAllowance(normalizedAnswer.length());
+    if (allowance > 0 && boundedEditDistance(normalizedAnswer, scratch, allowance) <= allowance) {
+        return ANSWER_CLOSE;
+    }
+    return ANSWER_WRONG;
+}
+
+// hash index for exact repeats, then length-sorted answer groups for near repeats
+void findDuplicateRiddles(const vector<Riddle>& riddles, vector<RiddleDuplicate>& duplicates) {
+    duplicates.clear();
+    int count = riddles.size();
+    vector<string> questions(count);
+    vector<string> answers(count);
+    for (int i = 0; i < count; i++) {
+        normalizeText(riddles[i].question, questions[i]);
+        normalizeText(riddles[i].answer, answers[i]);
+    }
+
+    vector<bool> repeated(count, false);
+    unordered_map<string_view, int> byQuestion;
+    byQuestion.reserve(count);
+    for (int i = 0; i < count; i++) {
+        pair<unordered_map<string_view, int>::iterator, bool> slot = byQuestion.insert(make_pair(string_view(questions[i]), i));
+        if (!slot.second) {
+            duplicates.push_back(RiddleDuplicate{i, slot.first->second, true});
+            repeated[i] = true;
+        }
+    }
+
+    unordered_map<string_view, vector<int>> byAnswer;
+    for (int i = 0; i < count; i++) {
+        if (!repeated[i]) {
+            byAnswer[answers[i]].push_back(i);
+        }
+    }
+    for (auto& group : byAnswer) {
+        vector<int>& members = group.second;
+        if (members.size() < 2) {
+            continue;
+        }
+        stable_sort(members.begin(), members.end(), [&](int x, int y) {
+            return questions[x].length() < questions[y].length();
+        });
+        for (size_t a = 0; a < members.size(); a++) {
+            int i = members[a];
+            int allowance = max(1, (int)questions[i].length() / 10);
+            for (size_t b = a + 1; b < members.size(); b++) {
+                int j = members[b];
+                if ((int)(questions[j].length() - questions[i].length()) > allowance) {
+                    break;
+                }
+                if (!repeated[max(i, j)] && boundedEditDistance(questions[i], questions[j], allowance) <= allowance) {
+                    duplicates.push_back(RiddleDuplicate{max(i, j), min(i, j), false});
+                    repeated[max(i, j)] = true;
+                }
+            }
+        }
+    }
+
+    sort(duplicates.begin(), duplicates.end(), [](const RiddleDuplicate& x, const RiddleDuplicate& y) {
+        return x.riddle < y.riddle;
+    });
+}
@@ -0,0 +1,48 @@
+#ifndef RIDDLEBANK_H
+#define RIDDLEBANK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ContentBundle.h"
+
+using namespace std;
+
+// Riddle answers and duplicate checks
+// Answers are normalized once when content is compiled (lowercase, trimmed, single spaces), so checking
+// a typed answer only normalizes the typed text and runs a bounded edit distance against the stored one.
+
+// lowercase ASCII, drop leading/trailing whitespace, collapse inner whitespace runs to one space (out is overwritten)
+void normalizeText(string_view text, string& out);
+
+// Levenshtein distance between a and b if it is at most maxDistance, otherwise maxDistance + 1
+// (bit-parallel Myers/Hyyro when the shorter string fits in 64 bits, a diagonal band of the DP table otherwise)
+int boundedEditDistance(string_view a, string_view b, int maxDistance);
+
+// typos forgiven in an answer of this length: none up to 3 characters (symbols like "==" must be exact),
+// one up to 7, two beyond
+int typoAllowance(size_t answerLength);
+
+// how a typed answer compares with the expected one
+enum AnswerMatch {
+    ANSWER_WRONG,
+    ANSWER_EXACT,       // equal after normalization
+    ANSWER_CLOSE        // within the typo allowance
+};
+
+// compare a typed answer with a normalized expected answer (scratch holds the normalized typed text)
+AnswerMatch matchAnswer(string_view normalizedAnswer, string_view typed, string& scratch);
+
+// a riddle that repeats an earlier one
+struct RiddleDuplicate {
+    int riddle;         // index of the later riddle
+    int original;       // index of the earlier riddle it repeats
+    bool exact;         // same question after normalization; otherwise the same answer and a question within 10%
+};
+
+// every riddle that repeats an earlier one, in riddle order
+// Exact repeats are found through a hash index on the normalized question; near repeats are only looked for
+// among riddles with the same normalized answer, sorted by question length so only possible matches are compared.
+void findDuplicateRiddles(const vector<Riddle>& riddles, vector<RiddleDuplicate>& duplicates);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SCRIPTEDIO_H
+#define SCRIPTEDIO_H
+
+#include <cstddef>
+#include <streambuf>
+
+using namespace std;
+
+// Streams for driving the game without a player (simulation and benchmark tools)
+
+// ScriptedInput: repeats the same answers forever, reading straight from the script (no copies)
+class ScriptedInput : public streambuf {
+    private:
+        const char* _begin;
+        const char* _end;
+
+    protected:
+        int_type underflow() {
+            setg((char*)_begin, (char*)_begin, (char*)_end);
+            return traits_type::to_int_type(*_begin);
+        }
+
+    public:
+        ScriptedInput(const char* script, size_t length) {
+            _begin = script;
+            _end = script + length;
+            setg((char*)_begin, (char*)_begin, (char*)_end);
+        }
+};
+
+// NullOutput: throws away everything written to it
+class NullOutput : public streambuf {
+    private:
+        char _buffer[256];
+
+    protected:
+        int_type overflow(int_type c) {
+            setp(_buffer, _buffer + sizeof(_buffer));
+            return traits_type::not_eof(c);
+        }
+
+    public:
+        NullOutput() {
+            setp(_buffer, _buffer + sizeof(_buffer));
+        }
+};
+
+#endif
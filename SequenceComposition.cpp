@@ -0,0 +1,251 @@
+#include "SequenceComposition.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "BaseCodes.h"
+
+using namespace std;
+
+static const char PAIR_BASES[4] = {'A', 'C', 'G', 'T'};
+
+// base kinds are the shared base codes (A, C, G, T, then everything else)
+static_assert(BASE_A == 0 && BASE_T == 3 && BASE_OTHER == BASE_CODE_OTHER, "base kinds must match BASE_CODES");
+
+// per byte: a 64-bit word with a 1 in its kind's byte lane; per pair of kinds (first * 5 + second): a 1 in the
+// pair's lane of the low (AA-CT) or high (GA-TT) word, nothing if either isn't A/C/G/T
+struct CompositionTables {
+    uint64_t baseLanes[256];
+    uint64_t pairLanes[2][BASE_KIND_COUNT * BASE_KIND_COUNT];
+
+    CompositionTables() {
+        for (int c = 0; c < 256; c++) {
+            baseLanes[c] = 1ULL << (8 * BASE_CODES[c]);
+        }
+        memset(pairLanes, 0, sizeof(pairLanes));
+        for (int first = 0; first < 4; first++) {
+            for (int second = 0; second < 4; second++) {
+                int pair = first * 4 + second;
+                pairLanes[pair / 8][first * BASE_KIND_COUNT + second] = 1ULL << (8 * (pair % 8));
+            }
+        }
+    }
+};
+static const CompositionTables TABLES;
+
+// bases of p[0, n): two packed accumulators (independent adds), folded every 255 bases each
+static void countBases(const char* p, size_t n, long long* bases) {
+    while (n > 0) {
+        size_t chunk = min(n, (size_t)510);
+        uint64_t even = 0;
+        uint64_t odd = 0;
+        size_t i = 0;
+        for (; i + 1 < chunk; i += 2) {
+            even += TABLES.baseLanes[(uint8_t)p[i]];
+            odd += TABLES.baseLanes[(uint8_t)p[i + 1]];
+        }
+        if (i < chunk) {
+            even += TABLES.baseLanes[(uint8_t)p[i]];
+        }
+        for (int kind = 0; kind < BASE_KIND_COUNT; kind++) {
+            bases[kind] += ((even >> (8 * kind)) & 0xFF) + ((odd >> (8 * kind)) & 0xFF);
+        }
+        p += chunk;
+        n -= chunk;
+    }
+}
+
+// pairs (p[i], p[i + 1]) for i in [0, n), so p[n] is read too; like countBases, two sets of accumulators take
+// alternate pairs
+static void countPairs(const char* p, size_t n, long long* pairs) {
+    while (n > 0) {
+        size_t chunk = min(n, (size_t)510);
+        uint64_t low[2] = {0, 0};
+        uint64_t high[2] = {0, 0};
+        int previous = BASE_CODES[(uint8_t)p[0]];
+        size_t i = 0;
+        for (; i + 1 < chunk; i += 2) {
+            int middle = BASE_CODES[(uint8_t)p[i + 1]];
+            int next = BASE_CODES[(uint8_t)p[i + 2]];
+            int first = previous * BASE_KIND_COUNT + middle;
+            int second = middle * BASE_KIND_COUNT + next;
+            low[0] += TABLES.pairLanes[0][first];
+            high[0] += TABLES.pairLanes[1][first];
+            low[1] += TABLES.pairLanes[0][second];
+            high[1] += TABLES.pairLanes[1][second];
+            previous = next;
+        }
+        if (i < chunk) {
+            int index = previous * BASE_KIND_COUNT + BASE_CODES[(uint8_t)p[i + 1]];
+            low[0] += TABLES.pairLanes[0][index];
+            high[0] += TABLES.pairLanes[1][index];
+        }
+        for (int lane = 0; lane < 8; lane++) {
+            pairs[lane] += ((low[0] >> (8 * lane)) & 0xFF) + ((low[1] >> (8 * lane)) & 0xFF);
+            pairs[8 + lane] += ((high[0] >> (8 * lane)) & 0xFF) + ((high[1] >> (8 * lane)) & 0xFF);
+        }
+        p += chunk;
+        n -= chunk;
+    }
+}
+
+// BASE COMPOSITION
+
+void BaseComposition::clear() {
+    memset(bases, 0, sizeof(bases));
+    memset(pairs, 0, sizeof(pairs));
+}
+
+void BaseComposition::add(const BaseComposition& other) {
+    for (int i = 0; i < BASE_KIND_COUNT; i++) {
+        bases[i] += other.bases[i];
+    }
+    for (int i = 0; i < PAIR_COUNT; i++) {
+        pairs[i] += other.pairs[i];
+    }
+}
+
+void BaseComposition::subtract(const BaseComposition& other) {
+    for (int i = 0; i < BASE_KIND_COUNT; i++) {
+        bases[i] -= other.bases[i];
+    }
+    for (int i = 0; i < PAIR_COUNT; i++) {
+        pairs[i] -= other.pairs[i];
+    }
+}
+
+long long BaseComposition::getLength() const {
+    long long length = 0;
+    for (int i = 0; i < BASE_KIND_COUNT; i++) {
+        length += bases[i];
+    }
+    return length;
+}
+
+double BaseComposition::getGcContent() const {
+    long long known = bases[BASE_A] + bases[BASE_C] + bases[BASE_G] + bases[BASE_T];
+    return known == 0 ? 0.0 : (double)(bases[BASE_G] + bases[BASE_C]) / known;
+}
+
+double BaseComposition::getGcSkew() const {
+    long long gc = bases[BASE_G] + bases[BASE_C];
+    return gc == 0 ? 0.0 : (double)(bases[BASE_G] - bases[BASE_C]) / gc;
+}
+
+double BaseComposition::getPairFrequency(int pair) const {
+    long long total = 0;
+    for (int i = 0; i < PAIR_COUNT; i++) {
+        total += pairs[i];
+    }
+    return total == 0 || pair < 0 || pair >= PAIR_COUNT ? 0.0 : (double)pairs[pair] / total;
+}
+
+// PUBLIC FUNCTIONS
+
+int findPair(const string& name) {
+    if (name.size() != 2) {
+        return -1;
+    }
+    int first = BASE_CODES[(uint8_t)name[0]];
+    int second = BASE_CODES[(uint8_t)name[1]];
+    return first == BASE_OTHER || second == BASE_OTHER ? -1 : first * 4 + second;
+}
+
+string getPairName(int pair) {
+    return string(1, PAIR_BASES[(pair >> 2) & 3]) + PAIR_BASES[pair & 3];
+}
+
+void countComposition(string_view strand, BaseComposition& counts) {
+    countBases(strand.data(), strand.size(), counts.bases);
+    if (strand.size() > 1) {
+        countPairs(strand.data(), strand.size() - 1, counts.pairs);
+    }
+}
+
+// COMPOSITION WINDOWS
+
+// CONSTRUCTORS
+
+CompositionWindows::CompositionWindows(int size, int step) {
+    _size = max(size, 1);
+    _step = max(step, 1);
+    reset(string_view());
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+void CompositionWindows::countSegment(long long begin, long long end, long long pairBegin, long long pairEnd) {
+    _segment.clear();
+    if (end > begin) {
+        countBases(_strand.data() + begin, end - begin, _segment.bases);
+    }
+    if (pairEnd > pairBegin) {
+        countPairs(_strand.data() + pairBegin, pairEnd - pairBegin, _segment.pairs);
+    }
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+void CompositionWindows::reset(string_view strand) {
+    _strand = strand;
+    _start = 0;
+    _end = 0;
+    _started = false;
+    _done = strand.empty();
+    _counts.clear();
+}
+
+// a window's pairs are the ones starting in [start, end - 1); overlapping windows add what came in and subtract
+// what left, others are counted from scratch
+bool CompositionWindows::next() {
+    long long length = _strand.size();
+    if (_done || (_started && _end == length)) {
+        _done = true;
+        return false;
+    }
+    long long start = _started ? _start + _step : 0;
+    long long end = min(start + _size, length);
+    if (start >= length) {
+        _done = true;
+        return false;
+    }
+
+    if (!_started || start >= _end) {
+        countSegment(start, end, start, end - 1);
+        _counts = _segment;
+    } else {
+        countSegment(_end, end, _end - 1, end - 1);
+        _counts.add(_segment);
+        countSegment(_start, start, _start, start);
+        _counts.subtract(_segment);
+    }
+    _started = true;
+    _start = start;
+    _end = end;
+    return true;
+}
+
+long long CompositionWindows::getStart() const {
+    return _start;
+}
+
+long long CompositionWindows::getEnd() const {
+    return _end;
+}
+
+const BaseComposition& CompositionWindows::getCounts() const {
+    return _counts;
+}
+
+long long CompositionWindows::getWindowCount(long long length, int size, int step) {
+    size = max(size, 1);
+    step = max(step, 1);
+    if (length <= 0) {
+        return 0;
+    }
+    if (length <= size) {
+        return 1;
+    }
+    long long full = (length - size) / step + 1;
+    long long lastEnd = (full - 1) * step + size;
+    return full + (lastEnd < length && full * step < length ? 1 : 0);
+}
@@ -0,0 +1,88 @@
+#ifndef SEQUENCECOMPOSITION_H
+#define SEQUENCECOMPOSITION_H
+
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// base kinds counted by BaseComposition (either case); anything else is BASE_OTHER
+enum BaseKind {
+    BASE_A,
+    BASE_C,
+    BASE_G,
+    BASE_T,
+    BASE_OTHER,
+    BASE_KIND_COUNT
+};
+
+// dinucleotides: first base * 4 + second base (AA, AC, ... TT), pairs of two A/C/G/T bases only
+static const int PAIR_COUNT = 16;
+
+// base and dinucleotide counts of one stretch of a strand
+struct BaseComposition {
+    long long bases[BASE_KIND_COUNT];
+    long long pairs[PAIR_COUNT];
+
+    void clear();
+    void add(const BaseComposition& other);
+    void subtract(const BaseComposition& other);
+
+    long long getLength() const;
+    // (G + C) / (A + C + G + T), 0 if there are no A/C/G/T bases
+    double getGcContent() const;
+    // (G - C) / (G + C), 0 if there are no G/C bases
+    double getGcSkew() const;
+    // share of the stretch's A/C/G/T pairs that are this pair
+    double getPairFrequency(int pair) const;
+};
+
+// "AC" -> 1, "cg" -> 6, -1 if it isn't two of A/C/G/T
+int findPair(const string& name);
+// "AC" for 1
+string getPairName(int pair);
+
+// count the bases of strand and the pairs of neighbouring bases in it (added to counts)
+// Both counts are histograms in packed byte counters (one 64-bit add per base, a table lookup picking the lane),
+// folded into counts every 255 bases before a lane can overflow.
+void countComposition(string_view strand, BaseComposition& counts);
+
+// CompositionWindows: composition of windows of size bases, one every step bases, along a strand
+// Windows start at 0, step, 2 * step, ... as long as they fit; if the last of them ends before the strand does, one
+// shorter window covers the rest (a strand shorter than size is one window). When windows overlap, each window is
+// the previous one plus the bases that came in and minus the ones that left, so every base is counted twice at most
+// whatever the window size.
+class CompositionWindows {
+    private:
+        int _size;
+        int _step;
+        string_view _strand;
+        long long _start;
+        long long _end;
+        bool _started;
+        bool _done;
+        BaseComposition _counts;
+        BaseComposition _segment;
+
+        // bases of [begin, end) and pairs starting in [pairBegin, pairEnd), into _segment
+        void countSegment(long long begin, long long end, long long pairBegin, long long pairEnd);
+
+    public:
+        // sizes below 1 are taken as 1
+        CompositionWindows(int size = 1000, int step = 1000);
+
+        // start over on strand (which must stay valid while windows are read)
+        void reset(string_view strand);
+        // move to the next window, false after the last one
+        bool next();
+
+        long long getStart() const;
+        long long getEnd() const;
+        // bases in [getStart(), getEnd()) and the pairs within them
+        const BaseComposition& getCounts() const;
+
+        // windows a strand of this length has
+        static long long getWindowCount(long long length, int size, int step);
+};
+
+#endif
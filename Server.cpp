@@ -0,0 +1,435 @@
+#include "Server.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const int MAX_EVENTS = 256;
+static const size_t READ_CHUNK = 4096;
+
+// CONSTRUCTOR / DESTRUCTOR
+
+GameServer::GameServer(ContentStore& content, int playerCount, int workerCount)
+    : _content(content), _player_count(playerCount), _worker_count(workerCount), _running(false) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _session_count = 0;
+    _stopping = false;
+
+    // hosted games don't autosave; stats go to a shared sink if one is set
+    _options.leaderboard = &_leaderboard;
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = _wake_fd;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wake_fd, &event);
+
+    for (int i = 0; i < _worker_count; i++) {
+        _workers.push_back(thread(&GameServer::workerLoop, this));
+    }
+}
+
+GameServer::~GameServer() {
+    {
+        lock_guard<mutex> guard(_queue_lock);
+        _stopping = true;
+    }
+    _queue_ready.notify_all();
+    for (int i = 0; i < (int)_workers.size(); i++) {
+        _workers[i].join();
+    }
+
+    // workers are gone, so every session is idle now
+    for (int fd = 0; fd < (int)_connections.size(); fd++) {
+        if (_connections[fd] != nullptr) {
+            destroy(_connections[fd]);
+        }
+    }
+    for (int i = 0; i < (int)_listen_fds.size(); i++) {
+        close(_listen_fds[i]);
+    }
+    for (int i = 0; i < (int)_unix_paths.size(); i++) {
+        unlink(_unix_paths[i].c_str());
+    }
+    close(_wake_fd);
+    close(_epoll_fd);
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+// parse the address, create and bind a non-blocking socket, listen, register it with epoll
+bool GameServer::listenOn(const string& address) {
+    int fd;
+    if (address.compare(0, 5, "unix:") == 0) {
+        string path = address.substr(5);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.length() >= sizeof(addr.sun_path)) {
+            return false;
+        }
+        strcpy(addr.sun_path, path.c_str());
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return false;
+        }
+        unlink(path.c_str());
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+        _unix_paths.push_back(path);
+    } else {
+        string host = "127.0.0.1";
+        string port = address;
+        size_t colon = address.rfind(':');
+        if (colon != string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(atoi(port.c_str()));
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+            return false;
+        }
+
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return false;
+        }
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+    }
+
+    if (listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return false;
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    _listen_fds.push_back(fd);
+    return true;
+}
+
+// raise the open file limit, then wait for events: new clients, client input, writable sockets, finished worker runs
+void GameServer::run() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    _running = true;
+    epoll_event events[MAX_EVENTS];
+
+    while (_running) {
+        int count = epoll_wait(_epoll_fd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == _wake_fd) {
+                uint64_t value;
+                while (read(_wake_fd, &value, sizeof(value)) > 0) {
+                }
+                collectFinishedRuns();
+                continue;
+            }
+
+            bool isListener = false;
+            for (int j = 0; j < (int)_listen_fds.size(); j++) {
+                if (_listen_fds[j] == fd) {
+                    isListener = true;
+                }
+            }
+            if (isListener) {
+                acceptConnections(fd);
+                continue;
+            }
+
+            if (fd >= (int)_connections.size() || _connections[fd] == nullptr) {
+                continue;
+            }
+            Connection* conn = _connections[fd];
+            if (events[i].events & EPOLLOUT) {
+                handleWritable(conn);
+            }
+            // the connection may have been freed while writing
+            if (_connections[fd] == conn && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                handleReadable(conn);
+            }
+        }
+    }
+}
+
+void GameServer::stop() {
+    _running = false;
+    uint64_t one = 1;
+    ssize_t ignored = write(_wake_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+int GameServer::getSessionCount() const {
+    return _session_count;
+}
+
+void GameServer::setStatsSink(StatsSink* stats) {
+    _options.stats = stats;
+}
+
+void GameServer::setSetupOptions(const SetupOptions& setup) {
+    _options.setup = setup;
+}
+
+const Leaderboard& GameServer::getLeaderboard() const {
+    return _leaderboard;
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+// accept every pending client, give each a new session and run it once so the first prompt goes out
+void GameServer::acceptConnections(int listen_fd) {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        // prompts are small and latency matters more than packet count
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        Connection* conn = new Connection();
+        conn->fd = fd;
+        conn->session = new GameSession(_content, _player_count, _options);
+        conn->writeOffset = 0;
+        conn->peerClosed = false;
+        conn->inputClosed = false;
+        conn->inFlight = 0;
+
+        if (fd >= (int)_connections.size()) {
+            _connections.resize(fd + 1, nullptr);
+        }
+        _connections[fd] = conn;
+        _session_count++;
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+
+        conn->session->schedule();
+        dispatch(conn);
+        settle(conn);
+    }
+}
+
+// read everything available, pass it to the session, schedule the session if it was waiting
+void GameServer::handleReadable(Connection* conn) {
+    char buffer[READ_CHUNK];
+    while (!conn->peerClosed) {
+        ssize_t n = read(conn->fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            if (conn->session->addInput(buffer, n)) {
+                dispatch(conn);
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // EOF or error: settle() lets the game unwind
+        conn->peerClosed = true;
+        updateInterest(conn);
+    }
+    settle(conn);
+}
+
+void GameServer::handleWritable(Connection* conn) {
+    flush(conn);
+    settle(conn);
+}
+
+void GameServer::dispatch(Connection* conn) {
+    conn->inFlight++;
+
+    if (_worker_count == 0) {
+        string output;
+        runSession(conn, output);
+        conn->inFlight--;
+        sendOutput(conn, output);
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(_queue_lock);
+        _run_queue.push_back(conn);
+    }
+    _queue_ready.notify_one();
+}
+
+// output is taken before finishRun() so a second run started by new input never shares the buffer
+void GameServer::runSession(Connection* conn, string& output) {
+    GameSession* session = conn->session;
+    bool again = true;
+    while (again) {
+        session->resume();
+        session->takeOutput(output);
+        again = session->finishRun();
+    }
+}
+
+// take a session off the queue, run it, hand its output back to the loop through the eventfd
+void GameServer::workerLoop() {
+    while (true) {
+        Connection* conn;
+        {
+            unique_lock<mutex> guard(_queue_lock);
+            while (_run_queue.empty() && !_stopping) {
+                _queue_ready.wait(guard);
+            }
+            if (_run_queue.empty()) {
+                return;
+            }
+            conn = _run_queue.front();
+            _run_queue.pop_front();
+        }
+
+        string output;
+        runSession(conn, output);
+
+        {
+            lock_guard<mutex> guard(_done_lock);
+            _done.push_back(make_pair(conn, string()));
+            _done.back().second.swap(output);
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(_wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void GameServer::collectFinishedRuns() {
+    vector<pair<Connection*, string> > done;
+    {
+        lock_guard<mutex> guard(_done_lock);
+        done.swap(_done);
+    }
+    for (int i = 0; i < (int)done.size(); i++) {
+        Connection* conn = done[i].first;
+        conn->inFlight--;
+        sendOutput(conn, done[i].second);
+        settle(conn);
+    }
+}
+
+void GameServer::sendOutput(Connection* conn, const string& output) {
+    if (!conn->peerClosed && !output.empty()) {
+        conn->writeBuffer.append(output);
+        flush(conn);
+    }
+}
+
+// write as much as the socket takes, wait for EPOLLOUT for the rest
+void GameServer::flush(Connection* conn) {
+    while (conn->writeOffset < conn->writeBuffer.size()) {
+        ssize_t n = send(conn->fd, conn->writeBuffer.data() + conn->writeOffset,
+                         conn->writeBuffer.size() - conn->writeOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->writeOffset += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // broken connection: drop the output, settle() lets the game unwind
+        conn->peerClosed = true;
+        conn->writeBuffer.clear();
+        conn->writeOffset = 0;
+        break;
+    }
+
+    if (conn->writeOffset == conn->writeBuffer.size()) {
+        conn->writeBuffer.clear();
+        conn->writeOffset = 0;
+    }
+    updateInterest(conn);
+}
+
+void GameServer::updateInterest(Connection* conn) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.data.fd = conn->fd;
+    if (!conn->peerClosed) {
+        event.events = EPOLLIN;
+        if (!conn->writeBuffer.empty()) {
+            event.events |= EPOLLOUT;
+        }
+    }
+    epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+void GameServer::settle(Connection* conn) {
+    if (conn->peerClosed && !conn->inputClosed) {
+        conn->inputClosed = true;
+        if (conn->session->closeInput()) {
+            dispatch(conn);
+        }
+    }
+
+    if (conn->inFlight > 0 || !conn->session->isIdle()) {
+        return;
+    }
+    bool gameDone = conn->session->isFinished();
+    if (conn->peerClosed || (gameDone && conn->writeBuffer.empty())) {
+        destroy(conn);
+    }
+}
+
+void GameServer::destroy(Connection* conn) {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    _connections[conn->fd] = nullptr;
+    delete conn->session;
+    delete conn;
+    _session_count--;
+}
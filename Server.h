@@ -0,0 +1,100 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Game.h"
+#include "Session.h"
+
+using namespace std;
+
+// GameServer: hosts many games in one process
+// One epoll event loop owns every socket. Each connection gets its own GameSession, which runs
+// until the game needs input and then waits (costing only memory) until the client sends a line.
+// With workers > 0 the game logic runs on a small thread pool and the loop only does I/O.
+class GameServer {
+    private:
+        // one client connection and its game
+        struct Connection {
+            int fd;
+            GameSession* session;
+            string writeBuffer;     // output not yet accepted by the socket
+            size_t writeOffset;
+            bool peerClosed;        // client went away (read EOF or write error)
+            bool inputClosed;       // session was told about it
+            int inFlight;           // runs handed to workers and not yet completed (loop thread only)
+        };
+
+        ContentStore& _content;
+        int _player_count;
+        // shared by every hosted game: results are ranked as games finish
+        Leaderboard _leaderboard;
+        GameOptions _options;
+        int _worker_count;
+
+        int _epoll_fd;
+        int _wake_fd;               // eventfd: workers finished a run, or stop() was called
+        vector<int> _listen_fds;
+        vector<string> _unix_paths; // socket files to remove on shutdown
+        vector<Connection*> _connections;  // indexed by fd
+        int _session_count;
+        atomic<bool> _running;
+
+        // worker pool
+        vector<thread> _workers;
+        mutex _queue_lock;
+        condition_variable _queue_ready;
+        deque<Connection*> _run_queue;
+        bool _stopping;
+
+        // runs finished by workers, waiting for the loop to send their output
+        mutex _done_lock;
+        vector<pair<Connection*, string> > _done;
+
+        // Private helper functions:
+        void acceptConnections(int listen_fd);
+        void handleReadable(Connection* conn);
+        void handleWritable(Connection* conn);
+        // run a session now (no workers) or queue it for the pool
+        void dispatch(Connection* conn);
+        // resume a session until it waits for input again, collect its output
+        void runSession(Connection* conn, string& output);
+        void workerLoop();
+        void collectFinishedRuns();
+        // queue output for the client and try to send it
+        void sendOutput(Connection* conn, const string& output);
+        void flush(Connection* conn);
+        void updateInterest(Connection* conn);
+        // called once at the end of every event: let the game unwind if the client left,
+        // close and free the connection once its game and output are done
+        void settle(Connection* conn);
+        void destroy(Connection* conn);
+
+    public:
+        // playerCount: players per hosted game, workerCount: 0 runs games on the loop thread
+        GameServer(ContentStore& content, int playerCount, int workerCount);
+        ~GameServer();
+
+        // listen on "unix:/path/to/socket", "host:port" or "port" (127.0.0.1)
+        bool listenOn(const string& address);
+        // run the event loop until stop() is called
+        void run();
+        // ask run() to return (safe from other threads and signal handlers)
+        void stop();
+        // games currently hosted
+        int getSessionCount() const;
+        // queue every finished game's stats to this sink (set before run, must outlive the server)
+        void setStatsSink(StatsSink* stats);
+        // how new games are set up (tile mix, lane balancing), set before run
+        void setSetupOptions(const SetupOptions& setup);
+        // rankings of every game finished on this server
+        const Leaderboard& getLeaderboard() const;
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "Session.h"
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <sys/mman.h>
+
+using namespace std;
+
+// each game gets 256 KB of address space for its stack, only the pages it touches are backed by memory
+static const size_t SESSION_STACK_SIZE = 256 * 1024;
+
+// CONSTRUCTOR / DESTRUCTOR
+
+GameSession::GameSession(ContentStore& content, int playerCount, const GameOptions& options)
+    : _content(content), _player_count(playerCount), _options(options), _in(&_input_buffer), _out(&_output_buffer) {
+    _input_buffer.session = this;
+    _output_buffer.output = &_output;
+
+    _stack = nullptr;
+    _stack_size = SESSION_STACK_SIZE;
+    _input_closed = false;
+    _scheduled = false;
+    _started = false;
+    _finished = false;
+
+    _state.random.setState(((uint64_t)rand() << 32) ^ (uint64_t)(uintptr_t)this ^ (uint64_t)time(nullptr));
+}
+
+GameSession::~GameSession() {
+    // a game still waiting for input has live objects on its stack: let it unwind first
+    if (_started && !_finished) {
+        closeInput();
+        resume();
+    }
+    if (_stack != nullptr) {
+        munmap(_stack, _stack_size);
+    }
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+void GameSession::entry(unsigned int high, unsigned int low) {
+    GameSession* session = (GameSession*)(((uintptr_t)high << 32) | (uintptr_t)low);
+    session->run();
+}
+
+// set up and play one game, a closed connection unwinds out of whatever prompt the game was in
+void GameSession::run() {
+    try {
+        _out << "\n=== Journey Through Genome ===" << endl;
+        setupGame(_state, _content, _player_count, _in, _out, _options.setup);
+        playGame(_state, _content, _in, _out, _options);
+    } catch (InputClosed&) {
+    }
+
+    lock_guard<mutex> guard(_lock);
+    _finished = true;
+}
+
+bool GameSession::takePendingInput() {
+    lock_guard<mutex> guard(_lock);
+    if (_pending_input.empty()) {
+        return false;
+    }
+    _inbox.swap(_pending_input);
+    _pending_input.clear();
+    return true;
+}
+
+// hand out the next chunk of received bytes; with nothing left, switch back to the caller of resume()
+GameSession::InputBuffer::int_type GameSession::InputBuffer::underflow() {
+    while (true) {
+        if (session->takePendingInput()) {
+            char* begin = &session->_inbox[0];
+            setg(begin, begin, begin + session->_inbox.size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+        bool closed;
+        {
+            lock_guard<mutex> guard(session->_lock);
+            closed = session->_input_closed && session->_pending_input.empty();
+        }
+        if (closed) {
+            return traits_type::eof();
+        }
+
+        swapcontext(&session->_context, &session->_caller);
+    }
+}
+
+GameSession::OutputBuffer::int_type GameSession::OutputBuffer::overflow(int_type c) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        output->push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+streamsize GameSession::OutputBuffer::xsputn(const char* s, streamsize n) {
+    output->append(s, n);
+    return n;
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+bool GameSession::addInput(const char* data, size_t size) {
+    lock_guard<mutex> guard(_lock);
+    _pending_input.append(data, size);
+    if (!_scheduled && !_finished) {
+        _scheduled = true;
+        return true;
+    }
+    return false;
+}
+
+bool GameSession::closeInput() {
+    lock_guard<mutex> guard(_lock);
+    _input_closed = true;
+    if (!_scheduled && !_finished) {
+        _scheduled = true;
+        return true;
+    }
+    return false;
+}
+
+void GameSession::schedule() {
+    lock_guard<mutex> guard(_lock);
+    _scheduled = true;
+}
+
+// first call builds the coroutine on a fresh stack, later calls continue it from its last prompt
+void GameSession::resume() {
+    if (_finished) {
+        return;
+    }
+
+    if (!_started) {
+        void* stack = mmap(nullptr, _stack_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (stack == MAP_FAILED) {
+            lock_guard<mutex> guard(_lock);
+            _finished = true;
+            return;
+        }
+        _stack = (char*)stack;
+        // lowest page is a guard page so an overflow faults instead of corrupting memory
+        mprotect(_stack, 4096, PROT_NONE);
+
+        getcontext(&_context);
+        _context.uc_stack.ss_sp = _stack;
+        _context.uc_stack.ss_size = _stack_size;
+        _context.uc_link = &_caller;
+        uintptr_t self = (uintptr_t)this;
+        makecontext(&_context, (void (*)())entry, 2, (unsigned int)(self >> 32), (unsigned int)(self & 0xFFFFFFFFu));
+        _started = true;
+    }
+
+    swapcontext(&_caller, &_context);
+}
+
+bool GameSession::finishRun() {
+    lock_guard<mutex> guard(_lock);
+    if (!_finished && (!_pending_input.empty() || _input_closed)) {
+        return true;
+    }
+    _scheduled = false;
+    return false;
+}
+
+void GameSession::takeOutput(string& output) {
+    output.append(_output);
+    _output.clear();
+}
+
+bool GameSession::isFinished() const {
+    lock_guard<mutex> guard(_lock);
+    return _finished;
+}
+
+bool GameSession::isIdle() {
+    lock_guard<mutex> guard(_lock);
+    return !_scheduled;
+}
@@ -0,0 +1,95 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <ucontext.h>
+#include "Game.h"
+#include "GameState.h"
+
+using namespace std;
+
+// GameSession: one game hosted by the server
+// The session runs the same blocking game code as the terminal game (setupGame + playGame
+// reading an istream and writing an ostream), but on its own small stack as a coroutine:
+// when the game asks for a line that hasn't arrived yet, the session switches back to the
+// server, and resume() continues it right where it stopped once more input is added.
+class GameSession {
+    private:
+        // istream side: hands out received bytes, yields to the server when they run out
+        class InputBuffer : public streambuf {
+            public:
+                GameSession* session;
+            protected:
+                int_type underflow();
+        };
+        // ostream side: collects everything the game prints until the server takes it
+        class OutputBuffer : public streambuf {
+            public:
+                string* output;
+            protected:
+                int_type overflow(int_type c);
+                streamsize xsputn(const char* s, streamsize n);
+        };
+
+        ContentStore& _content;
+        int _player_count;
+        GameOptions _options;
+        GameState _state;
+
+        InputBuffer _input_buffer;
+        OutputBuffer _output_buffer;
+        istream _in;
+        ostream _out;
+
+        // coroutine contexts: the game's own and whoever called resume()
+        ucontext_t _context;
+        ucontext_t _caller;
+        char* _stack;
+        size_t _stack_size;
+
+        // guarded by _lock: bytes from the client not yet handed to the game, and scheduling flags
+        mutable mutex _lock;
+        string _pending_input;
+        bool _input_closed;
+        bool _scheduled;
+
+        // only touched by the thread currently running the session
+        string _inbox;
+        string _output;
+        bool _started;
+        bool _finished;
+
+        // coroutine entry point (makecontext passes the pointer as two ints)
+        static void entry(unsigned int high, unsigned int low);
+        void run();
+        // move pending input into the inbox, returns false if none is waiting
+        bool takePendingInput();
+
+    public:
+        GameSession(ContentStore& content, int playerCount, const GameOptions& options);
+        ~GameSession();
+
+        // add bytes received from the client, returns true if the session must be scheduled to run
+        bool addInput(const char* data, size_t size);
+        // client disconnected: the game unwinds the next time it asks for input
+        bool closeInput();
+        // mark the session as scheduled (used for its first run)
+        void schedule();
+
+        // run the game until it needs more input or ends
+        void resume();
+        // after resume(): returns true if the session must run again right away (more input arrived)
+        bool finishRun();
+
+        // output produced since the last call
+        void takeOutput(string& output);
+        bool isFinished() const;
+        // true once resume() has returned and nothing is scheduled (safe to delete)
+        bool isIdle();
+};
+
+#endif
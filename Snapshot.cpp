@@ -0,0 +1,264 @@
+#include "Snapshot.h"
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// fixed-size header at the start of every snapshot
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t laneCount;
+    uint32_t laneLength;
+    uint32_t playerCount;
+    int32_t turn;
+    uint64_t randomState;
+    uint64_t payloadSize;       // bytes following the header
+    uint64_t checksum;          // FNV-1a over the payload
+};
+
+// one player, names are stored after all the records
+struct PlayerRecord {
+    int32_t experience;
+    int32_t accuracy;
+    int32_t efficiency;
+    int32_t insight;
+    int32_t discoverPoints;
+    int32_t position;
+    int32_t pathType;
+    int32_t advisor;
+    uint32_t nameOffset;        // from the start of the name block
+    uint32_t nameLength;
+};
+
+static size_t padTo8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static uint64_t fnv1a(const char* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// compute section sizes, fill header, copy lanes, positions, finished flags, player records and names
+void writeSnapshot(const GameState& state, vector<char>& buffer) {
+    const Board& board = state.board;
+    uint32_t laneCount = board.getLaneCount();
+    uint32_t playerCount = state.players.size();
+
+    size_t laneBytes = padTo8(board.getLaneDataSize());
+    size_t positionBytes = padTo8(laneCount * sizeof(int32_t));
+    size_t finishedBytes = padTo8(playerCount);
+    size_t recordBytes = playerCount * sizeof(PlayerRecord);
+    size_t nameBytes = 0;
+    for (uint32_t i = 0; i < playerCount; i++) {
+        nameBytes += state.players[i].getCharacterName().length();
+    }
+    nameBytes = padTo8(nameBytes);
+
+    size_t payloadSize = laneBytes + positionBytes + finishedBytes + recordBytes + nameBytes;
+    buffer.assign(sizeof(SnapshotHeader) + payloadSize, 0);
+    char* out = buffer.data() + sizeof(SnapshotHeader);
+
+    memcpy(out, board.getLaneData(), board.getLaneDataSize());
+    out += laneBytes;
+
+    int32_t* positions = (int32_t*)out;
+    for (uint32_t i = 0; i < laneCount; i++) {
+        positions[i] = board.getPlayerPosition(i);
+    }
+    out += positionBytes;
+
+    for (uint32_t i = 0; i < playerCount; i++) {
+        out[i] = (i < state.finished.size() && state.finished[i]) ? 1 : 0;
+    }
+    out += finishedBytes;
+
+    PlayerRecord* records = (PlayerRecord*)out;
+    char* names = out + recordBytes;
+    uint32_t nameOffset = 0;
+    for (uint32_t i = 0; i < playerCount; i++) {
+        const Player& p = state.players[i];
+        const string& name = p.getCharacterName();
+        records[i].experience = p.getExperience();
+        records[i].accuracy = p.getAccuracy();
+        records[i].efficiency = p.getEfficiency();
+        records[i].insight = p.getInsight();
+        records[i].discoverPoints = p.getDiscoverPoints();
+        records[i].position = p.getPosition();
+        records[i].pathType = p.getPathType();
+        records[i].advisor = p.getAdvisor();
+        records[i].nameOffset = nameOffset;
+        records[i].nameLength = name.length();
+        memcpy(names + nameOffset, name.data(), name.length());
+        nameOffset += name.length();
+    }
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.laneCount = laneCount;
+    header.laneLength = board.getLaneLength();
+    header.playerCount = playerCount;
+    header.turn = state.turn;
+    header.randomState = state.random.getState();
+    header.payloadSize = payloadSize;
+    header.checksum = fnv1a(buffer.data() + sizeof(SnapshotHeader), payloadSize);
+    memcpy(buffer.data(), &header, sizeof(header));
+}
+
+// validate header, sizes and checksum, then copy every section back into state
+bool readSnapshot(const char* data, size_t size, GameState& state) {
+    if (size < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, 4) != 0 || header.version != SNAPSHOT_VERSION) {
+        return false;
+    }
+    // no players would divide the turn by zero when picking whose turn it is, a negative turn would pick a
+    // negative player, and the board keeps lane lengths in an int
+    if (header.laneCount == 0 || header.laneLength < 2 || header.laneLength > INT_MAX || header.playerCount == 0 ||
+        header.playerCount > header.laneCount || header.turn < 0) {
+        return false;
+    }
+
+    size_t laneStride = ((size_t)header.laneLength + 1) / 2;
+    size_t laneBytes = padTo8((size_t)header.laneCount * laneStride);
+    size_t positionBytes = padTo8(header.laneCount * sizeof(int32_t));
+    size_t finishedBytes = padTo8(header.playerCount);
+    size_t recordBytes = header.playerCount * sizeof(PlayerRecord);
+    size_t fixedBytes = laneBytes + positionBytes + finishedBytes + recordBytes;
+    if (header.payloadSize < fixedBytes || header.payloadSize > size - sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    const char* in = data + sizeof(SnapshotHeader);
+    if (fnv1a(in, header.payloadSize) != header.checksum) {
+        return false;
+    }
+
+    const char* lanes = in;
+    const int32_t* positions = (const int32_t*)(in + laneBytes);
+    const char* finished = in + laneBytes + positionBytes;
+    const PlayerRecord* records = (const PlayerRecord*)(finished + finishedBytes);
+    const char* names = (const char*)records + recordBytes;
+    size_t nameBytes = header.payloadSize - fixedBytes;
+
+    // every tile must be a known code and every position on the board (a player past the finish would never
+    // land on it); path (-1 before it is chosen) and advisor (0 = none, 1-5) index the menus' tables; a game
+    // everyone has finished has no turn left to play
+    for (size_t lane = 0; lane < header.laneCount; lane++) {
+        const unsigned char* tiles = (const unsigned char*)lanes + lane * laneStride;
+        for (uint32_t pos = 0; pos < header.laneLength; pos++) {
+            int code = (pos & 1) ? (tiles[pos >> 1] >> 4) : (tiles[pos >> 1] & 0x0F);
+            if (code >= TILE_CODE_COUNT) {
+                return false;
+            }
+        }
+        if (positions[lane] < 0 || (uint32_t)positions[lane] >= header.laneLength) {
+            return false;
+        }
+    }
+    bool anyPlaying = false;
+    for (uint32_t i = 0; i < header.playerCount; i++) {
+        const PlayerRecord& r = records[i];
+        if ((size_t)r.nameOffset + r.nameLength > nameBytes || r.position < 0 || (uint32_t)r.position >= header.laneLength ||
+            r.pathType < -1 || r.pathType > 1 || r.advisor < 0 || r.advisor > 5) {
+            return false;
+        }
+        anyPlaying = anyPlaying || finished[i] == 0;
+    }
+    if (!anyPlaying) {
+        return false;
+    }
+
+    state.board.restoreLanes(header.laneCount, header.laneLength, (const unsigned char*)lanes, positions);
+
+    state.players.resize(header.playerCount);
+    state.finished.assign(header.playerCount, false);
+    for (uint32_t i = 0; i < header.playerCount; i++) {
+        const PlayerRecord& r = records[i];
+        Player& p = state.players[i];
+        p = Player(string(names + r.nameOffset, r.nameLength), r.experience, r.accuracy, r.efficiency, r.insight, r.discoverPoints);
+        p.setPosition(r.position);
+        p.setPathType(r.pathType);
+        p.setAdvisor(r.advisor);
+        state.finished[i] = finished[i] != 0;
+    }
+
+    state.turn = header.turn;
+    state.random.setState(header.randomState);
+    return true;
+}
+
+// serialize, write everything to filename.tmp, fsync, rename into place
+bool saveSnapshot(const GameState& state, const string& filename) {
+    vector<char> buffer;
+    writeSnapshot(state, buffer);
+
+    string tempName = filename + ".tmp";
+    int fd = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+        if (n <= 0) {
+            close(fd);
+            unlink(tempName.c_str());
+            return false;
+        }
+        written += n;
+    }
+
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(tempName.c_str());
+        return false;
+    }
+    close(fd);
+
+    if (rename(tempName.c_str(), filename.c_str()) != 0) {
+        unlink(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// open and mmap the file read-only, restore from the mapping, unmap
+bool loadSnapshot(const string& filename, GameState& state) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    bool ok = readSnapshot((const char*)mapped, info.st_size, state);
+    munmap(mapped, info.st_size);
+    return ok;
+}
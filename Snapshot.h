@@ -0,0 +1,26 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include "GameState.h"
+
+using namespace std;
+
+// Binary game snapshots: lanes, positions, players, finished flags, turn and RNG state
+// Layout: SnapshotHeader, packed lane bytes, int32 positions, finished bytes,
+// PlayerRecord per player, then the character names (all padded to 8 bytes)
+static const char SNAPSHOT_MAGIC[4] = {'J', 'T', 'G', 'S'};
+static const unsigned int SNAPSHOT_VERSION = 1;
+
+// serialize a game into buffer (buffer is reused, so parking many games doesn't reallocate)
+void writeSnapshot(const GameState& state, vector<char>& buffer);
+// restore a game from snapshot bytes, returns false if the data is not a valid snapshot
+bool readSnapshot(const char* data, size_t size, GameState& state);
+
+// write snapshot to a temp file, fsync, then rename over filename so a crash never leaves half a save
+bool saveSnapshot(const GameState& state, const string& filename);
+// mmap filename and restore the game from it
+bool loadSnapshot(const string& filename, GameState& state);
+
+#endif
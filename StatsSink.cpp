@@ -0,0 +1,375 @@
+#include "StatsSink.h"
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "ResultsTable.h"
+
+using namespace std;
+
+static const char STATS_HEADER[] = "game_id,finished_at,player,character,experience,accuracy,efficiency,insight,"
+                                   "discovery_points,final_discovery_points,position,path_type,advisor,won\n";
+
+// true if an existing file starts the way open would start it: this CSV header (read through zlib, which passes
+// plain files through) or the columnar magic
+static bool hasCurrentHeader(const string& filename, bool columnar) {
+    string expected = columnar ? string(RESULTS_FILE_MAGIC, sizeof(RESULTS_FILE_MAGIC)) : string(STATS_HEADER);
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    string start(expected.size(), '\0');
+    int length = gzread(file, &start[0], start.size());
+    gzclose(file);
+    return length == (int)expected.size() && start == expected;
+}
+
+StatsSink::StatsSink() : _slots(_QUEUE_SIZE) {
+    _compress = false;
+    _columnar = false;
+    _fd = -1;
+    for (size_t i = 0; i < _QUEUE_SIZE; i++) {
+        _slots[i].sequence.store(i, memory_order_relaxed);
+    }
+    _enqueue_pos.store(0);
+    _dequeue_pos = 0;
+    _next_game_id.store(1);
+    _written.store(0);
+    _failed.store(0);
+    _producers.store(0);
+    _sleeping.store(false);
+    _running.store(false);
+}
+
+StatsSink::~StatsSink() {
+    close();
+}
+
+// open for appending, header only if the file is new (an existing file must have the same header, or rows with
+// different columns would end up under it), then start the writer
+bool StatsSink::open(const string& filename) {
+    close();
+
+    _fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        return false;
+    }
+    _filename = filename;
+    _compress = filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0;
+    _columnar = filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".col") == 0;
+
+    struct stat info;
+    bool isNew = fstat(_fd, &info) == 0 && info.st_size == 0;
+    if (!isNew && !hasCurrentHeader(filename, _columnar)) {
+        cerr << "Error: " << filename << " was written with different columns. Move it aside to start a new file." << endl;
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    if (isNew) {
+        string header = _columnar ? string(RESULTS_FILE_MAGIC, sizeof(RESULTS_FILE_MAGIC)) : string(STATS_HEADER);
+        if (!writeBlock(header, 0)) {
+            ::close(_fd);
+            _fd = -1;
+            return false;
+        }
+    }
+
+    _running.store(true);
+    _thread = thread(&StatsSink::run, this);
+    return true;
+}
+
+void StatsSink::close() {
+    if (_thread.joinable()) {
+        _running.store(false);
+        {
+            // taken so the writer is either waiting already or will see _running false before it waits
+            lock_guard<mutex> lock(_wake_mutex);
+            _wake.notify_one();
+        }
+        _thread.join();
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+// claim the next position with a CAS; if the ring is full, yield until the writer frees a slot
+// The producer count is raised before _running is checked (both sequentially consistent), so once the writer has
+// seen _running false and no producers, nobody can still enqueue and its last drain gets every row.
+void StatsSink::push(const StatsRecord& record) {
+    _producers.fetch_add(1);
+    if (!_running.load()) {
+        _producers.fetch_sub(1);
+        return;
+    }
+
+    size_t pos = _enqueue_pos.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[pos & (_QUEUE_SIZE - 1)];
+        size_t sequence = slot.sequence.load(memory_order_acquire);
+        long long diff = (long long)sequence - (long long)pos;
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(pos + 1, memory_order_release);
+                wakeWriter();
+                break;
+            }
+        } else if (diff < 0) {
+            // full while closing: give the row up (counted as failed) rather than wait on a stopping writer
+            if (!_running.load(memory_order_relaxed)) {
+                _failed.fetch_add(1);
+                break;
+            }
+            this_thread::yield();
+            pos = _enqueue_pos.load(memory_order_relaxed);
+        } else {
+            pos = _enqueue_pos.load(memory_order_relaxed);
+        }
+    }
+    _producers.fetch_sub(1);
+}
+
+// the writer says it's about to sleep, then looks at the ring once more; a producer publishes, then looks at
+// that flag (a fence on each side), so either the writer sees the record or the producer sees it sleeping
+void StatsSink::wakeWriter() {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_sleeping.load(memory_order_relaxed)) {
+        lock_guard<mutex> lock(_wake_mutex);
+        _wake.notify_one();
+    }
+}
+
+// one record per player; the winner is the player with the top final score, if nobody shares it
+uint64_t StatsSink::recordGame(const pmr::vector<Player>& players, const vector<int>& finalDP) {
+    uint64_t gameId = _next_game_id.fetch_add(1);
+    int64_t now = time(nullptr);
+    int winner = -1;
+    for (int i = 0; i < (int)players.size() && i < (int)finalDP.size(); i++) {
+        if (winner < 0 || finalDP[i] > finalDP[winner]) {
+            winner = i;
+        }
+    }
+    for (int i = 0; i < (int)players.size() && i < (int)finalDP.size(); i++) {
+        if (i != winner && winner >= 0 && finalDP[i] == finalDP[winner]) {
+            winner = -1;
+            break;
+        }
+    }
+    for (int i = 0; i < (int)players.size() && i < (int)finalDP.size(); i++) {
+        const Player& p = players[i];
+        StatsRecord record;
+        record.gameId = gameId;
+        record.finishedAt = now;
+        record.playerNumber = i + 1;
+        record.experience = p.getExperience();
+        record.accuracy = p.getAccuracy();
+        record.efficiency = p.getEfficiency();
+        record.insight = p.getInsight();
+        record.discoverPoints = p.getDiscoverPoints();
+        record.finalDiscoverPoints = finalDP[i];
+        record.position = p.getPosition();
+        record.pathType = p.getPathType();
+        record.advisor = p.getAdvisor();
+        record.won = i == winner;
+        const string& name = p.getCharacterName();
+        size_t length = name.size() < sizeof(record.characterName) - 1 ? name.size() : sizeof(record.characterName) - 1;
+        memcpy(record.characterName, name.data(), length);
+        record.characterName[length] = '\0';
+        push(record);
+    }
+    return gameId;
+}
+
+// single consumer: the slot at the dequeue position is ready once its sequence is position + 1
+bool StatsSink::isReady() const {
+    return _slots[_dequeue_pos & (_QUEUE_SIZE - 1)].sequence.load(memory_order_acquire) == _dequeue_pos + 1;
+}
+
+bool StatsSink::tryPop(StatsRecord& record) {
+    Slot& slot = _slots[_dequeue_pos & (_QUEUE_SIZE - 1)];
+    if (!isReady()) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(_dequeue_pos + _QUEUE_SIZE, memory_order_release);
+    _dequeue_pos++;
+    return true;
+}
+
+static void appendNumber(string& block, long long value, char separator) {
+    char digits[24];
+    to_chars_result result = to_chars(digits, digits + sizeof(digits), value);
+    block.append(digits, result.ptr - digits);
+    block.push_back(separator);
+}
+
+void StatsSink::appendRow(const StatsRecord& record, string& block) {
+    appendNumber(block, record.gameId, ',');
+    appendNumber(block, record.finishedAt, ',');
+    appendNumber(block, record.playerNumber, ',');
+
+    // quote the name only if CSV needs it
+    const char* name = record.characterName;
+    if (strpbrk(name, ",\"\n") != nullptr) {
+        block.push_back('"');
+        for (const char* c = name; *c != '\0'; c++) {
+            if (*c == '"') {
+                block.push_back('"');
+            }
+            block.push_back(*c);
+        }
+        block.append("\",");
+    } else {
+        block.append(name);
+        block.push_back(',');
+    }
+
+    appendNumber(block, record.experience, ',');
+    appendNumber(block, record.accuracy, ',');
+    appendNumber(block, record.efficiency, ',');
+    appendNumber(block, record.insight, ',');
+    appendNumber(block, record.discoverPoints, ',');
+    appendNumber(block, record.finalDiscoverPoints, ',');
+    appendNumber(block, record.position, ',');
+    appendNumber(block, record.pathType, ',');
+    appendNumber(block, record.advisor, ',');
+    appendNumber(block, record.won, '\n');
+}
+
+// gzip the block if compressing, write it out in full, count the rows only if all of it got there
+bool StatsSink::writeBlock(string& block, int rows) {
+    string compressed;
+    const char* data = block.data();
+    size_t size = block.size();
+
+    if (_compress) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        // windowBits 15 + 16 = gzip wrapper, level 1 because throughput matters more than ratio here
+        if (deflateInit2(&stream, 1, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+            compressed.resize(deflateBound(&stream, block.size()));
+            stream.next_in = (Bytef*)block.data();
+            stream.avail_in = block.size();
+            stream.next_out = (Bytef*)&compressed[0];
+            stream.avail_out = compressed.size();
+            deflate(&stream, Z_FINISH);
+            compressed.resize(stream.total_out);
+            deflateEnd(&stream);
+            data = compressed.data();
+            size = compressed.size();
+        }
+    }
+
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(_fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        done += n;
+    }
+
+    block.clear();
+    if (done < size) {
+        cerr << "Warning: Could not write game stats to " << _filename << " (" << rows << " rows lost)." << endl;
+        _failed.fetch_add(rows);
+        return false;
+    }
+    _written.fetch_add(rows);
+    return true;
+}
+
+// drain the ring into a block (CSV rows, or columns encoded as one row group); write when the block is full,
+// when rows have waited long enough, or at close; with nothing to do, sleep until a push or close (or until the
+// rows already in the block are due)
+void StatsSink::run() {
+    string block;
+    block.reserve(_columnar ? ResultsColumns::getMaxEncodedSize() : _BLOCK_SIZE + 256);
+    ResultsColumns columns;
+    int rows = 0;
+    chrono::steady_clock::time_point lastWrite = chrono::steady_clock::now();
+    StatsRecord record;
+
+    while (true) {
+        // stop only when no push is still in flight (see push)
+        bool stopping = !_running.load() && _producers.load() == 0;
+        int popped = 0;
+        bool full = false;
+        while (!full && tryPop(record)) {
+            if (!_columnar) {
+                appendRow(record, block);
+                full = block.size() >= _BLOCK_SIZE;
+            } else if (!columns.add(record)) {
+                // a 256th character name starts a new row group
+                columns.encode(block);
+                columns.clear();
+                columns.add(record);
+            } else {
+                full = columns.isFull();
+            }
+            rows++;
+            popped++;
+        }
+
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        chrono::steady_clock::time_point dueAt = lastWrite + chrono::milliseconds(_columnar ? _COLUMNAR_FLUSH_MS : _FLUSH_MS);
+        bool due = now >= dueAt;
+        bool pending = !block.empty() || columns.size() > 0;
+        if (full || (pending && (due || stopping))) {
+            if (columns.size() > 0) {
+                columns.encode(block);
+                columns.clear();
+            }
+            writeBlock(block, rows);
+            rows = 0;
+            lastWrite = now;
+        }
+
+        if (popped == 0) {
+            if (stopping && block.empty() && columns.size() == 0) {
+                return;
+            }
+            if (!_running.load()) {
+                // closing, but a push is still in flight
+                this_thread::yield();
+                continue;
+            }
+            unique_lock<mutex> lock(_wake_mutex);
+            _sleeping.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            if (!isReady() && _running.load()) {
+                if (!block.empty() || columns.size() > 0) {
+                    _wake.wait_until(lock, dueAt);
+                } else {
+                    _wake.wait(lock);
+                }
+            }
+            _sleeping.store(false, memory_order_relaxed);
+        }
+    }
+}
+
+const string& StatsSink::getFilename() const {
+    return _filename;
+}
+
+long long StatsSink::getWrittenCount() const {
+    return _written.load();
+}
+
+long long StatsSink::getFailedCount() const {
+    return _failed.load();
+}
@@ -0,0 +1,107 @@
+#ifndef STATSSINK_H
+#define STATSSINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Player.h"
+
+using namespace std;
+
+// StatsRecord: final stats of one player in one game, fixed size so it can sit in the queue without allocating
+struct StatsRecord {
+    uint64_t gameId;
+    int64_t finishedAt;         // unix time in seconds
+    int32_t playerNumber;       // 1-based
+    int32_t experience;
+    int32_t accuracy;
+    int32_t efficiency;
+    int32_t insight;
+    int32_t discoverPoints;
+    int32_t finalDiscoverPoints;
+    int32_t position;
+    int32_t pathType;           // 0 = Training Fellowship, 1 = Direct Lab Assignment
+    int32_t advisor;            // 0 = none
+    int32_t won;                // 1 if the player had the top final score alone
+    char characterName[32];     // truncated if longer, always null-terminated
+};
+
+// StatsSink: appends game results to a CSV file from a background thread
+// Game threads push fixed-size records into a bounded lock-free MPSC ring (no locks, no allocation);
+// the writer thread drains it, formats the rows into large blocks and writes a block at a time, and sleeps on a
+// condition variable while the ring is empty (woken by push or close, or when buffered rows are due).
+// A filename ending in ".gz" writes each block as a gzip member (the file reads back with zcat), and one
+// ending in ".col" writes columnar row groups instead of CSV (see ResultsTable, queried with the results tool).
+class StatsSink {
+    private:
+        static const size_t _QUEUE_SIZE = 1 << 16;       // records, power of two
+        static const size_t _BLOCK_SIZE = 1 << 20;       // bytes of CSV per write
+        static constexpr int _FLUSH_MS = 200;            // longest a row waits before it's written
+        static constexpr int _COLUMNAR_FLUSH_MS = 5000;  // same for .col files, where fewer, larger row groups scan faster
+
+        // Vyukov ring slot: sequence says whether the slot is free for the producer at that position
+        // or holds a record for the consumer
+        struct Slot {
+            atomic<size_t> sequence;
+            StatsRecord record;
+        };
+
+        string _filename;
+        bool _compress;
+        bool _columnar;
+        int _fd;
+        vector<Slot> _slots;
+        atomic<size_t> _enqueue_pos;
+        size_t _dequeue_pos;           // writer thread only
+        atomic<uint64_t> _next_game_id;
+        atomic<long long> _written;
+        atomic<long long> _failed;
+        atomic<bool> _running;
+        atomic<int> _producers;        // pushes in progress, close waits for them before the last drain
+        atomic<bool> _sleeping;        // the writer is (about to be) waiting on _wake
+        mutex _wake_mutex;
+        condition_variable _wake;      // signalled by push while the writer sleeps, and by close
+        thread _thread;
+
+        // true if the next record is ready to pop
+        bool isReady() const;
+        bool tryPop(StatsRecord& record);
+        // wake the writer if it's waiting for records
+        void wakeWriter();
+        // format one record as a CSV row at the end of block
+        static void appendRow(const StatsRecord& record, string& block);
+        // write block (rows = CSV rows in it) to the file (gzip member if compressing), then clear it;
+        // false (and the rows counted as failed, with a warning) if the write didn't complete
+        bool writeBlock(string& block, int rows);
+        void run();
+
+    public:
+        StatsSink();
+        ~StatsSink();
+        StatsSink(const StatsSink&) = delete;
+        StatsSink& operator=(const StatsSink&) = delete;
+
+        // open (append) filename and start the writer thread, writes the CSV header into a new file;
+        // false if an existing file starts with a different header (or isn't a columnar file, for .col)
+        bool open(const string& filename);
+        // write everything still queued and stop the writer thread
+        void close();
+
+        // queue one row per player (finalDP[i] belongs to players[i]), returns the game id
+        // only waits if the writer has fallen a whole queue behind
+        uint64_t recordGame(const pmr::vector<Player>& players, const vector<int>& finalDP);
+        void push(const StatsRecord& record);
+
+        const string& getFilename() const;
+        // rows written to the file so far
+        long long getWrittenCount() const;
+        // rows lost to write errors (each reported on cerr)
+        long long getFailedCount() const;
+};
+
+#endif
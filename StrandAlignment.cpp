@@ -0,0 +1,559 @@
+#include "StrandAlignment.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "BaseCodes.h"
+
+using namespace std;
+
+// profile symbols: the four bases, then the gap
+static const int SYMBOLS = 5;
+static const int GAP = 4;
+
+// score of one symbol against another; a base against a gap is the (linear) gap cost, a gap against a gap is free
+static const float SCORES[SYMBOLS][SYMBOLS] = {{2, -1, -1, -1, -2},
+                                               {-1, 2, -1, -1, -2},
+                                               {-1, -1, 2, -1, -2},
+                                               {-1, -1, -1, 2, -2},
+                                               {-2, -2, -2, -2, 0}};
+static const float NO_PATH = -1e30f;
+
+// per column symbol counts of a group of aligned strands (weight = strands in the group)
+struct Profile {
+    int columns;
+    float weight;
+    vector<float> counts;       // column-major, SYMBOLS per column
+};
+
+// node of the guide tree: strands 0..n-1 are the leaves, joins follow in the order they were made
+struct GuideNode {
+    int left;
+    int right;
+    int parent;
+    vector<int> gapColumns;     // columns of the parent's profile where this node's strands all have a gap
+    Profile profile;            // kept until the parent has been aligned (the root's is kept for the consensus)
+};
+
+// buffers one thread reuses for every pair of profiles it aligns
+struct AlignScratch {
+    vector<float> scoresA;      // A's columns: expected score against each symbol, SYMBOLS per column
+    vector<float> columnsB;     // B's columns as frequencies, one array per symbol (column 0 unused)
+    vector<float> leftCost;     // cost of a gap column in A opposite each column of B
+    vector<float> previous;
+    vector<float> current;
+    vector<float> best;         // best of diagonal and up, per cell of the row
+    vector<int32_t> fromUp;     // whether that was up (32-bit like the scores, so the row loop vectorizes)
+    vector<uint8_t> trace;      // 0 diagonal, 1 up (gap in B), 2 left (gap in A), per cell of the band
+    vector<uint8_t> path;
+    Profile leaves[2];
+};
+
+// shared state of the progressive alignment: nodes whose children are both aligned wait in ready
+struct AlignmentRun {
+    const vector<string>* strands;
+    vector<GuideNode>* nodes;
+    int band;
+    mutex lock;
+    condition_variable wake;
+    vector<int> ready;
+    vector<int> waiting;        // per node: children still to align
+    int remaining;              // joins not aligned yet
+    atomic<long long> cells;
+};
+
+// count every k-mer of strand (saturating), 4^k counts; returns how many k-mers it has
+static int countKmers(const string& strand, int k, int16_t* counts) {
+    const uint32_t mask = (1U << (2 * k)) - 1;
+    memset(counts, 0, sizeof(int16_t) << (2 * k));
+    uint32_t kmer = 0;
+    int valid = 0;
+    int total = 0;
+    for (char base : strand) {
+        uint32_t code = BASE_CODES[(uint8_t)base];
+        if (code > 3) {
+            valid = 0;
+            continue;
+        }
+        kmer = ((kmer << 2) | code) & mask;
+        if (++valid >= k) {
+            counts[kmer] += counts[kmer] < 32767;
+            total++;
+        }
+    }
+    return total;
+}
+
+// 1 - shared k-mers / k-mers of the strand with fewer (the sum of minimums has no branches, so it vectorizes)
+static float kmerDistance(const int16_t* a, const int16_t* b, int bins, int kmersA, int kmersB) {
+    int32_t shared = 0;
+    for (int i = 0; i < bins; i++) {
+        shared += a[i] < b[i] ? a[i] : b[i];
+    }
+    int fewest = min(kmersA, kmersB);
+    return fewest <= 0 ? 1.0f : 1.0f - (float)shared / fewest;
+}
+
+// all pairwise distances (n x n, symmetric); thread t fills rows t, t + threads, ...
+static void computeDistances(const vector<string>& strands, int k, int threads, vector<float>& distances) {
+    int n = strands.size();
+    int bins = 1 << (2 * k);
+    vector<int16_t> counts((size_t)n * bins);
+    vector<int> kmers(n);
+    distances.assign((size_t)n * n, 0.0f);
+
+    auto work = [&](int first, int step) {
+        for (int i = first; i < n; i += step) {
+            kmers[i] = countKmers(strands[i], k, &counts[(size_t)i * bins]);
+        }
+    };
+    auto pairs = [&](int first, int step) {
+        for (int i = first; i < n; i += step) {
+            for (int j = 0; j < i; j++) {
+                float d = kmerDistance(&counts[(size_t)i * bins], &counts[(size_t)j * bins], bins, kmers[i], kmers[j]);
+                distances[(size_t)i * n + j] = d;
+                distances[(size_t)j * n + i] = d;
+            }
+        }
+    };
+    for (auto stage : {0, 1}) {
+        vector<thread> workers;
+        for (int t = 1; t < threads; t++) {
+            workers.push_back(stage == 0 ? thread(work, t, threads) : thread(pairs, t, threads));
+        }
+        stage == 0 ? work(0, threads) : pairs(0, threads);
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+// UPGMA: join the two closest clusters (distance = mean over their strand pairs) until one is left
+// Every cluster keeps its nearest neighbour, so a join only rescans the rows that pointed at the joined pair.
+static int buildGuideTree(vector<float>& distances, int n, vector<GuideNode>& nodes) {
+    nodes.assign(n, GuideNode{-1, -1, -1, {}, {}});
+    vector<int> slotNode(n);
+    vector<int> slotSize(n, 1);
+    vector<int> nearest(n, -1);
+    vector<float> nearestDistance(n);
+    vector<bool> active(n, true);
+    auto distance = [&](int a, int b) -> float& {
+        return distances[(size_t)a * n + b];
+    };
+    auto findNearest = [&](int s) {
+        nearest[s] = -1;
+        nearestDistance[s] = 2.0f;
+        for (int t = 0; t < n; t++) {
+            if (t != s && active[t] && distance(s, t) < nearestDistance[s]) {
+                nearest[s] = t;
+                nearestDistance[s] = distance(s, t);
+            }
+        }
+    };
+    for (int s = 0; s < n; s++) {
+        slotNode[s] = s;
+        findNearest(s);
+    }
+
+    for (int joins = 0; joins < n - 1; joins++) {
+        int a = -1;
+        for (int s = 0; s < n; s++) {
+            if (active[s] && nearest[s] >= 0 && (a < 0 || nearestDistance[s] < nearestDistance[a])) {
+                a = s;
+            }
+        }
+        int b = nearest[a];
+        int node = nodes.size();
+        nodes.push_back(GuideNode{slotNode[a], slotNode[b], -1, {}, {}});
+        nodes[slotNode[a]].parent = node;
+        nodes[slotNode[b]].parent = node;
+
+        // the join takes slot a; b's slot is retired
+        float sizeA = slotSize[a];
+        float sizeB = slotSize[b];
+        active[b] = false;
+        for (int t = 0; t < n; t++) {
+            if (active[t] && t != a) {
+                float joined = (sizeA * distance(a, t) + sizeB * distance(b, t)) / (sizeA + sizeB);
+                distance(a, t) = joined;
+                distance(t, a) = joined;
+            }
+        }
+        slotNode[a] = node;
+        slotSize[a] += slotSize[b];
+        findNearest(a);
+        for (int t = 0; t < n; t++) {
+            if (!active[t] || t == a) {
+                continue;
+            }
+            if (nearest[t] == a || nearest[t] == b) {
+                findNearest(t);
+            } else if (distance(t, a) < nearestDistance[t]) {
+                nearest[t] = a;
+                nearestDistance[t] = distance(t, a);
+            }
+        }
+    }
+    return nodes.size() - 1;
+}
+
+// one strand as a profile: a count of 1 per base, a quarter to each base for anything else
+static void makeLeafProfile(const string& strand, Profile& profile) {
+    profile.columns = strand.size();
+    profile.weight = 1;
+    profile.counts.assign(strand.size() * SYMBOLS, 0.0f);
+    for (size_t i = 0; i < strand.size(); i++) {
+        int code = BASE_CODES[(uint8_t)strand[i]];
+        float* column = &profile.counts[i * SYMBOLS];
+        if (code < 4) {
+            column[code] = 1;
+        } else {
+            column[0] = column[1] = column[2] = column[3] = 0.25f;
+        }
+    }
+}
+
+// banded global alignment of profile a (rows) against profile b (columns), merged into merged; gapsA and gapsB
+// get the merged columns where a and b have a gap. Returns the cells filled.
+// Row i covers the columns within band of i * m / n. Each row is two passes: diagonal and up for the whole row
+// (independent cells, vectorized), then a running max that adds the left moves.
+static long long alignProfiles(const Profile& a, const Profile& b, int band, AlignScratch& scratch, Profile& merged,
+                               vector<int>& gapsA, vector<int>& gapsB) {
+    const int n = a.columns;
+    const int m = b.columns;
+    const int slope = n == 0 ? m : (m + n - 1) / n;
+    const int half = max(band, slope + 1);
+    const int width = 2 * half + 1;
+    auto rowLow = [&](int i) {
+        long long center = n == 0 ? 0 : (long long)i * m / n;
+        return (int)max(0LL, min((long long)m, center - half));
+    };
+    auto rowHigh = [&](int i) {
+        long long center = n == 0 ? m : (long long)i * m / n;
+        return (int)max(0LL, min((long long)m, center + half));
+    };
+
+    // expected score of each of a's columns against every symbol, b's columns as frequencies
+    scratch.scoresA.resize((size_t)(n + 1) * SYMBOLS);
+    for (int i = 1; i <= n; i++) {
+        const float* column = &a.counts[(size_t)(i - 1) * SYMBOLS];
+        for (int s = 0; s < SYMBOLS; s++) {
+            float score = 0;
+            for (int t = 0; t < SYMBOLS; t++) {
+                score += column[t] * SCORES[t][s];
+            }
+            scratch.scoresA[(size_t)i * SYMBOLS + s] = score / a.weight;
+        }
+    }
+    scratch.columnsB.assign((size_t)SYMBOLS * (m + 1), 0.0f);
+    scratch.leftCost.assign(m + 1, 0.0f);
+    for (int j = 1; j <= m; j++) {
+        const float* column = &b.counts[(size_t)(j - 1) * SYMBOLS];
+        for (int s = 0; s < SYMBOLS; s++) {
+            scratch.columnsB[(size_t)s * (m + 1) + j] = column[s] / b.weight;
+            scratch.leftCost[j] += column[s] / b.weight * SCORES[GAP][s];
+        }
+    }
+    const float* b0 = &scratch.columnsB[0];
+    const float* b1 = b0 + (m + 1);
+    const float* b2 = b1 + (m + 1);
+    const float* b3 = b2 + (m + 1);
+    const float* b4 = b3 + (m + 1);
+
+    // rows live at index 1 + (j - low); index 0 and everything past the row's end is NO_PATH (so column 0's diagonal,
+    // where b's column 0 is all zeros, never wins)
+    const int rowSize = width + slope + 2;
+    scratch.previous.assign(rowSize, NO_PATH);
+    scratch.current.assign(rowSize, NO_PATH);
+    scratch.best.resize(width);
+    scratch.fromUp.resize(width);
+    scratch.trace.resize((size_t)(n + 1) * width);
+    float* previous = scratch.previous.data();
+    float* current = scratch.current.data();
+    float* best = scratch.best.data();
+    int32_t* fromUp = scratch.fromUp.data();
+
+    int high = rowHigh(0);
+    float running = 0;
+    for (int j = 0; j <= high; j++) {
+        running += scratch.leftCost[j];
+        previous[1 + j] = running;
+        scratch.trace[j] = 2;
+    }
+    long long cells = high + 1;
+    int previousLow = 0;
+
+    for (int i = 1; i <= n; i++) {
+        const int low = rowLow(i);
+        high = rowHigh(i);
+        const int count = high - low + 1;
+        const float* s = &scratch.scoresA[(size_t)i * SYMBOLS];
+        const float s0 = s[0], s1 = s[1], s2 = s[2], s3 = s[3], s4 = s[4];
+        const float up = s[GAP];
+        const float* diagonal = previous + (low - previousLow);
+        const float* above = diagonal + 1;
+        const int j0 = low;
+
+        for (int t = 0; t < count; t++) {
+            int j = j0 + t;
+            float match = s0 * b0[j] + s1 * b1[j] + s2 * b2[j] + s3 * b3[j] + s4 * b4[j];
+            float d = diagonal[t] + match;
+            float u = above[t] + up;
+            best[t] = d >= u ? d : u;
+            fromUp[t] = d < u;
+        }
+
+        uint8_t* trace = &scratch.trace[(size_t)i * width];
+        const float* leftCost = &scratch.leftCost[low];
+        float left = NO_PATH;
+        for (int t = 0; t < count; t++) {
+            float h = best[t];
+            float l = left + leftCost[t];
+            uint8_t move = fromUp[t];
+            if (l > h) {
+                h = l;
+                move = 2;
+            }
+            current[1 + t] = h;
+            trace[t] = move;
+            left = h;
+        }
+        current[0] = NO_PATH;
+        fill(current + 1 + count, current + rowSize, NO_PATH);
+        previousLow = low;
+        swap(previous, current);
+        cells += count;
+    }
+
+    // walk back from the corner, then replay forwards into the merged profile
+    scratch.path.clear();
+    int i = n;
+    int j = m;
+    while (i > 0 || j > 0) {
+        uint8_t move = i == 0 ? 2 : (j == 0 ? 1 : scratch.trace[(size_t)i * width + (j - rowLow(i))]);
+        scratch.path.push_back(move);
+        i -= move != 2;
+        j -= move != 1;
+    }
+    reverse(scratch.path.begin(), scratch.path.end());
+
+    merged.columns = scratch.path.size();
+    merged.weight = a.weight + b.weight;
+    merged.counts.assign((size_t)merged.columns * SYMBOLS, 0.0f);
+    gapsA.clear();
+    gapsB.clear();
+    i = 0;
+    j = 0;
+    for (int c = 0; c < merged.columns; c++) {
+        float* column = &merged.counts[(size_t)c * SYMBOLS];
+        uint8_t move = scratch.path[c];
+        if (move != 2) {
+            const float* from = &a.counts[(size_t)i++ * SYMBOLS];
+            for (int t = 0; t < SYMBOLS; t++) {
+                column[t] += from[t];
+            }
+        } else {
+            column[GAP] += a.weight;
+            gapsA.push_back(c);
+        }
+        if (move != 1) {
+            const float* from = &b.counts[(size_t)j++ * SYMBOLS];
+            for (int t = 0; t < SYMBOLS; t++) {
+                column[t] += from[t];
+            }
+        } else {
+            column[GAP] += b.weight;
+            gapsB.push_back(c);
+        }
+    }
+    return cells;
+}
+
+// align one join's children (leaves are turned into profiles here) and drop their profiles
+static void alignNode(AlignmentRun& run, int node, AlignScratch& scratch) {
+    vector<GuideNode>& nodes = *run.nodes;
+    GuideNode& join = nodes[node];
+    const Profile* children[2];
+    int childIds[2] = {join.left, join.right};
+    for (int c = 0; c < 2; c++) {
+        GuideNode& child = nodes[childIds[c]];
+        if (child.left < 0) {
+            makeLeafProfile((*run.strands)[childIds[c]], scratch.leaves[c]);
+            children[c] = &scratch.leaves[c];
+        } else {
+            children[c] = &child.profile;
+        }
+    }
+    long long cells = alignProfiles(*children[0], *children[1], run.band, scratch, join.profile,
+                                    nodes[join.left].gapColumns, nodes[join.right].gapColumns);
+    run.cells += cells;
+    for (int c = 0; c < 2; c++) {
+        nodes[childIds[c]].profile = Profile();
+    }
+}
+
+// take ready joins until every join is aligned; finishing a join may make its parent ready
+static void runAlignmentWorker(AlignmentRun& run) {
+    AlignScratch scratch;
+    while (true) {
+        int node;
+        {
+            unique_lock<mutex> guard(run.lock);
+            run.wake.wait(guard, [&] {
+                return !run.ready.empty() || run.remaining == 0;
+            });
+            if (run.ready.empty()) {
+                return;
+            }
+            node = run.ready.back();
+            run.ready.pop_back();
+        }
+        alignNode(run, node, scratch);
+        {
+            lock_guard<mutex> guard(run.lock);
+            run.remaining--;
+            int parent = (*run.nodes)[node].parent;
+            if (parent >= 0 && --run.waiting[parent] == 0) {
+                run.ready.push_back(parent);
+            }
+        }
+        run.wake.notify_all();
+    }
+}
+
+// PUBLIC FUNCTIONS
+
+double StrandAlignment::getMeanConservation() const {
+    double total = 0;
+    for (float value : conservation) {
+        total += value;
+    }
+    return conservation.empty() ? 0.0 : total / conservation.size();
+}
+
+void alignStrands(const vector<string>& strands, const AlignmentOptions& options, StrandAlignment& alignment) {
+    int n = strands.size();
+    int threads = options.threads > 0 ? options.threads : max(1, (int)thread::hardware_concurrency());
+    int k = max(1, min(7, options.k));
+    alignment.rows.assign(n, string());
+    alignment.columnSymbols.clear();
+    alignment.conservation.clear();
+    alignment.consensus.clear();
+    alignment.cells = 0;
+    alignment.treeSeconds = 0;
+    alignment.alignSeconds = 0;
+    if (n == 0) {
+        return;
+    }
+
+    // guide tree
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<GuideNode> nodes;
+    int root = 0;
+    if (n == 1) {
+        nodes.assign(1, GuideNode{-1, -1, -1, {}, {}});
+    } else {
+        vector<float> distances;
+        computeDistances(strands, k, threads, distances);
+        root = buildGuideTree(distances, n, nodes);
+    }
+    chrono::steady_clock::time_point treeDone = chrono::steady_clock::now();
+    alignment.treeSeconds = chrono::duration<double>(treeDone - start).count();
+
+    // progressive alignment: joins of two strands are ready first
+    AlignmentRun run;
+    run.strands = &strands;
+    run.nodes = &nodes;
+    run.band = max(1, options.band);
+    run.waiting.assign(nodes.size(), 0);
+    run.remaining = nodes.size() - n;
+    run.cells = 0;
+    for (int node = n; node < (int)nodes.size(); node++) {
+        run.waiting[node] = (nodes[nodes[node].left].left >= 0) + (nodes[nodes[node].right].left >= 0);
+        if (run.waiting[node] == 0) {
+            run.ready.push_back(node);
+        }
+    }
+    if (n == 1) {
+        makeLeafProfile(strands[0], nodes[0].profile);
+    } else {
+        vector<thread> workers;
+        for (int t = 1; t < min(threads, n - 1); t++) {
+            workers.push_back(thread(runAlignmentWorker, ref(run)));
+        }
+        runAlignmentWorker(run);
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+    alignment.cells = run.cells;
+
+    // top-down: each node's columns in root columns, its parent's minus the gap columns the node was given
+    const Profile& profile = nodes[root].profile;
+    vector<vector<int>> toRoot(nodes.size());
+    toRoot[root].resize(profile.columns);
+    for (int c = 0; c < profile.columns; c++) {
+        toRoot[root][c] = c;
+    }
+    auto writeRow = [&](int leaf) {
+        string& row = alignment.rows[leaf];
+        row.assign(profile.columns, '-');
+        for (size_t c = 0; c < strands[leaf].size(); c++) {
+            row[toRoot[leaf][c]] = strands[leaf][c];
+        }
+        vector<int>().swap(toRoot[leaf]);
+    };
+    vector<int> stack(1, root);
+    if (nodes[root].left < 0) {
+        writeRow(root);
+        stack.clear();
+    }
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        for (int child : {nodes[node].left, nodes[node].right}) {
+            const vector<int>& gaps = nodes[child].gapColumns;
+            vector<int>& columns = toRoot[child];
+            columns.reserve(toRoot[node].size() - gaps.size());
+            size_t g = 0;
+            for (int c = 0; c < (int)toRoot[node].size(); c++) {
+                if (g < gaps.size() && gaps[g] == c) {
+                    g++;
+                } else {
+                    columns.push_back(toRoot[node][c]);
+                }
+            }
+            // leaves are written straight away, so only joins wait on the stack
+            if (nodes[child].left < 0) {
+                writeRow(child);
+            } else {
+                stack.push_back(child);
+            }
+        }
+        vector<int>().swap(toRoot[node]);
+    }
+
+    // consensus: the most common symbol of every column, and the share of strands that have it
+    static const char SYMBOL_CHARS[SYMBOLS] = {'A', 'C', 'G', 'T', '-'};
+    alignment.columnSymbols.resize(profile.columns);
+    alignment.conservation.resize(profile.columns);
+    for (int c = 0; c < profile.columns; c++) {
+        const float* column = &profile.counts[(size_t)c * SYMBOLS];
+        int top = 0;
+        for (int s = 1; s < SYMBOLS; s++) {
+            if (column[s] > column[top]) {
+                top = s;
+            }
+        }
+        alignment.columnSymbols[c] = SYMBOL_CHARS[top];
+        alignment.conservation[c] = column[top] / profile.weight;
+        if (top != GAP) {
+            alignment.consensus.push_back(SYMBOL_CHARS[top]);
+        }
+    }
+    alignment.alignSeconds = chrono::duration<double>(chrono::steady_clock::now() - treeDone).count();
+}
@@ -0,0 +1,43 @@
+#ifndef STRANDALIGNMENT_H
+#define STRANDALIGNMENT_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// how alignStrands works: k-mer length of the guide tree distances, half-width of the DP band, threads
+struct AlignmentOptions {
+    int k;              // 1-7 (4^k counts per strand)
+    int band;           // columns either side of the diagonal the DP looks at (widened for very unequal profiles)
+    int threads;        // 0 = one per hardware thread
+
+    AlignmentOptions() : k(6), band(64), threads(0) {
+    }
+};
+
+// a multiple alignment of strands: one gapped row per strand (input order), all the same length, and per column
+// the most common symbol ('-' if gaps outnumber every base) and the share of strands that have it
+struct StrandAlignment {
+    vector<string> rows;
+    string columnSymbols;
+    vector<float> conservation;
+    string consensus;               // columnSymbols without the gap columns
+    long long cells;                // DP cells filled
+    double treeSeconds;             // k-mer counts, distances and the guide tree
+    double alignSeconds;            // progressive alignment up the tree
+
+    // mean conservation over the columns
+    double getMeanConservation() const;
+};
+
+// progressive multiple alignment:
+// 1. every strand's k-mer counts, then the share of k-mers each pair has in common as their distance
+// 2. a guide tree joining the closest strands and groups first (UPGMA)
+// 3. up the tree, each node's two child profiles (per column counts of A, C, G, T and gaps) aligned by a banded
+//    DP and merged; independent subtrees are aligned on different threads as soon as both children are done
+// 4. the gap columns every node added, applied top-down to give each strand its row
+// Bases other than A/C/G/T (any case) count a quarter to each base; rows keep the strands' own characters.
+void alignStrands(const vector<string>& strands, const AlignmentOptions& options, StrandAlignment& alignment);
+
+#endif
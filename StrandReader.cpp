@@ -0,0 +1,118 @@
+#include "StrandReader.h"
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+// CONSTRUCTORS
+
+StrandReader::StrandReader() : _buffer(1 << 20) {
+    _file = nullptr;
+    _position = 0;
+    _filled = 0;
+    _line_number = 0;
+    _has_pending = false;
+    _done = true;
+}
+
+StrandReader::~StrandReader() {
+    close();
+}
+
+// PRIVATE MEMBER FUNCTIONS
+
+// copy up to the next newline, refilling the buffer as often as the line needs
+bool StrandReader::readLine(string& line) {
+    line.clear();
+    while (!_done) {
+        if (_position == _filled) {
+            int n = gzread(_file, _buffer.data(), _buffer.size());
+            if (n <= 0) {
+                _done = true;
+                break;
+            }
+            _position = 0;
+            _filled = n;
+        }
+        const char* start = _buffer.data() + _position;
+        const char* newline = (const char*)memchr(start, '\n', _filled - _position);
+        if (newline == nullptr) {
+            line.append(start, _filled - _position);
+            _position = _filled;
+            continue;
+        }
+        line.append(start, newline - start);
+        _position = newline - _buffer.data() + 1;
+        break;
+    }
+    if (_done && line.empty()) {
+        return false;
+    }
+    _line_number++;
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+// the first word of the header line in _line names the next record
+void StrandReader::takeHeader() {
+    size_t end = _line.find_first_of(" \t");
+    _pending_name.assign(_line, 1, end == string::npos ? string::npos : end - 1);
+    _has_pending = true;
+}
+
+// PUBLIC MEMBER FUNCTIONS
+
+// zlib reads plain files as they are, so one path handles both
+bool StrandReader::open(const string& filename) {
+    close();
+    _file = filename == "-" ? gzdopen(dup(STDIN_FILENO), "rb") : gzopen(filename.c_str(), "rb");
+    if (_file == nullptr) {
+        return false;
+    }
+    _position = 0;
+    _filled = 0;
+    _line_number = 0;
+    _has_pending = false;
+    _done = false;
+    return true;
+}
+
+void StrandReader::close() {
+    if (_file != nullptr) {
+        gzclose(_file);
+        _file = nullptr;
+    }
+    _done = true;
+}
+
+// FASTA: the header's first word names the record and its lines up to the next header are the sequence;
+// anything else: every non-empty line is a strand of its own, named by its line number
+bool StrandReader::next(string& name, string& sequence) {
+    sequence.clear();
+    if (!_has_pending) {
+        do {
+            if (!readLine(_line)) {
+                return false;
+            }
+        } while (_line.empty());
+        if (_line[0] != '>') {
+            name = to_string(_line_number);
+            sequence.swap(_line);
+            return true;
+        }
+        takeHeader();
+    }
+    name.assign(_pending_name);
+    _has_pending = false;
+
+    while (readLine(_line)) {
+        if (!_line.empty() && _line[0] == '>') {
+            takeHeader();
+            return true;
+        }
+        sequence.append(_line);
+    }
+    return true;
+}
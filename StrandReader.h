@@ -0,0 +1,42 @@
+#ifndef STRANDREADER_H
+#define STRANDREADER_H
+
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+using namespace std;
+
+// StrandReader: reads strands from FASTA (">name" lines, sequence over any number of lines) or plain text (one
+// strand per line, named by line number), gzip-compressed or not, a megabyte at a time
+// The sequence buffer is reused, so a stream of strands doesn't allocate once it has reached the longest one.
+class StrandReader {
+    private:
+        gzFile _file;
+        vector<char> _buffer;
+        size_t _position;
+        size_t _filled;
+        long long _line_number;
+        string _line;
+        string _pending_name;       // FASTA header already read for the next record
+        bool _has_pending;
+        bool _done;
+
+        // next line (without the newline) into line, false at end of file
+        bool readLine(string& line);
+        void takeHeader();
+
+    public:
+        StrandReader();
+        ~StrandReader();
+        StrandReader(const StrandReader&) = delete;
+        StrandReader& operator=(const StrandReader&) = delete;
+
+        // "-" reads standard input
+        bool open(const string& filename);
+        void close();
+        // next strand into name and sequence, false at end of file
+        bool next(string& name, string& sequence);
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "Trace.h"
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+#ifdef GENOME_TRACE
+
+#include <atomic>
+#include <chrono>
+
+// ThreadTrace: one thread's ring of spans, linked into a global list the first time the thread traces
+// Rings are never freed, so spans of threads that have exited can still be exported.
+struct ThreadTrace {
+    static const size_t RING_SIZE = 1 << 16;     // spans, power of two
+
+    TraceEvent events[RING_SIZE];
+    atomic<uint64_t> written;                    // spans ever recorded, the next goes to written % RING_SIZE
+    int threadNumber;
+    ThreadTrace* next;
+};
+
+static atomic<ThreadTrace*> traceThreads(nullptr);
+static atomic<int> traceThreadCount(0);
+
+static int64_t traceNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the calling thread's ring, created and pushed onto the list (CAS) on first use
+static ThreadTrace* currentThreadTrace() {
+    thread_local ThreadTrace* trace = nullptr;
+    if (trace == nullptr) {
+        trace = new ThreadTrace();
+        trace->written.store(0);
+        trace->threadNumber = traceThreadCount.fetch_add(1) + 1;
+        trace->next = traceThreads.load();
+        while (!traceThreads.compare_exchange_weak(trace->next, trace)) {
+        }
+    }
+    return trace;
+}
+
+TraceSpan::TraceSpan(const char* name) {
+    _name = name;
+    _arg = -1;
+    _start = traceNow();
+}
+
+// single producer per ring: fill the slot, then publish it by bumping the count
+TraceSpan::~TraceSpan() {
+    ThreadTrace* trace = currentThreadTrace();
+    uint64_t index = trace->written.load(memory_order_relaxed);
+    TraceEvent& event = trace->events[index & (ThreadTrace::RING_SIZE - 1)];
+    event.name = _name;
+    event.start = _start;
+    event.duration = traceNow() - _start;
+    event.arg = _arg;
+    trace->written.store(index + 1, memory_order_release);
+}
+
+bool isTracingCompiled() {
+    return true;
+}
+
+// complete ("X") events, microsecond timestamps relative to the earliest span, one tid per thread
+bool writeChromeTrace(const string& filename) {
+    ofstream out(filename);
+    if (!out) {
+        return false;
+    }
+
+    int64_t origin = -1;
+    for (ThreadTrace* trace = traceThreads.load(); trace != nullptr; trace = trace->next) {
+        uint64_t written = trace->written.load(memory_order_acquire);
+        uint64_t first = written > ThreadTrace::RING_SIZE ? written - ThreadTrace::RING_SIZE : 0;
+        for (uint64_t i = first; i < written; i++) {
+            int64_t start = trace->events[i & (ThreadTrace::RING_SIZE - 1)].start;
+            if (origin < 0 || start < origin) {
+                origin = start;
+            }
+        }
+    }
+
+    out << fixed << setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool firstEvent = true;
+    for (ThreadTrace* trace = traceThreads.load(); trace != nullptr; trace = trace->next) {
+        uint64_t written = trace->written.load(memory_order_acquire);
+        uint64_t first = written > ThreadTrace::RING_SIZE ? written - ThreadTrace::RING_SIZE : 0;
+        for (uint64_t i = first; i < written; i++) {
+            const TraceEvent& event = trace->events[i & (ThreadTrace::RING_SIZE - 1)];
+            out << (firstEvent ? "\n" : ",\n");
+            firstEvent = false;
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace->threadNumber
+                << ",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << event.duration / 1000.0;
+            if (event.arg >= 0) {
+                out << ",\"args\":{\"value\":" << event.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
+
+#else
+
+bool isTracingCompiled() {
+    return false;
+}
+
+bool writeChromeTrace(const string&) {
+    return false;
+}
+
+#endif
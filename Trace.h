@@ -0,0 +1,61 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Turn tracing: scoped spans recorded per thread and exported in Chrome trace-event format
+// (open the file in chrome://tracing or ui.perfetto.dev)
+// Spans only exist in builds with -DGENOME_TRACE; otherwise TRACE_SPAN and TRACE_ARG expand to nothing
+// and cost nothing. Each thread records into its own fixed ring (no locks, no allocation after the
+// thread's first span); when a ring is full the oldest spans are overwritten.
+//   TRACE_SPAN("name")   time from here to the end of the enclosing scope (one per scope)
+//   TRACE_ARG(value)     attach a number to that span, e.g. an input length
+
+// one finished span
+struct TraceEvent {
+    const char* name;       // string literal
+    int64_t start;          // ns, steady clock
+    int64_t duration;       // ns
+    int64_t arg;            // -1 = none
+};
+
+#ifdef GENOME_TRACE
+
+// TraceSpan: records its lifetime as one event in the current thread's ring
+class TraceSpan {
+    private:
+        const char* _name;
+        int64_t _start;
+        int64_t _arg;
+
+    public:
+        TraceSpan(const char* name);
+        ~TraceSpan();
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+        void setArg(int64_t arg) {
+            _arg = arg;
+        }
+};
+
+#define TRACE_SPAN(name) TraceSpan _trace_span(name)
+#define TRACE_ARG(value) _trace_span.setArg(value)
+
+#else
+
+#define TRACE_SPAN(name) ((void)0)
+#define TRACE_ARG(value) ((void)0)
+
+#endif
+
+// true if this build records spans
+bool isTracingCompiled();
+// write every thread's recorded spans as Chrome trace JSON, false if tracing is compiled out or the
+// file can't be written (call once the traced work has stopped, a ring being written can tear)
+bool writeChromeTrace(const string& filename);
+
+#endif
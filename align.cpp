@@ -0,0 +1,149 @@
+// Multiple alignment of related strands, with a consensus strand and per-column conservation
+// Usage: ./align FILE... [--aligned OUT] [--consensus OUT] [--conservation OUT] [--k N] [--band W] [--threads N]
+//   FILE            strands to align (FASTA or one strand per line, .gz or plain; "-" reads standard input)
+//   --aligned       write the alignment as FASTA, one gapped row per strand in input order
+//   --consensus     write the consensus strand as FASTA (the most common base of every column that isn't mostly gaps)
+//   --conservation  write one line per alignment column: column number, most common symbol, share of strands with it
+//   --k             k-mer length for the guide tree distances, 1-7 (default 6)
+//   --band          DP band: columns either side of the diagonal each profile alignment looks at (default 64)
+//   --threads       threads for the distances and for aligning independent subtrees (default: one per core)
+// Prints the strand and column counts, the time spent on the guide tree and on the alignment, and the mean
+// conservation.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "StrandAlignment.h"
+#include "StrandReader.h"
+
+using namespace std;
+
+// write to a temp file, then rename over filename
+static bool writeFileAtomically(const string& filename, const string& text) {
+    string tempName = filename + ".tmp";
+    ofstream file(tempName, ios::binary | ios::trunc);
+    file.write(text.data(), text.size());
+    if (!file.flush()) {
+        file.close();
+        remove(tempName.c_str());
+        return false;
+    }
+    file.close();
+    if (rename(tempName.c_str(), filename.c_str()) != 0) {
+        remove(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// FASTA record with the sequence wrapped at 80 columns
+static void appendFasta(string& text, const string& name, const string& sequence) {
+    text += ">" + name + "\n";
+    for (size_t i = 0; i < sequence.size(); i += 80) {
+        text.append(sequence, i, 80);
+        text += "\n";
+    }
+}
+
+// parse arguments, read every strand, align, write what was asked for
+int main(int argc, char* argv[]) {
+    vector<string> files;
+    string alignedFile = "";
+    string consensusFile = "";
+    string conservationFile = "";
+    AlignmentOptions options;
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--aligned" && i + 1 < argc) {
+            alignedFile = argv[++i];
+        } else if (arg == "--consensus" && i + 1 < argc) {
+            consensusFile = argv[++i];
+        } else if (arg == "--conservation" && i + 1 < argc) {
+            conservationFile = argv[++i];
+        } else if (arg == "--k" && i + 1 < argc) {
+            options.k = atoi(argv[++i]);
+        } else if (arg == "--band" && i + 1 < argc) {
+            options.band = atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            valid = false;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (!valid || files.empty() || options.k < 1 || options.k > 7 || options.band < 1 || options.threads < 0) {
+        cout << "Usage: ./align FILE... [--aligned OUT] [--consensus OUT] [--conservation OUT] [--k N] [--band W] [--threads N]" << endl;
+        return 1;
+    }
+
+    vector<string> names;
+    vector<string> strands;
+    StrandReader reader;
+    string name;
+    string sequence;
+    long long bases = 0;
+    for (const string& file : files) {
+        if (!reader.open(file)) {
+            cout << "Error: Could not open " << file << endl;
+            return 1;
+        }
+        while (reader.next(name, sequence)) {
+            names.push_back(name);
+            strands.push_back(sequence);
+            bases += sequence.size();
+        }
+    }
+    if (strands.empty()) {
+        cout << "Error: No strands to align." << endl;
+        return 1;
+    }
+
+    StrandAlignment alignment;
+    alignStrands(strands, options, alignment);
+    int columns = alignment.columnSymbols.size();
+    cout << "Aligned " << strands.size() << " strands (" << bases << " bases) into " << columns << " columns" << endl;
+    cout << "Guide tree: " << alignment.treeSeconds << " s; alignment: " << alignment.alignSeconds << " s ("
+         << alignment.cells << " DP cells, " << (long long)(alignment.cells / max(alignment.alignSeconds, 1e-9) / 1e6)
+         << " M cells/s)" << endl;
+    cout << "Consensus: " << alignment.consensus.size() << " bases, mean conservation "
+         << alignment.getMeanConservation() * 100 << "%" << endl;
+
+    if (!alignedFile.empty()) {
+        string text;
+        text.reserve((size_t)strands.size() * (columns + columns / 80 + 64));
+        for (size_t i = 0; i < strands.size(); i++) {
+            appendFasta(text, names[i], alignment.rows[i]);
+        }
+        if (!writeFileAtomically(alignedFile, text)) {
+            cout << "Error: Could not write " << alignedFile << endl;
+            return 1;
+        }
+    }
+    if (!consensusFile.empty()) {
+        string text;
+        appendFasta(text, "consensus strands=" + to_string(strands.size()), alignment.consensus);
+        if (!writeFileAtomically(consensusFile, text)) {
+            cout << "Error: Could not write " << consensusFile << endl;
+            return 1;
+        }
+    }
+    if (!conservationFile.empty()) {
+        string text;
+        char line[64];
+        for (int c = 0; c < columns; c++) {
+            int length = snprintf(line, sizeof(line), "%d\t%c\t%.4f\n", c + 1, alignment.columnSymbols[c],
+                                  alignment.conservation[c]);
+            text.append(line, length);
+        }
+        if (!writeFileAtomically(conservationFile, text)) {
+            cout << "Error: Could not write " << conservationFile << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,627 @@
+// Microbenchmarks for the DNA kernels (and a result cache hit), k-mer screening, multiple alignment, sequence
+// composition, board generation and display, simulated board turns on runtime-sized and fixed-size boards, riddle
+// answers and whole game turns
+// Usage: ./bench [--max-bases N] [--filter TEXT] [--json FILE] [--baseline FILE] [--tolerance PCT]
+//   --max-bases  largest strand length for the kernel benchmarks (default 10000000; sizes are 10, 1000, 100000, 10000000)
+//   --filter     only run benchmarks whose name contains TEXT
+//   --json       write the results to FILE (one benchmark per line, so files diff cleanly)
+//   --baseline   compare with a JSON file written by --json, exit with status 1 if any benchmark is more than
+//                --tolerance percent slower per operation (default 20)
+// Every benchmark is calibrated to batches of at least 20 ms and reports the median of 5 batches:
+// time per call, time per item (base, tile, char, riddle or turn), items per second and heap allocations per call.
+// Kernel strands are random; the second strand of a pair differs from the first in 1% of its bases.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "Board.h"
+#include "ContentStore.h"
+#include "FixedBoard.h"
+#include "Game.h"
+#include "KmerFilter.h"
+#include "GameState.h"
+#include "Random.h"
+#include "ResultsTable.h"
+#include "ResultCache.h"
+#include "RiddleBank.h"
+#include "ScriptedIO.h"
+#include "SequenceComposition.h"
+#include "StrandAlignment.h"
+
+using namespace std;
+
+// shortest batch worth timing, and batches per benchmark
+static const double MIN_BATCH_SECONDS = 0.02;
+static const int BATCHES = 5;
+
+// same turn answers as simulate: move forward, then two strands for whichever task comes up
+static const char TURN_SCRIPT[] = "5\nACGTACGTACGTACGTACGTACGT\nACGTACGTACGAACGTACGTACGT\n";
+
+// one measured benchmark
+struct BenchResult {
+    string name;
+    long long size;             // strand length, tiles on the board or players in the game
+    string unit;                // what an item is: base, tile or turn
+    long long itemsPerCall;
+    double nsPerCall;
+    double allocationsPerCall;
+};
+
+// results feed this so the compiler can't drop the calls being timed
+static volatile long long benchSink = 0;
+
+string randomStrand(Random& random, long long length) {
+    static const char BASES[] = {'A', 'C', 'G', 'T'};
+    string strand(length, 'A');
+    for (long long i = 0; i < length; i++) {
+        strand[i] = BASES[random.nextInt(4)];
+    }
+    return strand;
+}
+
+// copy of strand with about 1% of its bases substituted (at least one)
+string mutateStrand(Random& random, const string& strand) {
+    string mutated = strand;
+    long long changes = strand.length() / 100 + 1;
+    for (long long i = 0; i < changes; i++) {
+        long long pos = (long long)(random.next() % strand.length());
+        mutated[pos] = mutated[pos] == 'A' ? 'C' : 'A';
+    }
+    return mutated;
+}
+
+// synthetic riddle bank: questions of random words, answers drawn from a smaller pool, with about 1% exact
+// and 1% near repeats (one word changed) of earlier riddles; text holds the strings the riddles point into
+void makeRiddleBank(Random& random, int count, vector<string>& text, vector<Riddle>& riddles) {
+    static const char* const WORDS[] = {"strand", "gene", "loop", "cell", "base", "pair", "code", "lab", "data", "read",
+                                        "what", "am", "i", "the", "of", "and", "in", "every", "never", "always"};
+    text.assign(2 * count, string());
+    riddles.assign(count, Riddle());
+    for (int i = 0; i < count; i++) {
+        int roll = random.nextInt(100);
+        if (i > 0 && roll < 2) {
+            int original = random.nextInt(i);
+            text[2 * i] = text[2 * original];
+            if (roll == 1) {
+                text[2 * i].replace(0, text[2 * i].find(' '), "cell");
+            }
+            text[2 * i + 1] = text[2 * original + 1];
+        } else {
+            for (int w = 0; w < 14; w++) {
+                text[2 * i] += string(w == 0 ? "" : " ") + WORDS[random.nextInt(20)];
+            }
+            text[2 * i] += " #" + to_string(i);
+            text[2 * i + 1] = "answer" + to_string(random.nextInt(count / 4 + 1));
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        riddles[i].question = text[2 * i];
+        riddles[i].answer = text[2 * i + 1];
+    }
+}
+
+// grow the batch until it takes MIN_BATCH_SECONDS, then time BATCHES batches and keep the median
+BenchResult runBenchmark(const string& name, long long size, const string& unit, long long itemsPerCall,
+                         const function<void(long long)>& calls) {
+    long long iterations = 1;
+    while (true) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        calls(iterations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds >= MIN_BATCH_SECONDS) {
+            break;
+        }
+        iterations *= seconds * 10 < MIN_BATCH_SECONDS ? 10 : 2;
+    }
+
+    vector<double> batches;
+    batches.reserve(BATCHES);
+    long long allocationsBefore = getAllocationCount();
+    for (int b = 0; b < BATCHES; b++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        calls(iterations);
+        batches.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations);
+    }
+    long long allocations = getAllocationCount() - allocationsBefore;
+    sort(batches.begin(), batches.end());
+
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.unit = unit;
+    result.itemsPerCall = itemsPerCall;
+    result.nsPerCall = batches[BATCHES / 2];
+    result.allocationsPerCall = (double)allocations / (iterations * BATCHES);
+    return result;
+}
+
+void printResult(const BenchResult& result) {
+    double nsPerItem = result.nsPerCall / result.itemsPerCall;
+    cout << left << setw(20) << result.name << right << setw(10) << result.size << " " << left << setw(5) << result.unit
+         << right << fixed << setprecision(1) << setw(14) << result.nsPerCall << " ns" << setprecision(3) << setw(10)
+         << nsPerItem << " ns/" << left << setw(5) << result.unit << right << setprecision(1) << setw(10)
+         << 1e3 / nsPerItem << " M" << result.unit << "/s" << setprecision(2) << setw(8) << result.allocationsPerCall
+         << " allocs" << endl;
+    cout << defaultfloat << setprecision(6);
+}
+
+// {"benchmarks": [ one object per line ]}
+bool writeJson(const string& filename, const vector<BenchResult>& results) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "{\"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        file << "  {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"unit\": \"" << r.unit
+             << "\", \"ns_per_op\": " << r.nsPerCall << ", \"ns_per_item\": " << r.nsPerCall / r.itemsPerCall
+             << ", \"items_per_second\": " << (long long)(r.itemsPerCall * 1e9 / r.nsPerCall)
+             << ", \"allocations_per_op\": " << r.allocationsPerCall << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "]}\n";
+    return (bool)file;
+}
+
+// value after "key": on a line written by writeJson
+static string jsonField(const string& line, const string& key) {
+    size_t pos = line.find("\"" + key + "\": ");
+    if (pos == string::npos) {
+        return "";
+    }
+    pos += key.length() + 4;
+    if (line[pos] == '"') {
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+// print every benchmark that is in both runs, regressed if one got more than tolerance percent slower
+bool compareBaseline(const string& filename, const vector<BenchResult>& results, double tolerance, bool& regressed) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    regressed = false;
+    cout << "\nCompared with " << filename << " (tolerance " << tolerance << "%):" << endl;
+    string line;
+    while (getline(file, line)) {
+        string name = jsonField(line, "name");
+        string size = jsonField(line, "size");
+        if (name.empty() || size.empty()) {
+            continue;
+        }
+        double before = atof(jsonField(line, "ns_per_op").c_str());
+        for (const BenchResult& r : results) {
+            if (r.name != name || r.size != atoll(size.c_str()) || before <= 0) {
+                continue;
+            }
+            double change = (r.nsPerCall - before) * 100 / before;
+            bool slower = change > tolerance;
+            cout << "  " << left << setw(20) << name << right << setw(10) << size << setw(14) << before << " -> "
+                 << setw(12) << r.nsPerCall << " ns (" << showpos << (int)change << noshowpos << "%)"
+                 << (slower ? "  REGRESSION" : "") << endl;
+            regressed = regressed || slower;
+        }
+    }
+    return true;
+}
+
+// parse arguments, run every benchmark that passes the filter, print, write JSON, compare with the baseline
+// what a simulated landing does: the tile's task points, the purple bonus roll and a landing count per color
+struct LandingTally {
+    Random random;
+    long long points[8];
+    long long landings[TILE_CODE_COUNT];
+
+    template <int Code>
+    void onTile(int lane) {
+        points[lane] += TILE_TASK_POINTS[Code];
+        if constexpr (Code == TILE_PURPLE) {
+            points[lane] += random.nextInt(PURPLE_BONUS_SPREAD + 1);
+        }
+        landings[Code]++;
+    }
+};
+
+// the same landing on the runtime board: the tile's color char, then a switch like handleTileEvent's
+static void tallyLanding(LandingTally& tally, char color, int lane) {
+    switch (color) {
+        case 'B': tally.onTile<TILE_BLUE>(lane); break;
+        case 'P': tally.onTile<TILE_PINK>(lane); break;
+        case 'T': tally.onTile<TILE_BROWN>(lane); break;
+        case 'R': tally.onTile<TILE_RED>(lane); break;
+        case 'U': tally.onTile<TILE_PURPLE>(lane); break;
+        case 'G': tally.onTile<TILE_GREEN>(lane); break;
+        case 'O': tally.onTile<TILE_FINISH>(lane); break;
+        default: tally.onTile<TILE_START>(lane); break;
+    }
+}
+
+// simulated turns (a d6 roll, the move, the landing) for every lane of a classic-length board, a new race whenever
+// every player is on the finish: through Board's checked accessors, then through FixedBoard<Lanes, 52>
+template <int Lanes>
+void benchBoardTurns(const function<void(const BenchResult&)>& record, bool runtime, bool fixed) {
+    Board board(Lanes, 52);
+    FixedBoard<Lanes, 52> fixedBoard;
+    fixedBoard.assign(board);
+    LandingTally tally = {};
+    int steps[Lanes];
+
+    if (runtime) {
+        record(runBenchmark("boardTurnsRuntime", Lanes, "turn", Lanes, [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                for (int lane = 0; lane < board.getLaneCount(); lane++) {
+                    steps[lane] = tally.random.nextInt(6) + 1;
+                }
+                if (board.advancePlayers(steps) == board.getLaneCount()) {
+                    for (int lane = 0; lane < board.getLaneCount(); lane++) {
+                        board.setPlayerPosition(lane, 0);
+                    }
+                }
+                for (int lane = 0; lane < board.getLaneCount(); lane++) {
+                    tallyLanding(tally, board.getTileColor(lane, board.getPlayerPosition(lane)), lane);
+                }
+            }
+            benchSink = benchSink + tally.points[0];
+        }));
+    }
+    if (fixed) {
+        record(runBenchmark("boardTurnsFixed", Lanes, "turn", Lanes, [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                unrolledFor<Lanes>([&](auto lane) {
+                    steps[lane] = tally.random.nextInt(6) + 1;
+                });
+                if (fixedBoard.advancePlayers(steps) == Lanes) {
+                    fixedBoard.resetPositions();
+                }
+                fixedBoard.dispatchLanded(tally);
+            }
+            benchSink = benchSink + tally.points[0];
+        }));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long long maxBases = 10000000;
+    string filter = "";
+    string jsonFile = "";
+    string baselineFile = "";
+    double tolerance = 20;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--max-bases" && i + 1 < argc) {
+            maxBases = atoll(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselineFile = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else {
+            cout << "Usage: ./bench [--max-bases N] [--filter TEXT] [--json FILE] [--baseline FILE] [--tolerance PCT]" << endl;
+            return 1;
+        }
+    }
+
+    vector<BenchResult> results;
+    auto wanted = [&](const string& name) {
+        return filter.empty() || name.find(filter) != string::npos;
+    };
+    auto record = [&](const BenchResult& result) {
+        printResult(result);
+        results.push_back(result);
+    };
+    NullOutput discard;
+    ostream out(&discard);
+    Random random(12345);
+
+    // DNA kernels over strands of 10 bases to 10 Mb
+    for (long long bases = 10; bases <= maxBases; bases *= 100) {
+        string strand = randomStrand(random, bases);
+        string mutated = mutateStrand(random, strand);
+        // bestStrandMatch slides a short target along the strand, so its cost grows with target length too
+        string target = strand.substr(bases / 3, min(bases / 2, 32LL));
+
+        if (wanted("strandSimilarity")) {
+            record(runBenchmark("strandSimilarity", bases, "base", bases, [&](long long n) {
+                double total = 0;
+                for (long long i = 0; i < n; i++) {
+                    total += strandSimilarity(strand, mutated);
+                }
+                benchSink = benchSink + (long long)total;
+            }));
+        }
+        if (wanted("bestStrandMatch")) {
+            record(runBenchmark("bestStrandMatch", bases, "base", bases, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    benchSink = benchSink + bestStrandMatch(strand, target);
+                }
+            }));
+        }
+        // a cache hit: hash both strands, then one shard lookup
+        if (wanted("cachedBestStrandMatch")) {
+            ResultCache cache(64 << 20);
+            CachedResult cached = {bestStrandMatch(strand, target), 0.0, ""};
+            cache.store(hashTask(CACHED_BEST_MATCH, strand, target), cached);
+            record(runBenchmark("cachedBestStrandMatch", bases, "base", bases, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    cache.lookup(hashTask(CACHED_BEST_MATCH, strand, target), cached);
+                    benchSink = benchSink + cached.index;
+                }
+            }));
+        }
+        if (wanted("identifyMutations")) {
+            record(runBenchmark("identifyMutations", bases, "base", bases, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    identifyMutations(strand, mutated, out);
+                }
+            }));
+        }
+        if (wanted("transcribeDNAtoRNA")) {
+            record(runBenchmark("transcribeDNAtoRNA", bases, "base", bases, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    transcribeDNAtoRNA(strand, out);
+                }
+            }));
+        }
+    }
+
+    // composition of a 10 Mb strand: whole-strand counts, then 1 kb windows every 100 bases (each window updated from
+    // the one before)
+    if (wanted("countComposition") || wanted("compositionWindows")) {
+        string strand = randomStrand(random, min(maxBases, 10000000LL));
+        BaseComposition counts;
+        counts.clear();
+        if (wanted("countComposition")) {
+            record(runBenchmark("countComposition", strand.size(), "base", strand.size(), [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    countComposition(strand, counts);
+                }
+                benchSink = benchSink + counts.pairs[6];
+            }));
+        }
+        if (wanted("compositionWindows")) {
+            CompositionWindows windows(1000, 100);
+            record(runBenchmark("compositionWindows", strand.size(), "base", strand.size(), [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    windows.reset(strand);
+                    while (windows.next()) {
+                        benchSink = benchSink + windows.getCounts().bases[BASE_G];
+                    }
+                }
+            }));
+        }
+    }
+
+    // contamination screening: a 1 Mb strand, half of it taken from a 16 Mb contaminant set (a 32 MB filter,
+    // larger than the caches, so every k-mer is a memory access)
+    if (wanted("kmerScreen")) {
+        string contaminant = randomStrand(random, 16000000);
+        KmerFilter filter(31, contaminant.size(), 16);
+        filter.add(contaminant);
+        string query = contaminant.substr(1000000, 500000) + randomStrand(random, 500000);
+        contaminant = string();
+        record(runBenchmark("kmerScreen", query.size(), "base", query.size(), [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                benchSink = benchSink + filter.screen(query).hits;
+            }
+        }));
+    }
+
+    // multiple alignment of 64 related 1 kb strands (each a copy of one strand with 1% of its bases substituted),
+    // on one thread
+    if (wanted("alignStrands")) {
+        string ancestor = randomStrand(random, 1000);
+        vector<string> strands;
+        for (int i = 0; i < 64; i++) {
+            strands.push_back(mutateStrand(random, ancestor));
+        }
+        AlignmentOptions options;
+        options.threads = 1;
+        StrandAlignment alignment;
+        record(runBenchmark("alignStrands", strands.size(), "base", strands.size() * ancestor.size(), [&](long long n) {
+            for (long long i = 0; i < n; i++) {
+                alignStrands(strands, options, alignment);
+                benchSink = benchSink + alignment.consensus.size();
+            }
+        }));
+    }
+
+    // board generation and display: the classic board, a large board, and (generation only) 16 lanes of 1M tiles
+    const int boardSizes[3][2] = {{2, 52}, {64, 1000}, {16, 1000000}};
+    for (int s = 0; s < 3; s++) {
+        int lanes = boardSizes[s][0];
+        int length = boardSizes[s][1];
+        long long tiles = (long long)lanes * length;
+        if (!wanted("initializeBoard") && !(wanted("displayBoard") && s < 2)) {
+            continue;
+        }
+        Board board(lanes, length);
+        if (wanted("initializeBoard")) {
+            record(runBenchmark("initializeBoard", tiles, "tile", tiles, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    board.initializeBoard();
+                }
+                benchSink = benchSink + board.getTileCode(0, 1);
+            }));
+        }
+        if (wanted("displayBoard") && s < 2) {
+            record(runBenchmark("displayBoard", tiles, "tile", tiles, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    board.displayBoard(out);
+                }
+            }));
+        }
+    }
+
+    // simulated turns on the classic 2-lane board and an 8-lane one, runtime-sized against fixed-size
+    if (wanted("boardTurnsRuntime") || wanted("boardTurnsFixed")) {
+        benchBoardTurns<2>(record, wanted("boardTurnsRuntime"), wanted("boardTurnsFixed"));
+        benchBoardTurns<8>(record, wanted("boardTurnsRuntime"), wanted("boardTurnsFixed"));
+    }
+
+    // riddle answers with one typo (the bit-parallel path) and duplicate detection over whole banks
+    if (wanted("matchAnswer")) {
+        const int answerLengths[3] = {8, 24, 64};
+        for (int length : answerLengths) {
+            string expected;
+            normalizeText(randomStrand(random, length), expected);
+            string typed = expected;
+            typed[length / 2] = typed[length / 2] == 'a' ? 'c' : 'a';
+            string scratch;
+            record(runBenchmark("matchAnswer", length, "char", length, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    benchSink = benchSink + matchAnswer(expected, typed, scratch);
+                }
+            }));
+        }
+    }
+    if (wanted("findDuplicateRiddles")) {
+        const int bankSizes[2] = {1000, 100000};
+        for (int count : bankSizes) {
+            vector<string> text;
+            vector<Riddle> riddles;
+            makeRiddleBank(random, count, text, riddles);
+            vector<RiddleDuplicate> duplicates;
+            record(runBenchmark("findDuplicateRiddles", count, "riddle", count, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    findDuplicateRiddles(riddles, duplicates);
+                    benchSink = benchSink + duplicates.size();
+                }
+            }));
+        }
+    }
+
+    // columnar results: 4M synthetic player rows (5 characters, games in id order), one selective filter query
+    // and one group-by over every row
+    if (wanted("resultsFilter") || wanted("resultsGroupBy")) {
+        static const char* const NAMES[] = {"Dr.Leo", "Dr.Helix", "Dr.Panthera", "Dr.Adenine", "Dr.Cytosine"};
+        const long long rowCount = 4000000;
+        string filename = "/tmp/bench_results.col";
+        string block(RESULTS_FILE_MAGIC, sizeof(RESULTS_FILE_MAGIC));
+        ResultsColumns columns;
+        StatsRecord player;
+        memset(&player, 0, sizeof(player));
+        for (long long row = 0; row < rowCount; row++) {
+            player.gameId = row / 4 + 1;
+            player.playerNumber = row % 4 + 1;
+            strcpy(player.characterName, NAMES[random.nextInt(5)]);
+            player.pathType = random.nextInt(2);
+            player.advisor = player.pathType == 0 ? random.nextInt(5) + 1 : 0;
+            player.won = random.nextInt(4) == 0;
+            player.finalDiscoverPoints = 50000 + random.nextInt(15000);
+            columns.add(player);
+            if (columns.isFull()) {
+                columns.encode(block);
+                columns.clear();
+            }
+        }
+        columns.encode(block);
+        ofstream(filename, ios::binary).write(block.data(), block.size());
+        block = string();
+
+        ResultsTable table;
+        table.open(filename);
+        ResultsQuery filtered;
+        string error;
+        const char* conditions[] = {"character=Dr.Panthera", "path_type=0", "advisor=3"};
+        for (const char* condition : conditions) {
+            ResultsFilter filter;
+            parseResultsFilter(condition, table, filter, error);
+            filtered.filters.push_back(filter);
+        }
+        filtered.valueColumn = RESULT_FINAL_DISCOVERY_POINTS;
+        ResultsQuery grouped;
+        grouped.groupBy = {RESULT_CHARACTER, RESULT_ADVISOR};
+        grouped.valueColumn = RESULT_FINAL_DISCOVERY_POINTS;
+        ResultsQueryResult result;
+        runResultsQuery(table, filtered, result);
+        runResultsQuery(table, grouped, result);
+
+        if (wanted("resultsFilter")) {
+            record(runBenchmark("resultsFilter", rowCount, "row", rowCount, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    runResultsQuery(table, filtered, result);
+                    benchSink = benchSink + result.groups.size();
+                }
+            }));
+        }
+        if (wanted("resultsGroupBy")) {
+            record(runBenchmark("resultsGroupBy", rowCount, "row", rowCount, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    runResultsQuery(table, grouped, result);
+                    benchSink = benchSink + result.groups.size();
+                }
+            }));
+        }
+        remove(filename.c_str());
+    }
+
+    // whole turns (menu, dice, tile event, DNA task, random event) in 2- and 8-player games, a new game whenever one ends
+    if (wanted("playTurn")) {
+        GameData* gameData = new GameData();
+        loadGameData(*gameData, out);
+        ContentStore content(gameData);
+        ContentReader reader(content);
+        ScriptedInput turnScript(TURN_SCRIPT, sizeof(TURN_SCRIPT) - 1);
+        istream turnIn(&turnScript);
+        TurnBuffers buffers;
+
+        const int playerCounts[2] = {2, 8};
+        for (int playerCount : playerCounts) {
+            string setupAnswers;
+            for (int i = 0; i < playerCount; i++) {
+                setupAnswers += to_string(i % gameData->getCharacterCount() + 1) + "\n2\n";
+            }
+            GameState state;
+            uint64_t seed = 1;
+            int finishedCount = playerCount;
+            record(runBenchmark("playTurn", playerCount, "turn", 1, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    if (finishedCount == playerCount) {
+                        istringstream setupIn(setupAnswers);
+                        state.random.setState(seed++);
+                        setupGame(state, content, playerCount, setupIn, out);
+                        finishedCount = 0;
+                    }
+                    int playerIndex = state.turn % playerCount;
+                    while (state.finished[playerIndex]) {
+                        playerIndex = ++state.turn % playerCount;
+                    }
+                    if (playTurn(state, playerIndex, reader.pin(), buffers, turnIn, out)) {
+                        state.finished[playerIndex] = true;
+                        finishedCount++;
+                    }
+                    reader.unpin();
+                    state.turn++;
+                }
+            }));
+        }
+    }
+
+    if (!jsonFile.empty()) {
+        if (writeJson(jsonFile, results)) {
+            cout << "Results written to " << jsonFile << endl;
+        } else {
+            cout << "Warning: Could not write " << jsonFile << endl;
+        }
+    }
+    bool regressed = false;
+    if (!baselineFile.empty() && !compareBaseline(baselineFile, results, tolerance, regressed)) {
+        cout << "Error: Could not read the baseline " << baselineFile << endl;
+        return 1;
+    }
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+// Scripted client for the game server: plays many games at once and measures turn latency
+// Usage: ./client ADDRESS [--games N] [--idle N] [--script FILE]
+//   ADDRESS   unix:/path/to/socket, host:port or port (same as ./game --server)
+//   --games   games to play at the same time (default 1)
+//   --idle    extra connections that only wait at the first prompt (default 0)
+//   --script  prompt|answer rules, one per line (default: the built-in rules below)
+// Every time the server prints a prompt (output ending in ": "), the client answers with the
+// rule whose prompt text appears last in the new output, and times answer -> next prompt.
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// answer for any prompt containing the text
+struct ScriptRule {
+    string prompt;
+    string answer;
+};
+
+// one connection to the server
+struct ClientGame {
+    int fd;
+    bool idle;              // just holds a session open
+    string received;        // output since the last answer
+    chrono::steady_clock::time_point sentAt;
+    bool waiting;           // an answer was sent and the next prompt hasn't arrived yet
+    int characterChoice;    // cycles through characters when several players pick
+};
+
+// default rules: pick characters in turn, Training Fellowship with advisor 5 ("5" also moves forward in the main menu), matching strands
+static const char* DEFAULT_SCRIPT[] = {
+    "saved game was found|n",
+    "Enter your choice (1 or 2)|1",
+    "Enter your choice (1-5)|5",
+    "Please enter 1-5|5",
+    "Please enter 1 or 2|1",
+    "Enter first DNA strand|ACGTACGTAC",
+    "Enter second DNA strand|ACGTACGTAA",
+    "Enter input DNA strand|ACGTTGCAACGT",
+    "Enter target DNA strand|TGCAAC",
+    "Enter DNA strand|ACGTTGCA",
+    "Your answer|loop",
+};
+
+// read prompt|answer lines, skip blank lines and // comments
+bool loadScript(string filename, vector<ScriptRule>& rules) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '/') continue;
+        size_t pipePos = line.find('|');
+        if (pipePos != string::npos) {
+            ScriptRule rule;
+            rule.prompt = line.substr(0, pipePos);
+            rule.answer = line.substr(pipePos + 1);
+            rules.push_back(rule);
+        }
+    }
+    return true;
+}
+
+int connectTo(const string& address) {
+    int fd;
+    if (address.compare(0, 5, "unix:") == 0) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, address.c_str() + 5, sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    } else {
+        string host = "127.0.0.1";
+        string port = address;
+        size_t colon = address.rfind(':');
+        if (colon != string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(atoi(port.c_str()));
+        inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+// find the rule whose prompt shows up last in the output (the prompt being asked right now)
+string chooseAnswer(ClientGame& game, vector<ScriptRule>& rules) {
+    if (game.received.find("Enter the number of your chosen character") != string::npos) {
+        // first choice that is still listed in the character menu
+        for (int i = 1; i <= 9; i++) {
+            int choice = (game.characterChoice + i - 1) % 9 + 1;
+            if (game.received.find("\n" + to_string(choice) + ". ") != string::npos) {
+                game.characterChoice = choice;
+                return to_string(choice);
+            }
+        }
+        return "1";
+    }
+
+    size_t bestPos = 0;
+    string answer = "5";
+    bool found = false;
+    for (int i = 0; i < (int)rules.size(); i++) {
+        size_t pos = game.received.rfind(rules[i].prompt);
+        if (pos != string::npos && (!found || pos > bestPos)) {
+            bestPos = pos;
+            answer = rules[i].answer;
+            found = true;
+        }
+    }
+    return answer;
+}
+
+double percentile(vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+// parse arguments, load rules, open all connections, answer prompts until every game ends, print latency summary
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cout << "Usage: ./client ADDRESS [--games N] [--idle N] [--script FILE]" << endl;
+        return 1;
+    }
+    string address = argv[1];
+    int gameCount = 1;
+    int idleCount = 0;
+    string scriptFile = "";
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--games" && i + 1 < argc) {
+            gameCount = atoi(argv[++i]);
+        } else if (arg == "--idle" && i + 1 < argc) {
+            idleCount = atoi(argv[++i]);
+        } else if (arg == "--script" && i + 1 < argc) {
+            scriptFile = argv[++i];
+        }
+    }
+
+    vector<ScriptRule> rules;
+    if (!scriptFile.empty()) {
+        if (!loadScript(scriptFile, rules)) {
+            cout << "Error: Could not load script " << scriptFile << endl;
+            return 1;
+        }
+    } else {
+        for (int i = 0; i < (int)(sizeof(DEFAULT_SCRIPT) / sizeof(DEFAULT_SCRIPT[0])); i++) {
+            string line = DEFAULT_SCRIPT[i];
+            size_t pipePos = line.find('|');
+            ScriptRule rule;
+            rule.prompt = line.substr(0, pipePos);
+            rule.answer = line.substr(pipePos + 1);
+            rules.push_back(rule);
+        }
+    }
+
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int epollFd = epoll_create1(0);
+    vector<ClientGame> games(gameCount + idleCount);
+    int open = 0;
+    for (int i = 0; i < (int)games.size(); i++) {
+        games[i].fd = connectTo(address);
+        if (games[i].fd < 0) {
+            cout << "Error: Could not connect to " << address << " (connection " << (i + 1) << ")" << endl;
+            return 1;
+        }
+        games[i].idle = (i >= gameCount);
+        games[i].waiting = true;
+        games[i].characterChoice = 0;
+        games[i].sentAt = chrono::steady_clock::now();
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, games[i].fd, &event);
+        open++;
+    }
+    cout << "Connected " << gameCount << " playing and " << idleCount << " idle sessions." << endl;
+
+    vector<double> latencies;
+    int finished = 0;
+    int playing = gameCount;
+    epoll_event events[256];
+    char buffer[16384];
+    auto start = chrono::steady_clock::now();
+
+    while (playing > 0) {
+        int count = epoll_wait(epollFd, events, 256, 10000);
+        if (count == 0) {
+            cout << "Error: No output for 10 seconds, " << playing << " games stuck." << endl;
+            break;
+        }
+        for (int e = 0; e < count; e++) {
+            ClientGame& game = games[events[e].data.u32];
+            ssize_t n = read(game.fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, game.fd, nullptr);
+                close(game.fd);
+                game.fd = -1;
+                if (!game.idle) {
+                    playing--;
+                    if (game.received.find("GAME OVER!") != string::npos) {
+                        finished++;
+                    }
+                }
+                continue;
+            }
+            game.received.append(buffer, n);
+
+            bool atPrompt = game.received.size() >= 2 &&
+                            game.received.compare(game.received.size() - 2, 2, ": ") == 0;
+            if (!atPrompt || game.idle) {
+                continue;
+            }
+
+            auto now = chrono::steady_clock::now();
+            if (game.waiting) {
+                latencies.push_back(chrono::duration<double, micro>(now - game.sentAt).count());
+            }
+
+            string answer = chooseAnswer(game, rules) + "\n";
+            game.received.clear();
+            game.sentAt = chrono::steady_clock::now();
+            game.waiting = true;
+            if (write(game.fd, answer.data(), answer.size()) < 0) {
+                game.waiting = false;
+            }
+        }
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    sort(latencies.begin(), latencies.end());
+    cout << "Games finished: " << finished << " / " << gameCount << " in " << seconds << " s" << endl;
+    cout << "Prompts answered: " << latencies.size() << endl;
+    cout << "Latency (us): p50 " << percentile(latencies, 0.50)
+         << "  p99 " << percentile(latencies, 0.99)
+         << "  p999 " << percentile(latencies, 0.999)
+         << "  max " << (latencies.empty() ? 0.0 : latencies.back()) << endl;
+
+    for (int i = 0; i < (int)games.size(); i++) {
+        if (games[i].fd >= 0) {
+            close(games[i].fd);
+        }
+    }
+    close(epollFd);
+    return finished == gameCount ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+// Base composition of strands over sliding windows: base counts, GC content, GC skew and dinucleotide frequencies
+// Usage: ./composition FILE... [--window N] [--step N] [--bedgraph OUT] [--stat NAME] [--binary OUT]
+//   FILE        strands (FASTA or one strand per line, .gz or plain; "-" reads standard input)
+//   --window    window size in bases (default 1000)
+//   --step      bases from one window's start to the next (default: the window size, so windows don't overlap)
+//   --bedgraph  write one statistic per window as bedGraph: strand name, start, end (0-based, end excluded), value
+//   --stat      the statistic --bedgraph writes: gc (default), skew, a, c, g, t or other (share of the window's
+//               bases), or a dinucleotide such as cg (share of the window's pairs)
+//   --binary    write every window's counts: a header ("JTGW", version, window, step, bytes per count), then per
+//               strand its name length, name, length and window count, then per window the counts of A, C, G, T,
+//               other and the 16 dinucleotides AA ... TT (2 bytes each when the window is under 65536 bases, else 4)
+// Prints the whole input's composition (bases, GC content, GC skew, dinucleotide frequencies) and the rate.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "SequenceComposition.h"
+#include "StrandReader.h"
+
+using namespace std;
+
+static const char BINARY_MAGIC[4] = {'J', 'T', 'G', 'W'};
+static const uint32_t BINARY_VERSION = 1;
+static const size_t FLUSH_BYTES = 1 << 20;
+
+// statistics --stat can name: shares of the window's bases, then gc and skew; dinucleotides come after
+enum WindowStat {
+    STAT_A,
+    STAT_C,
+    STAT_G,
+    STAT_T,
+    STAT_OTHER,
+    STAT_GC,
+    STAT_SKEW,
+    STAT_PAIR
+};
+
+// index of a --stat name (STAT_PAIR + pair for dinucleotides), -1 if unknown
+static int findStat(const string& name) {
+    static const char* const NAMES[STAT_PAIR] = {"a", "c", "g", "t", "other", "gc", "skew"};
+    for (int i = 0; i < STAT_PAIR; i++) {
+        if (name == NAMES[i]) {
+            return i;
+        }
+    }
+    int pair = findPair(name);
+    return pair < 0 ? -1 : STAT_PAIR + pair;
+}
+
+static double statValue(const BaseComposition& counts, int stat) {
+    if (stat == STAT_GC) {
+        return counts.getGcContent();
+    }
+    if (stat == STAT_SKEW) {
+        return counts.getGcSkew();
+    }
+    if (stat >= STAT_PAIR) {
+        return counts.getPairFrequency(stat - STAT_PAIR);
+    }
+    long long length = counts.getLength();
+    return length == 0 ? 0.0 : (double)counts.bases[stat] / length;
+}
+
+// an output file written through a temp file, renamed into place once everything is in
+struct OutputFile {
+    string name;
+    ofstream file;
+    string buffer;
+
+    bool open(const string& filename) {
+        name = filename;
+        file.open(name + ".tmp", ios::binary | ios::trunc);
+        buffer.reserve(FLUSH_BYTES + 4096);
+        return file.is_open();
+    }
+
+    void flushIfFull() {
+        if (buffer.size() >= FLUSH_BYTES) {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    bool finish() {
+        file.write(buffer.data(), buffer.size());
+        bool written = (bool)file.flush();
+        file.close();
+        if (!written || rename((name + ".tmp").c_str(), name.c_str()) != 0) {
+            remove((name + ".tmp").c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+template <typename T>
+static void appendValue(string& buffer, T value) {
+    buffer.append((const char*)&value, sizeof(value));
+}
+
+// parse arguments, stream every strand through the windows, write what was asked for, print the totals
+int main(int argc, char* argv[]) {
+    vector<string> files;
+    int window = 1000;
+    int step = 0;
+    string bedGraphFile = "";
+    string binaryFile = "";
+    string statName = "gc";
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--window" && i + 1 < argc) {
+            window = atoi(argv[++i]);
+        } else if (arg == "--step" && i + 1 < argc) {
+            step = atoi(argv[++i]);
+        } else if (arg == "--bedgraph" && i + 1 < argc) {
+            bedGraphFile = argv[++i];
+        } else if (arg == "--stat" && i + 1 < argc) {
+            statName = argv[++i];
+        } else if (arg == "--binary" && i + 1 < argc) {
+            binaryFile = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            valid = false;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    step = step == 0 ? window : step;
+    int stat = findStat(statName);
+    if (!valid || files.empty() || window < 1 || step < 1) {
+        cout << "Usage: ./composition FILE... [--window N] [--step N] [--bedgraph OUT] [--stat NAME] [--binary OUT]" << endl;
+        return 1;
+    }
+    if (stat < 0) {
+        cout << "Error: Unknown statistic " << statName << " (gc, skew, a, c, g, t, other or a dinucleotide such as cg)." << endl;
+        return 1;
+    }
+
+    OutputFile bedGraph;
+    OutputFile binary;
+    if (!bedGraphFile.empty() && !bedGraph.open(bedGraphFile)) {
+        cout << "Error: Could not open " << bedGraphFile << " for writing." << endl;
+        return 1;
+    }
+    int countBytes = window < 65536 ? 2 : 4;
+    if (!binaryFile.empty()) {
+        if (!binary.open(binaryFile)) {
+            cout << "Error: Could not open " << binaryFile << " for writing." << endl;
+            return 1;
+        }
+        binary.buffer.append(BINARY_MAGIC, 4);
+        appendValue(binary.buffer, BINARY_VERSION);
+        appendValue(binary.buffer, (uint32_t)window);
+        appendValue(binary.buffer, (uint32_t)step);
+        appendValue(binary.buffer, (uint32_t)countBytes);
+    }
+
+    StrandReader reader;
+    CompositionWindows windows(window, step);
+    BaseComposition total;
+    total.clear();
+    string name;
+    string sequence;
+    long long strands = 0;
+    long long windowCount = 0;
+    double readSeconds = 0;
+    double countSeconds = 0;
+    char line[512];
+    for (const string& file : files) {
+        if (!reader.open(file)) {
+            cout << "Error: Could not open " << file << endl;
+            return 1;
+        }
+        chrono::steady_clock::time_point before = chrono::steady_clock::now();
+        while (reader.next(name, sequence)) {
+            chrono::steady_clock::time_point read = chrono::steady_clock::now();
+            if (!binaryFile.empty()) {
+                appendValue(binary.buffer, (uint32_t)name.size());
+                binary.buffer += name;
+                appendValue(binary.buffer, (uint64_t)sequence.size());
+                appendValue(binary.buffer, (uint64_t)CompositionWindows::getWindowCount(sequence.size(), window, step));
+            }
+            windows.reset(sequence);
+            while (windows.next()) {
+                const BaseComposition& counts = windows.getCounts();
+                if (!bedGraphFile.empty()) {
+                    int length = snprintf(line, sizeof(line), "%s\t%lld\t%lld\t%.4f\n", name.c_str(), windows.getStart(),
+                                          windows.getEnd(), statValue(counts, stat));
+                    bedGraph.buffer.append(line, min(length, (int)sizeof(line) - 1));
+                    bedGraph.flushIfFull();
+                }
+                if (!binaryFile.empty()) {
+                    for (int i = 0; i < BASE_KIND_COUNT + PAIR_COUNT; i++) {
+                        long long count = i < BASE_KIND_COUNT ? counts.bases[i] : counts.pairs[i - BASE_KIND_COUNT];
+                        countBytes == 2 ? appendValue(binary.buffer, (uint16_t)count)
+                                        : appendValue(binary.buffer, (uint32_t)count);
+                    }
+                    binary.flushIfFull();
+                }
+                windowCount++;
+            }
+            countComposition(sequence, total);
+            strands++;
+            chrono::steady_clock::time_point counted = chrono::steady_clock::now();
+            readSeconds += chrono::duration<double>(read - before).count();
+            countSeconds += chrono::duration<double>(counted - read).count();
+            before = counted;
+        }
+    }
+    if (!bedGraphFile.empty() && !bedGraph.finish()) {
+        cout << "Error: Could not write " << bedGraphFile << endl;
+        return 1;
+    }
+    if (!binaryFile.empty() && !binary.finish()) {
+        cout << "Error: Could not write " << binaryFile << endl;
+        return 1;
+    }
+
+    long long bases = total.getLength();
+    cout << "Strands: " << strands << ", bases: " << bases << ", windows: " << windowCount << " (" << window
+         << " bases every " << step << ")" << endl;
+    cout << "A " << total.bases[BASE_A] << "  C " << total.bases[BASE_C] << "  G " << total.bases[BASE_G] << "  T "
+         << total.bases[BASE_T] << "  other " << total.bases[BASE_OTHER] << endl;
+    cout << "GC content " << total.getGcContent() * 100 << "%, GC skew " << total.getGcSkew() << endl;
+    cout << "Dinucleotides:";
+    for (int pair = 0; pair < PAIR_COUNT; pair++) {
+        cout << (pair % 4 == 0 ? "\n  " : "  ") << getPairName(pair) << " " << total.getPairFrequency(pair) * 100 << "%";
+    }
+    cout << endl;
+    double totalSeconds = readSeconds + countSeconds;
+    cout << "Windows and totals: " << (long long)(bases / max(countSeconds, 1e-9) / 1e6) << " Mbases/s; with reading: "
+         << (long long)(bases / max(totalSeconds, 1e-9) / 1e6) << " Mbases/s" << endl;
+    return 0;
+}
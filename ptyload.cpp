@@ -0,0 +1,553 @@
+// Load harness for the interactive game: plays many terminal games at once, each on its own pseudo-terminal,
+// and measures how long the game takes to show the next prompt after an answer is typed
+// Usage: ./ptyload [--game PATH] [--sessions N] [--seed N] [--save-sessions DIR] [--replay DIR]
+//                  [--save-baseline FILE] [--baseline FILE] [--tolerance PCT]
+//   --game           game binary to run (default ./game), started as "game --seed S --stats /dev/null"
+//   --sessions       games played side by side (default 8)
+//   --seed           session i plays game seed S + i and generates its answers from the same seed (default 1)
+//   --save-sessions  write every session's answers to DIR/session_<i>.txt
+//   --replay         replay the sessions saved in DIR instead of generating answers (--sessions and --seed are ignored)
+//   --save-baseline  write the latency quantiles of this run to FILE
+//   --baseline       compare this run with the quantiles in FILE, exit with status 1 if p50 or p99 got
+//                    more than --tolerance percent slower (default 20)
+// Each session runs in its own scratch directory (snapshot and stats files never collide) with links to the
+// content files of the current directory. The terminal is left in its normal line mode with echo off,
+// so the game reads input exactly as it does when a player types.
+// Generated answers follow the prompts: characters in turn, a random path and advisor, the main menu
+// mostly moving forward with a detour to the other entries every few turns, random strands and riddle answers.
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <pty.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "Random.h"
+
+using namespace std;
+
+// what the game is asking for, from the last marker in its output
+enum PromptKind {
+    PROMPT_RESUME, PROMPT_CHARACTER, PROMPT_PATH, PROMPT_ADVISOR, PROMPT_MENU, PROMPT_SUBMENU,
+    PROMPT_FIRST_STRAND, PROMPT_SECOND_STRAND, PROMPT_STRAND, PROMPT_RIDDLE, PROMPT_UNKNOWN
+};
+
+// latency is reported per group of prompts: the answer's category is the work it sets off
+enum LatencyCategory {
+    CATEGORY_SETUP, CATEGORY_MENU, CATEGORY_TASK, CATEGORY_RIDDLE, CATEGORY_COUNT
+};
+static const char* CATEGORY_NAMES[CATEGORY_COUNT + 1] = {"setup", "menu", "task", "riddle", "all"};
+
+struct PromptMarker {
+    const char* text;
+    PromptKind kind;
+};
+
+static const PromptMarker PROMPT_MARKERS[] = {
+    {"saved game was found", PROMPT_RESUME},
+    {"chosen character", PROMPT_CHARACTER},
+    {"available character", PROMPT_CHARACTER},
+    {"=== Path Type Selection", PROMPT_PATH},
+    {"Please enter 1 or 2", PROMPT_PATH},
+    {"Choose your advisor", PROMPT_ADVISOR},
+    {"Please enter 1-5", PROMPT_ADVISOR},
+    {"=== Main Menu", PROMPT_MENU},
+    {"=== Player Progress", PROMPT_SUBMENU},
+    {"=== Advisor Information", PROMPT_SUBMENU},
+    {"Enter first DNA strand", PROMPT_FIRST_STRAND},
+    {"Enter second DNA strand", PROMPT_SECOND_STRAND},
+    {"Enter input DNA strand", PROMPT_STRAND},
+    {"Enter target DNA strand", PROMPT_STRAND},
+    {"Enter DNA strand", PROMPT_STRAND},
+    {"Your answer", PROMPT_RIDDLE},
+};
+
+// content files linked into every session's directory (if they exist here)
+static const char* CONTENT_FILES[] = {"characters.txt", "riddles.txt", "random_events.txt", "content.bin", "board_mix.txt"};
+
+// one game on one pseudo-terminal
+struct PtySession {
+    int fd;                     // pty master
+    pid_t pid;
+    string directory;
+    uint64_t seed;
+    Random random;              // answer generator
+    vector<string> answers;     // answers sent (or to send, when replaying)
+    size_t nextAnswer;
+    bool replaying;
+    string received;            // output since the last answer
+    string firstStrand;         // the blue task's second strand has the first one's length
+    int characterChoice;
+    bool waiting;               // an answer was sent and the next prompt hasn't arrived yet
+    int waitingCategory;
+    chrono::steady_clock::time_point sentAt;
+    bool finished;              // reached GAME OVER
+    bool desynced;              // replay ran out of answers
+};
+
+// the prompt whose marker shows up last in the output
+PromptKind classifyPrompt(const string& received) {
+    size_t bestPos = 0;
+    PromptKind kind = PROMPT_UNKNOWN;
+    for (const PromptMarker& marker : PROMPT_MARKERS) {
+        size_t pos = received.rfind(marker.text);
+        if (pos != string::npos && (kind == PROMPT_UNKNOWN || pos > bestPos)) {
+            bestPos = pos;
+            kind = marker.kind;
+        }
+    }
+    return kind;
+}
+
+int categoryOf(PromptKind kind) {
+    switch (kind) {
+        case PROMPT_MENU:
+        case PROMPT_SUBMENU:
+        case PROMPT_UNKNOWN:
+            return CATEGORY_MENU;
+        case PROMPT_FIRST_STRAND:
+        case PROMPT_SECOND_STRAND:
+        case PROMPT_STRAND:
+            return CATEGORY_TASK;
+        case PROMPT_RIDDLE:
+            return CATEGORY_RIDDLE;
+        default:
+            return CATEGORY_SETUP;
+    }
+}
+
+string randomStrand(Random& random, int length) {
+    static const char BASES[] = {'A', 'C', 'G', 'T'};
+    string strand(length, 'A');
+    for (int i = 0; i < length; i++) {
+        strand[i] = BASES[random.nextInt(4)];
+    }
+    return strand;
+}
+
+// next answer for a generated session
+string generateAnswer(PtySession& session, PromptKind kind) {
+    Random& random = session.random;
+    switch (kind) {
+        case PROMPT_RESUME:
+            return "n";
+        case PROMPT_CHARACTER:
+            // first choice that is still listed in the character menu
+            for (int i = 1; i <= 9; i++) {
+                int choice = (session.characterChoice + i - 1) % 9 + 1;
+                if (session.received.find("\n" + to_string(choice) + ". ") != string::npos) {
+                    session.characterChoice = choice;
+                    return to_string(choice);
+                }
+            }
+            return "1";
+        case PROMPT_PATH:
+            return to_string(1 + random.nextInt(2));
+        case PROMPT_ADVISOR:
+            return to_string(1 + random.nextInt(5));
+        case PROMPT_MENU:
+            return random.nextInt(4) == 0 ? to_string(1 + random.nextInt(4)) : "5";
+        case PROMPT_SUBMENU:
+            return to_string(1 + random.nextInt(2));
+        case PROMPT_FIRST_STRAND:
+            session.firstStrand = randomStrand(random, 4 + random.nextInt(61));
+            return session.firstStrand;
+        case PROMPT_SECOND_STRAND: {
+            // mostly similar to the first strand, so every scoring branch is reached
+            string strand = session.firstStrand;
+            int changes = random.nextInt((int)strand.length() + 1);
+            for (int i = 0; i < changes; i++) {
+                strand[random.nextInt((int)strand.length())] = "ACGT"[random.nextInt(4)];
+            }
+            return strand;
+        }
+        case PROMPT_STRAND:
+            return randomStrand(random, 4 + random.nextInt(61));
+        case PROMPT_RIDDLE:
+            return random.nextInt(2) == 0 ? "dna" : "helix";
+        default:
+            return "5";
+    }
+}
+
+// percentile of sorted samples (nearest rank below)
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+// scratch directory with links to the content files, false if it can't be made
+bool prepareDirectory(PtySession& session, const string& root, int index, const string& sourceDirectory) {
+    session.directory = root + "/session_" + to_string(index);
+    if (mkdir(session.directory.c_str(), 0755) != 0) {
+        return false;
+    }
+    for (const char* name : CONTENT_FILES) {
+        string source = sourceDirectory + "/" + name;
+        if (access(source.c_str(), F_OK) == 0) {
+            symlink(source.c_str(), (session.directory + "/" + name).c_str());
+        }
+    }
+    return true;
+}
+
+// remove everything the session left in its directory (links, snapshot, temp files), then the directory
+void removeDirectory(const string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (dir != nullptr) {
+        while (dirent* entry = readdir(dir)) {
+            string name = entry->d_name;
+            if (name != "." && name != "..") {
+                unlink((directory + "/" + name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(directory.c_str());
+}
+
+// fork the game on a new pty in the session's directory, echo off so only the game's output comes back
+bool startSession(PtySession& session, const string& gamePath) {
+    int master;
+    pid_t pid = forkpty(&master, nullptr, nullptr, nullptr);
+    if (pid < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        termios mode;
+        if (tcgetattr(STDIN_FILENO, &mode) == 0) {
+            mode.c_lflag &= ~(ECHO | ECHONL);
+            tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+        }
+        if (chdir(session.directory.c_str()) != 0) {
+            _exit(127);
+        }
+        string seed = to_string(session.seed);
+        execl(gamePath.c_str(), gamePath.c_str(), "--seed", seed.c_str(), "--stats", "/dev/null", (char*)nullptr);
+        _exit(127);
+    }
+    session.fd = master;
+    session.pid = pid;
+    session.sentAt = chrono::steady_clock::now();
+    session.waiting = false;
+    return true;
+}
+
+// seed line, then one answer per line
+bool saveSession(const PtySession& session, const string& filename) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "seed|" << session.seed << "\n";
+    for (const string& answer : session.answers) {
+        file << answer << "\n";
+    }
+    return (bool)file;
+}
+
+bool loadSession(PtySession& session, const string& filename) {
+    ifstream file(filename);
+    string line;
+    if (!file.is_open() || !getline(file, line) || line.compare(0, 5, "seed|") != 0) {
+        return false;
+    }
+    session.seed = strtoull(line.c_str() + 5, nullptr, 10);
+    while (getline(file, line)) {
+        session.answers.push_back(line);
+    }
+    return true;
+}
+
+// baseline file: header, then category|samples|p50|p99|p999 (microseconds)
+bool saveBaseline(const string& filename, vector<double>* samples) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "category|samples|p50_us|p99_us|p999_us\n";
+    for (int c = 0; c <= CATEGORY_COUNT; c++) {
+        if (samples[c].empty()) {
+            continue;
+        }
+        file << CATEGORY_NAMES[c] << "|" << samples[c].size() << "|" << percentile(samples[c], 0.50) << "|"
+             << percentile(samples[c], 0.99) << "|" << percentile(samples[c], 0.999) << "\n";
+    }
+    return (bool)file;
+}
+
+// print this run next to the baseline, regressed if p50 or p99 of a category grew by more than tolerance percent
+// (false if the baseline can't be read)
+bool compareBaseline(const string& filename, vector<double>* samples, double tolerance, bool& regressed) {
+    ifstream file(filename);
+    string line;
+    if (!file.is_open() || !getline(file, line)) {
+        return false;
+    }
+    regressed = false;
+    cout << "Compared with " << filename << " (tolerance " << tolerance << "%):" << endl;
+    while (getline(file, line)) {
+        vector<string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t pipe = line.find('|', start);
+            fields.push_back(line.substr(start, pipe - start));
+            if (pipe == string::npos) break;
+            start = pipe + 1;
+        }
+        if (fields.size() != 5) {
+            continue;
+        }
+        int c = 0;
+        while (c <= CATEGORY_COUNT && fields[0] != CATEGORY_NAMES[c]) {
+            c++;
+        }
+        if (c > CATEGORY_COUNT || samples[c].empty()) {
+            continue;
+        }
+
+        cout << "  " << left << setw(7) << CATEGORY_NAMES[c] << right;
+        const double quantiles[3] = {0.50, 0.99, 0.999};
+        const char* labels[3] = {"p50", "p99", "p999"};
+        bool slower = false;
+        for (int q = 0; q < 3; q++) {
+            double before = atof(fields[2 + q].c_str());
+            double now = percentile(samples[c], quantiles[q]);
+            double change = before > 0 ? (now - before) * 100 / before : 0;
+            cout << "  " << labels[q] << " " << before << " -> " << now << " us (" << showpos << (int)change << noshowpos << "%)";
+            // p999 of a short run is a handful of samples, so only p50 and p99 decide
+            if (q < 2 && change > tolerance) {
+                slower = true;
+            }
+        }
+        cout << (slower ? "  REGRESSION" : "") << endl;
+        regressed = regressed || slower;
+    }
+    return true;
+}
+
+// parse arguments, start every session, answer prompts until all games end, report latency and compare with the baseline
+int main(int argc, char* argv[]) {
+    string gamePath = "./game";
+    int sessionCount = 8;
+    uint64_t seed = 1;
+    string saveDirectory = "";
+    string replayDirectory = "";
+    string saveBaselineFile = "";
+    string baselineFile = "";
+    double tolerance = 20;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--game" && i + 1 < argc) {
+            gamePath = argv[++i];
+        } else if (arg == "--sessions" && i + 1 < argc) {
+            sessionCount = atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--save-sessions" && i + 1 < argc) {
+            saveDirectory = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayDirectory = argv[++i];
+        } else if (arg == "--save-baseline" && i + 1 < argc) {
+            saveBaselineFile = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselineFile = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else {
+            cout << "Usage: ./ptyload [--game PATH] [--sessions N] [--seed N] [--save-sessions DIR] [--replay DIR] "
+                 << "[--save-baseline FILE] [--baseline FILE] [--tolerance PCT]" << endl;
+            return 1;
+        }
+    }
+    if (sessionCount < 1) {
+        sessionCount = 1;
+    }
+
+    char path[PATH_MAX];
+    if (realpath(gamePath.c_str(), path) == nullptr || access(path, X_OK) != 0) {
+        cout << "Error: Could not find the game binary " << gamePath << endl;
+        return 1;
+    }
+    gamePath = path;
+    string sourceDirectory = getcwd(path, sizeof(path)) != nullptr ? path : ".";
+
+    vector<PtySession> sessions;
+    if (!replayDirectory.empty()) {
+        for (int i = 0; ; i++) {
+            PtySession session = PtySession();
+            if (!loadSession(session, replayDirectory + "/session_" + to_string(i) + ".txt")) {
+                break;
+            }
+            session.replaying = true;
+            sessions.push_back(session);
+        }
+        if (sessions.empty()) {
+            cout << "Error: No sessions to replay in " << replayDirectory << endl;
+            return 1;
+        }
+    } else {
+        for (int i = 0; i < sessionCount; i++) {
+            PtySession session = PtySession();
+            session.seed = seed + i;
+            session.random.setState(session.seed * 0x9E3779B97F4A7C15ULL);
+            sessions.push_back(session);
+        }
+    }
+
+    char rootTemplate[] = "/tmp/ptyload.XXXXXX";
+    if (mkdtemp(rootTemplate) == nullptr) {
+        cout << "Error: Could not create a scratch directory" << endl;
+        return 1;
+    }
+    string root = rootTemplate;
+    signal(SIGPIPE, SIG_IGN);
+
+    int epollFd = epoll_create1(0);
+    for (int i = 0; i < (int)sessions.size(); i++) {
+        PtySession& session = sessions[i];
+        if (!prepareDirectory(session, root, i, sourceDirectory) || !startSession(session, gamePath)) {
+            cout << "Error: Could not start session " << i << endl;
+            return 1;
+        }
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, session.fd, &event);
+    }
+    cout << (replayDirectory.empty() ? "Started " : "Replaying ") << sessions.size() << " sessions of " << gamePath << endl;
+
+    vector<double> samples[CATEGORY_COUNT + 1];
+    int running = (int)sessions.size();
+    epoll_event events[256];
+    char buffer[16384];
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    while (running > 0) {
+        int count = epoll_wait(epollFd, events, 256, 10000);
+        if (count == 0) {
+            cout << "Error: No output for 10 seconds, " << running << " sessions stuck." << endl;
+            break;
+        }
+        for (int e = 0; e < count; e++) {
+            PtySession& session = sessions[events[e].data.u32];
+            ssize_t n = read(session.fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                // EIO once the game exits and closes its side of the terminal
+                if (n < 0 && errno == EAGAIN) {
+                    continue;
+                }
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+                close(session.fd);
+                session.fd = -1;
+                session.finished = session.received.find("GAME OVER!") != string::npos;
+                running--;
+                continue;
+            }
+            session.received.append(buffer, n);
+
+            bool atPrompt = session.received.size() >= 2 &&
+                            session.received.compare(session.received.size() - 2, 2, ": ") == 0;
+            if (!atPrompt) {
+                continue;
+            }
+
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            if (session.waiting) {
+                double micros = chrono::duration<double, micro>(now - session.sentAt).count();
+                samples[session.waitingCategory].push_back(micros);
+                samples[CATEGORY_COUNT].push_back(micros);
+            }
+
+            PromptKind kind = classifyPrompt(session.received);
+            string answer;
+            if (session.replaying) {
+                if (session.nextAnswer >= session.answers.size()) {
+                    session.desynced = true;
+                    kill(session.pid, SIGTERM);
+                    session.waiting = false;
+                    continue;
+                }
+                answer = session.answers[session.nextAnswer++];
+            } else {
+                answer = generateAnswer(session, kind);
+                session.answers.push_back(answer);
+            }
+            answer += "\n";
+
+            session.received.clear();
+            session.waitingCategory = categoryOf(kind);
+            session.sentAt = chrono::steady_clock::now();
+            session.waiting = write(session.fd, answer.data(), answer.size()) == (ssize_t)answer.size();
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int finished = 0;
+    int desynced = 0;
+    for (int i = 0; i < (int)sessions.size(); i++) {
+        PtySession& session = sessions[i];
+        if (session.fd >= 0) {
+            kill(session.pid, SIGKILL);
+            close(session.fd);
+        }
+        waitpid(session.pid, nullptr, 0);
+        removeDirectory(session.directory);
+        finished += session.finished;
+        desynced += session.desynced;
+        if (!saveDirectory.empty() && !session.replaying) {
+            mkdir(saveDirectory.c_str(), 0755);
+            if (!saveSession(session, saveDirectory + "/session_" + to_string(i) + ".txt")) {
+                cout << "Warning: Could not save session " << i << " to " << saveDirectory << endl;
+            }
+        }
+    }
+    rmdir(root.c_str());
+    close(epollFd);
+
+    cout << "Games finished: " << finished << " / " << sessions.size() << " in " << seconds << " s" << endl;
+    if (desynced > 0) {
+        cout << "Warning: " << desynced << " replayed sessions ran out of answers (the game asks different questions now)" << endl;
+    }
+    cout << "Prompt latency (us, answer written -> next prompt received):" << endl;
+    for (int c = 0; c <= CATEGORY_COUNT; c++) {
+        sort(samples[c].begin(), samples[c].end());
+        if (samples[c].empty()) {
+            continue;
+        }
+        cout << "  " << left << setw(7) << CATEGORY_NAMES[c] << right << setw(7) << samples[c].size() << " prompts"
+             << "  p50 " << percentile(samples[c], 0.50) << "  p99 " << percentile(samples[c], 0.99)
+             << "  p999 " << percentile(samples[c], 0.999)
+             << "  max " << (samples[c].empty() ? 0.0 : samples[c].back()) << endl;
+    }
+
+    if (!saveBaselineFile.empty()) {
+        if (saveBaseline(saveBaselineFile, samples)) {
+            cout << "Baseline written to " << saveBaselineFile << endl;
+        } else {
+            cout << "Warning: Could not write the baseline to " << saveBaselineFile << endl;
+        }
+    }
+    bool regressed = false;
+    if (!baselineFile.empty() && !compareBaseline(baselineFile, samples, tolerance, regressed)) {
+        cout << "Error: Could not read the baseline " << baselineFile << endl;
+        return 1;
+    }
+    return (finished == (int)sessions.size() && !regressed) ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+// Query tool for game results saved in columnar form (--stats FILE.col in the game, server or simulate)
+// Usage: ./results FILE [--where CONDITION]... [--group-by COLUMN[,COLUMN]] [--value COLUMN] [--import CSV]
+//   --where     keep rows meeting CONDITION: COLUMN=VALUE, or !=, <, <=, >, >= (character=NAME takes a name);
+//               several conditions must all hold
+//   --group-by  one output row per value of up to two of player, character, path_type, advisor, won
+//   --value     column whose mean, min and max are shown (default final_discovery_points)
+//   --import    first append the rows of a CSV written by --stats FILE to FILE (rows written before path_type,
+//               advisor and won were recorded are skipped)
+// Prints rows, wins, win rate and the value column's mean/min/max per group, then how many rows were scanned,
+// how many row groups the zone maps skipped and the scan rate. Example (win rate of one character on Direct Lab
+// Assignment with advisor 3):
+//   ./results results.col --where character=Dr.Panthera --where path_type=1 --where advisor=3
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ContentParser.h"
+#include "ResultsTable.h"
+#include "StatsSink.h"
+
+using namespace std;
+
+static const char* const PATH_NAMES[2] = {"Training Fellowship", "Direct Lab Assignment"};
+
+// split a CSV line on commas, undoing the quoting StatsSink uses for names (fields is reused)
+static void splitCsvLine(string_view line, vector<string>& fields) {
+    fields.clear();
+    fields.emplace_back();
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back().push_back('"');
+                i++;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.back().push_back(c);
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c != '\r') {
+            fields.back().push_back(c);
+        }
+    }
+}
+
+// read every 14-field row of csvFile into a record and push it through a StatsSink writing filename
+static bool importCsv(const string& csvFile, const string& filename) {
+    MappedFile file;
+    if (!file.open(csvFile)) {
+        cout << "Error: Could not open " << csvFile << endl;
+        return false;
+    }
+    StatsSink sink;
+    if (!sink.open(filename)) {
+        cout << "Error: Could not open " << filename << " for writing." << endl;
+        return false;
+    }
+
+    PipeRecordReader reader(file.data(), file.size());
+    string_view line;
+    vector<string> fields;
+    long long imported = 0;
+    long long skipped = 0;
+    while (reader.nextLine(line)) {
+        if (line.empty() || line.compare(0, 8, "game_id,") == 0) {
+            continue;
+        }
+        splitCsvLine(line, fields);
+        // fields: game_id, finished_at, player, character, experience ... position, path_type, advisor, won
+        StatsRecord record;
+        int32_t* numbers[11] = {&record.playerNumber, &record.experience, &record.accuracy, &record.efficiency,
+                                &record.insight, &record.discoverPoints, &record.finalDiscoverPoints, &record.position,
+                                &record.pathType, &record.advisor, &record.won};
+        bool valid = fields.size() == 14;
+        for (int i = 0; i < 11 && valid; i++) {
+            int value;
+            valid = parseInt(fields[i == 0 ? 2 : i + 3], value);
+            *numbers[i] = value;
+        }
+        if (!valid) {
+            skipped++;
+            continue;
+        }
+        record.gameId = strtoull(fields[0].c_str(), nullptr, 10);
+        record.finishedAt = strtoll(fields[1].c_str(), nullptr, 10);
+        size_t length = min(fields[3].size(), sizeof(record.characterName) - 1);
+        memcpy(record.characterName, fields[3].data(), length);
+        record.characterName[length] = '\0';
+        sink.push(record);
+        imported++;
+    }
+    sink.close();
+    if (sink.getFailedCount() > 0) {
+        cout << "Error: " << sink.getFailedCount() << " of " << imported << " rows could not be written to " << filename << endl;
+        return false;
+    }
+    cout << "Imported " << imported << " rows from " << csvFile;
+    if (skipped > 0) {
+        cout << " (" << skipped << " rows without path, advisor and win columns skipped)";
+    }
+    cout << endl;
+    return true;
+}
+
+// the label of one group key: character names and path names instead of numbers
+static string keyLabel(const ResultsTable& table, int column, int key) {
+    if (column == RESULT_CHARACTER && key < (int)table.getCharacterNames().size()) {
+        return table.getCharacterNames()[key];
+    }
+    if (column == RESULT_PATH_TYPE && key < 2) {
+        return PATH_NAMES[key];
+    }
+    return to_string(key);
+}
+
+// parse arguments, import if asked, open the file, run the query, print one line per group and the scan rate
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        cout << "Usage: ./results FILE [--where CONDITION]... [--group-by COLUMN[,COLUMN]] [--value COLUMN] [--import CSV]" << endl;
+        return 1;
+    }
+    string filename = argv[1];
+    vector<string> conditions;
+    string groupBy = "";
+    string valueName = "final_discovery_points";
+    string importFile = "";
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--where" && i + 1 < argc) {
+            conditions.push_back(argv[++i]);
+        } else if (arg == "--group-by" && i + 1 < argc) {
+            groupBy = argv[++i];
+        } else if (arg == "--value" && i + 1 < argc) {
+            valueName = argv[++i];
+        } else if (arg == "--import" && i + 1 < argc) {
+            importFile = argv[++i];
+        } else {
+            cout << "Usage: ./results FILE [--where CONDITION]... [--group-by COLUMN[,COLUMN]] [--value COLUMN] [--import CSV]" << endl;
+            return 1;
+        }
+    }
+    if (!importFile.empty() && !importCsv(importFile, filename)) {
+        return 1;
+    }
+
+    ResultsTable table;
+    if (!table.open(filename)) {
+        cout << "Error: " << filename << " is not a results file (write one with --stats FILE.col)." << endl;
+        return 1;
+    }
+    if (table.isTruncated()) {
+        cout << "Warning: " << filename << " ends in a partly written row group, which is left out." << endl;
+    }
+
+    ResultsQuery query;
+    string error;
+    for (const string& condition : conditions) {
+        ResultsFilter filter;
+        if (!parseResultsFilter(condition, table, filter, error)) {
+            cout << "Error: " << error << endl;
+            return 1;
+        }
+        query.filters.push_back(filter);
+    }
+    stringstream groups(groupBy);
+    string name;
+    while (getline(groups, name, ',')) {
+        query.groupBy.push_back(findResultsColumn(name));
+    }
+    query.valueColumn = findResultsColumn(valueName);
+    if (!checkResultsQuery(query, error)) {
+        cout << "Error: " << error << endl;
+        return 1;
+    }
+
+    ResultsQueryResult result;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    runResultsQuery(table, query, result);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (const ResultsGroup& group : result.groups) {
+        string label = "all rows";
+        if (!query.groupBy.empty()) {
+            label = keyLabel(table, query.groupBy[0], group.keys[0]);
+            if (query.groupBy.size() == 2) {
+                label += " / " + keyLabel(table, query.groupBy[1], group.keys[1]);
+            }
+        }
+        cout << left << setw(40) << label << right << " rows " << setw(10) << group.rows << "  wins " << setw(10)
+             << group.wins << "  win rate " << fixed << setprecision(1) << setw(5) << 100.0 * group.wins / group.rows
+             << "%  " << valueName << " mean " << setprecision(0) << (double)group.sum / group.rows << " min "
+             << group.minimum << " max " << group.maximum << endl;
+    }
+    if (result.groups.empty()) {
+        cout << "No rows match." << endl;
+    }
+    cout << defaultfloat << setprecision(6) << "Scanned " << result.rowsScanned << " of " << table.getRowCount()
+         << " rows in " << seconds * 1000 << " ms (" << (long long)(result.rowsScanned / max(seconds, 1e-9) / 1e6)
+         << " M rows/s), " << result.rowGroupsSkipped << " of " << table.getRowGroups().size()
+         << " row groups skipped by zone maps" << endl;
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Contamination screening: builds a k-mer filter from contaminant strands, then reports how much of each
+// query strand's k-mers it contains
+// Usage: ./screen --build FILE... --filter OUT [--k N] [--bits B]
+//        ./screen --filter FILE [--threshold F] [--quiet] QUERY...
+//   --build      contaminant strands to add (FASTA or one strand per line, .gz or plain); the filter is sized
+//                from the files' sizes (compressed files are assumed to hold 4 bases per byte)
+//   --filter     where the built filter is written, or the filter to screen against
+//   --k          k-mer length, 1-31 (default 31)
+//   --bits       bits of filter per k-mer (default 16: about 1 absent k-mer in 1000 reported as present)
+//   --threshold  a strand is flagged as contaminated when at least this fraction of its k-mers hit (default 0.1)
+//   --quiet      only print flagged strands and the summary
+// A query of "-" reads standard input. Prints one line per strand (name, k-mers, hits, hit fraction, flag) and
+// a summary with the screening rate in bases per second and gigabases per minute.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#include "KmerFilter.h"
+#include "StrandReader.h"
+
+using namespace std;
+
+// bases the files probably hold, from their sizes
+static long long estimateBases(const vector<string>& files) {
+    long long bases = 0;
+    for (const string& file : files) {
+        struct stat info;
+        if (stat(file.c_str(), &info) != 0) {
+            continue;
+        }
+        bool compressed = file.size() > 3 && file.compare(file.size() - 3, 3, ".gz") == 0;
+        bases += compressed ? info.st_size * 4 : info.st_size;
+    }
+    return bases;
+}
+
+// add every strand of the contaminant files, then save the filter
+static int buildFilter(const vector<string>& files, const string& output, int k, double bits) {
+    KmerFilter filter(k, estimateBases(files), bits);
+    StrandReader reader;
+    string name;
+    string sequence;
+    long long strands = 0;
+    long long bases = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (const string& file : files) {
+        if (!reader.open(file)) {
+            cout << "Error: Could not open " << file << endl;
+            return 1;
+        }
+        while (reader.next(name, sequence)) {
+            filter.add(sequence);
+            strands++;
+            bases += sequence.size();
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!filter.save(output)) {
+        cout << "Error: Could not write " << output << endl;
+        return 1;
+    }
+    cout << "Added " << filter.getAddedCount() << " " << filter.getK() << "-mers from " << strands << " strands ("
+         << bases << " bases) in " << seconds << " s" << endl;
+    cout << "Filter: " << filter.getMemoryBytes() / 1048576.0 << " MB ("
+         << filter.getMemoryBytes() * 8.0 / max(filter.getAddedCount(), 1LL) << " bits per k-mer), about "
+         << filter.getFalsePositiveRate() * 100 << "% false hits, written to " << output << endl;
+    return 0;
+}
+
+// stream every query strand through the filter, print its hit fraction and the totals
+static int screenStrands(const vector<string>& files, const string& filterFile, double threshold, bool quiet) {
+    KmerFilter filter;
+    if (!filter.load(filterFile)) {
+        cout << "Error: " << filterFile << " is not a k-mer filter (build one with --build)." << endl;
+        return 1;
+    }
+    StrandReader reader;
+    string name;
+    string sequence;
+    long long strands = 0;
+    long long flagged = 0;
+    long long bases = 0;
+    double readSeconds = 0;
+    double screenSeconds = 0;
+    for (const string& file : files) {
+        if (!reader.open(file)) {
+            cout << "Error: Could not open " << file << endl;
+            return 1;
+        }
+        chrono::steady_clock::time_point before = chrono::steady_clock::now();
+        while (reader.next(name, sequence)) {
+            chrono::steady_clock::time_point read = chrono::steady_clock::now();
+            KmerScreenResult result = filter.screen(sequence);
+            chrono::steady_clock::time_point screened = chrono::steady_clock::now();
+            readSeconds += chrono::duration<double>(read - before).count();
+            screenSeconds += chrono::duration<double>(screened - read).count();
+            before = screened;
+
+            bool contaminated = result.kmers > 0 && result.getHitFraction() >= threshold;
+            strands++;
+            flagged += contaminated;
+            bases += sequence.size();
+            if (!quiet || contaminated) {
+                cout << name << "\t" << result.kmers << "\t" << result.hits << "\t" << result.getHitFraction()
+                     << (contaminated ? "\tCONTAMINATED" : "") << "\n";
+            }
+        }
+    }
+    double totalSeconds = readSeconds + screenSeconds;
+    cout << "Screened " << strands << " strands (" << bases << " bases), " << flagged << " flagged at "
+         << threshold * 100 << "% k-mer hits" << endl;
+    cout << "Screening: " << (long long)(bases / max(screenSeconds, 1e-9) / 1e6) << " Mbases/s ("
+         << bases / max(screenSeconds, 1e-9) * 60 / 1e9 << " Gbases/min); with reading: "
+         << (long long)(bases / max(totalSeconds, 1e-9) / 1e6) << " Mbases/s" << endl;
+    return 0;
+}
+
+// parse arguments, build or screen
+int main(int argc, char* argv[]) {
+    vector<string> buildFiles;
+    vector<string> queryFiles;
+    string filterFile = "";
+    int k = 31;
+    double bits = 16;
+    double threshold = 0.1;
+    bool quiet = false;
+    bool building = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--build") {
+            building = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filterFile = argv[++i];
+        } else if (arg == "--k" && i + 1 < argc) {
+            k = atoi(argv[++i]);
+        } else if (arg == "--bits" && i + 1 < argc) {
+            bits = atof(argv[++i]);
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            filterFile = "";
+            break;
+        } else {
+            (building ? buildFiles : queryFiles).push_back(arg);
+        }
+    }
+    if (filterFile.empty() || (building ? buildFiles.empty() : queryFiles.empty()) || k < 1 || k > 31 || bits <= 0) {
+        cout << "Usage: ./screen --build FILE... --filter OUT [--k N] [--bits B]" << endl;
+        cout << "       ./screen --filter FILE [--threshold F] [--quiet] QUERY..." << endl;
+        return 1;
+    }
+    return building ? buildFilter(buildFiles, filterFile, k, bits) : screenStrands(queryFiles, filterFile, threshold, quiet);
+}
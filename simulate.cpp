@@ -0,0 +1,589 @@
+// Headless simulation: plays many games back to back with scripted answers and no output
+// Usage: ./simulate [--games N] [--players N] [--seed N] [--threads N] [--arena] [--bots] [--balance GAP]
+//                  [--tile-mix FILE] [--trace FILE] [--metrics FILE] [--cache-mb N] [--stats FILE] [--count-allocations]
+//                  [--odds] [--processes N]
+//   --games              games to play (default 1000)
+//   --players            players per game (default 2)
+//   --seed               seed for the first game, game i uses seed + i (default 1)
+//   --threads            threads playing games side by side, thread t plays games t, t + N, ... (default 1)
+//   --arena              give every game's state a GameArena instead of the default allocator
+//   --bots               players choose path and advisor with the BotPlanner instead of the script
+//   --balance            re-roll lanes until their expected points are within GAP of each other
+//   --tile-mix           generate lanes with the tile mix in FILE (as written by the tune tool)
+//   --trace              write the run's turn spans to FILE as Chrome trace JSON (builds with -DGENOME_TRACE)
+//   --metrics            write the game metrics (Prometheus text) to FILE after the run, print the kernel
+//                        latencies and what recording one counter / histogram value costs
+//   --stats              record every game's results in FILE like the game does (FILE.col for the results tool)
+//   --cache-mb           cache the pink and red task results in a ResultCache of N MB and print its hit rate
+//   --count-allocations  count heap allocations in every turn and exit with status 1 if any turn allocated
+//                        (single thread only, since the counter is process wide)
+//   --processes          instead of threads: fork N worker processes, each playing its own range of seeds, and
+//                        report wins per seat, the final score distribution and per-tile stats gathered in shared
+//                        memory (a range whose worker crashes is played again by a new worker); not with --stats
+//   --odds               instead of a run: exact win/tie odds (MatchOdds) for the two-player board of game seed,
+//                        checked against --games replays of that board with different dice
+// Each thread plays one untimed warm-up game first, so buffers and arenas have reached their final size.
+// Every player picks a character in turn and the Direct Lab Assignment path (or the bot's choice); each turn answers
+// "5" (move forward) and two DNA strands. Extra lines are taken as invalid menu choices, so the
+// script stays in step whatever tile a player lands on.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AllocationCounter.h"
+#include "BotPlanner.h"
+#include "ContentStore.h"
+#include "Game.h"
+#include "GameArena.h"
+#include "GameState.h"
+#include "MatchOdds.h"
+#include "Metrics.h"
+#include "ProcessSweep.h"
+#include "ResultCache.h"
+#include "ScriptedIO.h"
+#include "StatsSink.h"
+#include "Trace.h"
+
+using namespace std;
+
+// strands longer than the small-string buffer, so reused answer buffers are actually exercised
+static const char TURN_SCRIPT[] = "5\nACGTACGTACGTACGTACGTACGT\nACGTACGTACGAACGTACGTACGT\n";
+
+// what to simulate, from the command line
+struct SimulationOptions {
+    int games;
+    int playerCount;
+    uint64_t seed;
+    int threads;
+    bool useArena;
+    bool countAllocations;
+    SetupOptions setup;         // tile mix, lane balancing, bots (nullptr = scripted path choice)
+    StatsSink* stats;           // every timed game's results are recorded here (nullptr = not recorded)
+};
+
+// turn counts and allocations over one thread's games
+struct SimulationTotals {
+    long long games;
+    long long turns;
+    long long countedTurns;
+    long long allocations;
+    long long maxTurnAllocations;
+};
+
+// play turns from the turn script until everyone has finished, counting turns (and their allocations)
+static void playToEnd(GameState& state, ContentReader& reader, bool countAllocations, TurnBuffers& buffers,
+                      istream& turnIn, ostream& out, SimulationTotals& totals) {
+    int playerCount = state.players.size();
+    int finishedCount = 0;
+    for (int i = 0; i < playerCount; i++) {
+        if (state.finished[i]) {
+            finishedCount++;
+        }
+    }
+    while (finishedCount < playerCount) {
+        int playerIndex = state.turn % playerCount;
+        if (state.finished[playerIndex]) {
+            state.turn++;
+            continue;
+        }
+
+        long long before = getAllocationCount();
+        if (playTurn(state, playerIndex, reader.pin(), buffers, turnIn, out)) {
+            state.finished[playerIndex] = true;
+            finishedCount++;
+        }
+        reader.unpin();
+        long long allocations = getAllocationCount() - before;
+
+        if (countAllocations) {
+            totals.countedTurns++;
+            totals.allocations += allocations;
+            if (allocations > totals.maxTurnAllocations) {
+                totals.maxTurnAllocations = allocations;
+            }
+        }
+        totals.turns++;
+        state.turn++;
+    }
+    totals.games++;
+}
+
+// set up a game (state allocated from resource) from the setup script, then play it to the end and record it in stats
+static void simulateGame(ContentStore& content, const SimulationOptions& options, uint64_t seed, bool countAllocations,
+                         pmr::memory_resource* resource, TurnBuffers& buffers, istream& setupIn, istream& turnIn,
+                         ostream& out, SimulationTotals& totals, StatsSink* stats) {
+    ContentReader reader(content);
+    GameState state(resource);
+    state.random.setState(seed);
+    setupGame(state, content, options.playerCount, setupIn, out, options.setup);
+    playToEnd(state, reader, countAllocations, buffers, turnIn, out, totals);
+    if (stats != nullptr) {
+        // one per thread, so recording stops allocating once it has grown to the player count
+        static thread_local vector<int> finalDP;
+        finalDP.resize(state.players.size());
+        for (int i = 0; i < (int)state.players.size(); i++) {
+            finalDP[i] = calculateFinalDiscoverPoints(state.players[i]);
+        }
+        stats->recordGame(state.players, finalDP);
+    }
+}
+
+// set up the game for seed, compute its exact odds, then replay the starting state with other dice and
+// compare the observed outcomes; mismatch = more than 4 standard errors off (exit status 1)
+static int checkOdds(ContentStore& content, const SimulationOptions& options) {
+    ContentReader reader(content);
+    const GameData& gameData = reader.pin();
+    string setupAnswers = options.setup.bots != nullptr ? "1\n2\n" : "1\n2\n2\n2\n";
+    istringstream setupIn(setupAnswers);
+    NullOutput discard;
+    ostream out(&discard);
+
+    GameState initial;
+    initial.random.setState(options.seed);
+    setupGame(initial, content, 2, setupIn, out, options.setup);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    MatchOdds odds = computeMatchOdds(initial.board, initial.players[0], initial.players[1], gameData);
+    double exactSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    reader.unpin();
+
+    ScriptedInput turnScript(TURN_SCRIPT, sizeof(TURN_SCRIPT) - 1);
+    istream turnIn(&turnScript);
+    TurnBuffers buffers;
+    SimulationTotals totals = {0, 0, 0, 0, 0};
+    long long wins[2] = {0, 0};
+    long long ties = 0;
+    double scoreTotal[2] = {0, 0};
+    for (int run = 0; run < options.games; run++) {
+        GameState state = initial;
+        state.random.setState(options.seed * 1000003 + run + 1);
+        playToEnd(state, reader, false, buffers, turnIn, out, totals);
+        int first = calculateFinalDiscoverPoints(state.players[0]);
+        int second = calculateFinalDiscoverPoints(state.players[1]);
+        scoreTotal[0] += first;
+        scoreTotal[1] += second;
+        if (first > second) {
+            wins[0]++;
+        } else if (second > first) {
+            wins[1]++;
+        } else {
+            ties++;
+        }
+    }
+
+    cout << "Exact odds in " << exactSeconds * 1000 << " ms, checked against " << options.games << " replays:" << endl;
+    const char* labels[3] = {"Player 1 wins", "Player 2 wins", "Tie"};
+    double exact[3] = {odds.winProbability[0], odds.winProbability[1], odds.tieProbability};
+    long long observed[3] = {wins[0], wins[1], ties};
+    bool matches = true;
+    for (int i = 0; i < 3; i++) {
+        double rate = (double)observed[i] / options.games;
+        double error = sqrt(exact[i] * (1 - exact[i]) / options.games);
+        bool close = fabs(rate - exact[i]) <= 4 * error + 1e-12;
+        matches = matches && close;
+        cout << "  " << labels[i] << ": exact " << exact[i] << ", observed " << rate << (close ? "" : "  MISMATCH") << endl;
+    }
+    for (int i = 0; i < 2; i++) {
+        cout << "  Player " << (i + 1) << " mean score: exact " << odds.scores[i].mean() << ", observed "
+             << scoreTotal[i] / options.games << endl;
+    }
+    cout << (matches ? "Odds match the replays" : "Odds do NOT match the replays") << endl;
+    return matches ? 0 : 1;
+}
+
+// one worker process: play games [begin, end) with the setup script, adding each game's winner, final scores,
+// turns and tile landings / task results (the change in this process's game metrics) to stats
+static void playSweepRange(ContentStore& content, const SimulationOptions& options, long long begin, long long end,
+                           SweepStats& stats) {
+    ContentReader reader(content);
+    int characterCount = reader.pin().getCharacterCount();
+    reader.unpin();
+    string setupAnswers;
+    for (int i = 0; i < options.playerCount; i++) {
+        setupAnswers += to_string(i % characterCount + 1) + (options.setup.bots != nullptr ? "\n" : "\n2\n");
+    }
+
+    ScriptedInput setupScript(setupAnswers.data(), setupAnswers.size());
+    istream setupIn(&setupScript);
+    ScriptedInput turnScript(TURN_SCRIPT, sizeof(TURN_SCRIPT) - 1);
+    istream turnIn(&turnScript);
+    NullOutput discard;
+    ostream out(&discard);
+    TurnBuffers buffers;
+    const GameMetrics& metrics = getGameMetrics();
+
+    for (long long g = begin; g < end; g++) {
+        long long landings[TILE_CODE_COUNT];
+        long long passed[TILE_CODE_COUNT];
+        long long failed[TILE_CODE_COUNT];
+        for (int c = 0; c < TILE_CODE_COUNT; c++) {
+            landings[c] = metrics.landings[c]->getValue();
+            passed[c] = metrics.tasksPassed[c] != nullptr ? metrics.tasksPassed[c]->getValue() : 0;
+            failed[c] = metrics.tasksFailed[c] != nullptr ? metrics.tasksFailed[c]->getValue() : 0;
+        }
+
+        GameState state;
+        state.random.setState(options.seed + g);
+        setupGame(state, content, options.playerCount, setupIn, out, options.setup);
+        SimulationTotals totals = {0, 0, 0, 0, 0};
+        playToEnd(state, reader, false, buffers, turnIn, out, totals);
+
+        int best = 0;
+        int bestCount = 0;
+        int winner = 0;
+        for (int i = 0; i < (int)state.players.size(); i++) {
+            int score = calculateFinalDiscoverPoints(state.players[i]);
+            stats.recordScore(score);
+            if (i == 0 || score > best) {
+                best = score;
+                bestCount = 1;
+                winner = i;
+            } else if (score == best) {
+                bestCount++;
+            }
+        }
+        if (bestCount > 1) {
+            stats.ties.fetch_add(1, memory_order_relaxed);
+        } else {
+            stats.wins[winner].fetch_add(1, memory_order_relaxed);
+        }
+        for (int c = 0; c < TILE_CODE_COUNT; c++) {
+            stats.landings[c].fetch_add(metrics.landings[c]->getValue() - landings[c], memory_order_relaxed);
+            if (metrics.tasksPassed[c] != nullptr) {
+                stats.tasksPassed[c].fetch_add(metrics.tasksPassed[c]->getValue() - passed[c], memory_order_relaxed);
+                stats.tasksFailed[c].fetch_add(metrics.tasksFailed[c]->getValue() - failed[c], memory_order_relaxed);
+            }
+        }
+        stats.turns.fetch_add(totals.turns, memory_order_relaxed);
+        stats.games.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+// fork the worker processes, then print what they added up to; exit status 1 if a range never finished
+static int runSweep(ContentStore& content, const SimulationOptions& options, int processes) {
+    if (options.playerCount > SWEEP_MAX_PLAYERS) {
+        cout << "Error: --processes supports up to " << SWEEP_MAX_PLAYERS << " players per game." << endl;
+        return 1;
+    }
+    // registered before the fork, so every worker inherits the same counters
+    getGameMetrics();
+
+    SweepStats total;
+    int reruns = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool complete = runProcessSweep(processes, options.games, [&](long long begin, long long end, SweepStats& stats) {
+        playSweepRange(content, options, begin, end, stats);
+    }, total, reruns, cout);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long games = total.games.load();
+    cout << "Games: " << games << ", turns: " << total.turns.load() << " in " << seconds << " s ("
+         << (long long)(games / seconds) << " games/s) on " << processes << " process"
+         << (processes == 1 ? "" : "es") << ", " << reruns << " range" << (reruns == 1 ? "" : "s") << " rerun" << endl;
+    if (games == 0) {
+        return 1;
+    }
+    for (int i = 0; i < options.playerCount; i++) {
+        cout << "  Player " << (i + 1) << " wins: " << 100.0 * total.wins[i].load() / games << "%" << endl;
+    }
+    cout << "  Ties: " << 100.0 * total.ties.load() / games << "%" << endl;
+    cout << "  Final Discovery Points: p10 " << total.scoreQuantile(0.1) << ", p50 " << total.scoreQuantile(0.5)
+         << ", p90 " << total.scoreQuantile(0.9) << " (buckets of " << SWEEP_SCORE_BUCKET_WIDTH << ")" << endl;
+    static const char* const colorNames[TILE_CODE_COUNT] = {"start", "green", "blue", "pink", "brown", "red", "purple", "finish"};
+    for (int c = 0; c < TILE_CODE_COUNT; c++) {
+        long long landed = total.landings[c].load();
+        long long tasks = total.tasksPassed[c].load() + total.tasksFailed[c].load();
+        if (landed == 0) {
+            continue;
+        }
+        cout << "  " << colorNames[c] << " tiles: " << (double)landed / games << " landings per game";
+        if (tasks > 0) {
+            cout << ", " << 100.0 * total.tasksPassed[c].load() / tasks << "% of tasks passed";
+        }
+        cout << endl;
+    }
+    return complete ? 0 : 1;
+}
+
+// one thread: own streams, answer buffers and arena; warm up, wait for the start signal, then play
+// games worker, worker + threads, ... (the arena is reset after every game)
+static void runWorker(ContentStore& content, const SimulationOptions& options, int worker,
+                      atomic<int>& ready, atomic<bool>& go, SimulationTotals& totals) {
+    // every player picks a character in turn and the Direct Lab Assignment path (bots pick their own);
+    // the script is read exactly once per game, so a cycling input stays in step without rebuilding it
+    ContentReader reader(content);
+    int characterCount = reader.pin().getCharacterCount();
+    reader.unpin();
+    string setupAnswers;
+    for (int i = 0; i < options.playerCount; i++) {
+        setupAnswers += to_string(i % characterCount + 1) + (options.setup.bots != nullptr ? "\n" : "\n2\n");
+    }
+
+    ScriptedInput setupScript(setupAnswers.data(), setupAnswers.size());
+    istream setupIn(&setupScript);
+    ScriptedInput turnScript(TURN_SCRIPT, sizeof(TURN_SCRIPT) - 1);
+    istream turnIn(&turnScript);
+    NullOutput discard;
+    ostream out(&discard);
+    TurnBuffers buffers;
+    GameArena arena;
+    pmr::memory_resource* resource = options.useArena ? arena.getResource() : pmr::get_default_resource();
+
+    SimulationTotals warmUp = {0, 0, 0, 0, 0};
+    simulateGame(content, options, options.seed + worker, false, resource, buffers, setupIn, turnIn,
+                 out, warmUp, nullptr);
+    arena.reset();
+
+    ready.fetch_add(1);
+    while (!go.load()) {
+        this_thread::yield();
+    }
+
+    for (int g = worker; g < options.games; g += options.threads) {
+        simulateGame(content, options, options.seed + g, options.countAllocations, resource, buffers,
+                     setupIn, turnIn, out, totals, options.stats);
+        arena.reset();
+    }
+}
+
+// time recording into a scratch counter and histogram (values spread like kernel latencies), in ns per call
+static void measureMetricsOverhead(double& counterNs, double& histogramNs) {
+    MetricsRegistry scratch;
+    Counter& counter = scratch.addCounter("scratch_total", "scratch");
+    Histogram& histogram = scratch.addHistogram("scratch", "scratch");
+    const int rounds = 10000000;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        counter.add();
+    }
+    counterNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / rounds;
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        histogram.record(100 + (i & 1023) * 37);
+    }
+    histogramNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / rounds;
+    if (counter.getValue() + histogram.getCount() != 2ULL * rounds) {
+        cout << "Warning: metrics lost updates" << endl;
+    }
+}
+
+// write the registry to file, print kernel latency quantiles and the recording cost
+static void reportMetrics(const string& file) {
+    ofstream out(file);
+    getMetricsRegistry().writePrometheus(out);
+    out.close();
+    if (!out) {
+        cout << "Warning: Could not write the metrics to " << file << "." << endl;
+    } else {
+        cout << "Metrics written to " << file << endl;
+    }
+
+    const GameMetrics& metrics = getGameMetrics();
+    const char* names[] = {"strandSimilarity", "bestStrandMatch", "identifyMutations", "transcribeDNAtoRNA"};
+    const Histogram* kernels[] = {metrics.strandSimilarityNs, metrics.bestStrandMatchNs, metrics.identifyMutationsNs,
+                                  metrics.transcribeNs};
+    for (int k = 0; k < 4; k++) {
+        cout << "  " << names[k] << ": " << kernels[k]->getCount() << " calls, p50 " << kernels[k]->getQuantile(0.5)
+             << " ns, p99 " << kernels[k]->getQuantile(0.99) << " ns" << endl;
+    }
+    double counterNs, histogramNs;
+    measureMetricsOverhead(counterNs, histogramNs);
+    cout << "  recording: counter add " << counterNs << " ns, histogram record " << histogramNs << " ns" << endl;
+}
+
+// parse arguments, load content, play the games, report speed and allocations
+int main(int argc, char* argv[]) {
+    SimulationOptions options = {1000, 2, 1, 1, false, false, SetupOptions(), nullptr};
+    bool useBots = false;
+    bool checkOddsOnly = false;
+    int processes = 0;
+    string traceFile = "";
+    string metricsFile = "";
+    int cacheMegabytes = 0;
+    string statsFile = "";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--games" && i + 1 < argc) {
+            options.games = atoi(argv[++i]);
+        } else if (arg == "--players" && i + 1 < argc) {
+            options.playerCount = atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg == "--arena") {
+            options.useArena = true;
+        } else if (arg == "--bots") {
+            useBots = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (arg == "--cache-mb" && i + 1 < argc) {
+            cacheMegabytes = atoi(argv[++i]);
+        } else if (arg == "--balance" && i + 1 < argc) {
+            options.setup.maxLaneGap = atoi(argv[++i]);
+        } else if (arg == "--tile-mix" && i + 1 < argc) {
+            if (!loadTileMix(argv[++i], options.setup.tileMix, cout)) {
+                cout << "Error: Could not read a tile mix from " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--count-allocations") {
+            options.countAllocations = true;
+        } else if (arg == "--processes" && i + 1 < argc) {
+            processes = atoi(argv[++i]);
+        } else if (arg == "--odds") {
+            checkOddsOnly = true;
+        } else {
+            cout << "Usage: ./simulate [--games N] [--players N] [--seed N] [--threads N] [--arena] [--bots] "
+                 << "[--balance GAP] [--tile-mix FILE] [--trace FILE] [--metrics FILE] [--cache-mb N] [--stats FILE] [--count-allocations] "
+                 << "[--odds] [--processes N]" << endl;
+            return 1;
+        }
+    }
+    if (options.games < 1) {
+        options.games = 1;
+    }
+    if (options.playerCount < 1) {
+        options.playerCount = 2;
+    }
+    if (options.threads < 1) {
+        options.threads = 1;
+    }
+    if (options.countAllocations && options.threads > 1) {
+        cout << "Error: --count-allocations needs a single thread (the allocation counter is process wide)." << endl;
+        return 1;
+    }
+    // the sweep's workers only report merged counts, and the stats writer thread mustn't be running when they fork
+    if (processes > 0 && !statsFile.empty()) {
+        cout << "Error: --stats can't be used with --processes (the workers don't record per-game rows)." << endl;
+        return 1;
+    }
+
+    GameData* gameData = new GameData();
+    loadGameData(*gameData, cout);
+    ContentStore content(gameData);
+
+    StatsSink stats;
+    if (!statsFile.empty()) {
+        if (!stats.open(statsFile)) {
+            cout << "Error: Could not open " << statsFile << endl;
+            return 1;
+        }
+        options.stats = &stats;
+    }
+
+    unique_ptr<ResultCache> cache;
+    if (cacheMegabytes > 0) {
+        cache.reset(new ResultCache((size_t)cacheMegabytes << 20));
+        setResultCache(cache.get());
+    }
+
+    // the planner reads the event tables once; time a decision on a fresh board before the run
+    BotPlanner planner(*gameData);
+    if (useBots) {
+        options.setup.bots = &planner;
+        Board board(options.playerCount, 52);
+        Player character = gameData->getCharacter(0);
+        const int rounds = 10000;
+        double expectedTotal = 0;
+        chrono::steady_clock::time_point decideStart = chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            expectedTotal += planner.decide(board, r % options.playerCount, character).expectedScore;
+        }
+        double decideSeconds = chrono::duration<double>(chrono::steady_clock::now() - decideStart).count();
+        cout << "Bot decision: " << decideSeconds * 1e6 / rounds << " us (" << character.getCharacterName()
+             << " expects " << (int)(expectedTotal / rounds) << " final Discovery Points on average)" << endl;
+    }
+    if (checkOddsOnly) {
+        return checkOdds(content, options);
+    }
+    if (processes > 0) {
+        return runSweep(content, options, processes);
+    }
+
+    vector<SimulationTotals> workerTotals(options.threads, SimulationTotals{0, 0, 0, 0, 0});
+    vector<thread> workers;
+    atomic<int> ready(0);
+    atomic<bool> go(false);
+    for (int t = 0; t < options.threads; t++) {
+        workers.push_back(thread(runWorker, ref(content), cref(options), t, ref(ready), ref(go), ref(workerTotals[t])));
+    }
+    while (ready.load() < options.threads) {
+        this_thread::yield();
+    }
+
+    long long allocationsBefore = getAllocationCount();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    go.store(true);
+    for (int t = 0; t < options.threads; t++) {
+        workers[t].join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long long allocations = getAllocationCount() - allocationsBefore;
+
+    SimulationTotals totals = {0, 0, 0, 0, 0};
+    for (int t = 0; t < options.threads; t++) {
+        totals.games += workerTotals[t].games;
+        totals.turns += workerTotals[t].turns;
+        totals.countedTurns += workerTotals[t].countedTurns;
+        totals.allocations += workerTotals[t].allocations;
+        if (workerTotals[t].maxTurnAllocations > totals.maxTurnAllocations) {
+            totals.maxTurnAllocations = workerTotals[t].maxTurnAllocations;
+        }
+    }
+
+    cout << "Games: " << totals.games << ", turns: " << totals.turns << " in " << seconds << " s ("
+         << (long long)(totals.games / seconds) << " games/s, " << (long long)(totals.turns / seconds)
+         << " turns/s) on " << options.threads << " thread" << (options.threads == 1 ? "" : "s")
+         << (options.useArena ? " with game arenas" : " with the default allocator") << endl;
+    cout << "Heap allocations: " << allocations << " (" << (double)allocations / totals.games << " per game)" << endl;
+    if (!traceFile.empty()) {
+        if (!isTracingCompiled()) {
+            cout << "Warning: Tracing is compiled out of this build (compile with -DGENOME_TRACE)." << endl;
+        } else if (writeChromeTrace(traceFile)) {
+            cout << "Trace written to " << traceFile << endl;
+        } else {
+            cout << "Warning: Could not write the trace to " << traceFile << "." << endl;
+        }
+    }
+
+    if (options.stats != nullptr) {
+        stats.close();
+        cout << "Results of " << totals.games << " games written to " << statsFile << endl;
+    }
+
+    if (cache) {
+        uint64_t lookups = cache->getHits() + cache->getMisses();
+        cout << "Result cache: " << cache->getHits() << " hits, " << cache->getMisses() << " misses ("
+             << (lookups == 0 ? 0.0 : 100.0 * cache->getHits() / lookups) << "% hit rate), "
+             << cache->getEntryCount() << " entries, " << cache->getBytes() << " bytes, "
+             << cache->getEvictions() << " evictions" << endl;
+    }
+
+    if (!metricsFile.empty()) {
+        reportMetrics(metricsFile);
+    }
+
+    if (options.countAllocations) {
+        cout << "Heap allocations in turns after warm-up: " << totals.allocations << " in " << totals.countedTurns
+             << " turns (most in one turn: " << totals.maxTurnAllocations << ")" << endl;
+        if (totals.allocations != 0) {
+            cout << "Allocation check FAILED: turns should not allocate" << endl;
+            return 1;
+        }
+        cout << "Allocation check passed" << endl;
+    }
+    return 0;
+}
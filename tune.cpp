@@ -0,0 +1,192 @@
+// Board-balance tuner: searches tile mixes for the one whose lanes differ least in expected points
+// Usage: ./tune [--threads N] [--lanes N] [--gap P] [--output FILE]
+//   --threads  search threads (default: one per core)
+//   --lanes    lanes sampled per candidate mix (default 2000; every candidate gets the same seeds)
+//   --gap      lane gap balanced boards are timed with (default 300)
+//   --output   where the best mix is written (default board_mix.txt, which the game picks up)
+// Candidates are green 22-38 per 52 in steps of 2, with every other color weighted 1-4. A candidate only
+// counts if its mean lane value stays within 5% of the classic mix, so the game doesn't get richer or poorer.
+// Lane values are what BotPlanner expects a player without an advisor to collect on the lane.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Board.h"
+#include "BotPlanner.h"
+#include "ContentStore.h"
+#include "Game.h"
+
+using namespace std;
+
+static const int GREEN_LOWEST = 22;
+static const int GREEN_STEP = 2;
+static const int GREEN_CHOICES = 9;
+static const int WEIGHT_CHOICES = 4;
+static const uint64_t SAMPLE_SEED = 12345;
+
+// mean and spread of lane values under one mix
+struct MixScore {
+    TileMix mix;
+    double mean;
+    double deviation;
+};
+
+// candidate index -> mix: lowest digits are the color weights, the rest picks the green count
+static TileMix candidateMix(int index) {
+    TileMix mix;
+    for (int color = 0; color < TILE_MIX_COLORS; color++) {
+        mix.weights[color] = index % WEIGHT_CHOICES + 1;
+        index /= WEIGHT_CHOICES;
+    }
+    mix.greenPer52 = GREEN_LOWEST + index * GREEN_STEP;
+    return mix;
+}
+
+// generate the sample lanes with mix (one board, lanes in one batch) and measure their values
+static MixScore scoreMix(const TileMix& mix, Board& board, int lanes, const double* tileValue) {
+    board.setTileMix(mix);
+    board.reset(lanes, 52, SAMPLE_SEED);
+    double total = 0;
+    double squares = 0;
+    for (int lane = 0; lane < lanes; lane++) {
+        double value = board.expectedLaneValue(lane, tileValue);
+        total += value;
+        squares += value * value;
+    }
+    MixScore score;
+    score.mix = mix;
+    score.mean = total / lanes;
+    double variance = squares / lanes - score.mean * score.mean;
+    score.deviation = sqrt(variance > 0 ? variance : 0);
+    return score;
+}
+
+// one search thread: claim candidates a block at a time, keep the best one that passes the mean check
+static void searchMixes(int candidates, int lanes, const double* tileValue, double classicMean, atomic<int>& next,
+                        MixScore& best) {
+    static const int BLOCK = 16;
+    Board board(lanes, 52);
+    best.deviation = -1;
+    while (true) {
+        int first = next.fetch_add(BLOCK);
+        if (first >= candidates) {
+            return;
+        }
+        for (int index = first; index < first + BLOCK && index < candidates; index++) {
+            MixScore score = scoreMix(candidateMix(index), board, lanes, tileValue);
+            if (fabs(score.mean - classicMean) > 0.05 * fabs(classicMean)) {
+                continue;
+            }
+            if (best.deviation < 0 || score.deviation < best.deviation) {
+                best = score;
+            }
+        }
+    }
+}
+
+// time balanced two-lane boards with mix: average and slowest generation, and boards that had to give up
+static void timeBalancedBoards(const TileMix& mix, const double* tileValue, int gap, ostream& out) {
+    const int boards = 10000;
+    Board board(2, 52);
+    board.setTileMix(mix);
+    double slowest = 0;
+    int gaveUp = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < boards; i++) {
+        chrono::steady_clock::time_point boardStart = chrono::steady_clock::now();
+        board.reset(2, 52, SAMPLE_SEED + i);
+        if (!board.balanceLanes(tileValue, gap, LANE_BALANCE_TRIES)) {
+            gaveUp++;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - boardStart).count();
+        slowest = seconds > slowest ? seconds : slowest;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    out << "  balanced board (gap " << gap << "): " << seconds * 1e6 / boards << " us average, "
+        << slowest * 1e6 << " us slowest, " << gaveUp << " of " << boards << " gave up" << endl;
+}
+
+static void printMix(const string& label, const MixScore& score, ostream& out) {
+    out << label << ": green " << score.mix.greenPer52 << ", weights blue " << score.mix.weights[0] << " pink "
+        << score.mix.weights[1] << " brown " << score.mix.weights[2] << " red " << score.mix.weights[3]
+        << " purple " << score.mix.weights[4] << endl;
+    out << "  lane value mean " << score.mean << ", standard deviation " << score.deviation << endl;
+}
+
+// parse arguments, load content for tile values, search in parallel, report, write the best mix
+int main(int argc, char* argv[]) {
+    int threads = thread::hardware_concurrency();
+    int lanes = 2000;
+    int gap = 300;
+    string output = "board_mix.txt";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--lanes" && i + 1 < argc) {
+            lanes = atoi(argv[++i]);
+        } else if (arg == "--gap" && i + 1 < argc) {
+            gap = atoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            cout << "Usage: ./tune [--threads N] [--lanes N] [--gap P] [--output FILE]" << endl;
+            return 1;
+        }
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (lanes < 2) {
+        lanes = 2;
+    }
+
+    GameData gameData;
+    loadGameData(gameData, cout);
+    BotPlanner planner(gameData);
+    const double* tileValue = planner.getTileValues(0);
+
+    Board classicBoard(lanes, 52);
+    MixScore classic = scoreMix(TileMix(), classicBoard, lanes, tileValue);
+
+    int candidates = GREEN_CHOICES;
+    for (int color = 0; color < TILE_MIX_COLORS; color++) {
+        candidates *= WEIGHT_CHOICES;
+    }
+    atomic<int> next(0);
+    vector<MixScore> threadBest(threads);
+    vector<thread> workers;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(thread(searchMixes, candidates, lanes, tileValue, classic.mean, ref(next), ref(threadBest[t])));
+    }
+    for (int t = 0; t < threads; t++) {
+        workers[t].join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    MixScore best = classic;
+    for (int t = 0; t < threads; t++) {
+        if (threadBest[t].deviation >= 0 && threadBest[t].deviation < best.deviation) {
+            best = threadBest[t];
+        }
+    }
+
+    cout << "Searched " << candidates << " mixes (" << lanes << " lanes each) in " << seconds << " s on " << threads
+         << " thread" << (threads == 1 ? "" : "s") << endl;
+    printMix("Classic mix", classic, cout);
+    timeBalancedBoards(classic.mix, tileValue, gap, cout);
+    printMix("Best mix", best, cout);
+    timeBalancedBoards(best.mix, tileValue, gap, cout);
+
+    if (!saveTileMix(output, best.mix)) {
+        cout << "Error: Could not write " << output << endl;
+        return 1;
+    }
+    cout << "Best mix written to " << output << endl;
+    return 0;
+}